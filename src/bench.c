@@ -0,0 +1,349 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#include "usimm.h"
+
+/* usimm-bench: measure the speed of the simulator itself.  Fixed
+   synthetic workloads are run through a 1-HMC, an HMC+DIMM and a
+   DIMM-only system, each benchmark in its own child process so that its
+   peak RSS is its own.  The simulated cycles, retired instructions and
+   serviced requests per second of wall time are reported and, given a
+   baseline saved by an earlier run, compared against it. */
+
+#define MAX_BENCH_CORES 2
+#define BENCH_RECORDS 10000 /* memory operations per core */
+#define BENCH_FOOTPRINT (256LL << 20) /* bytes touched by the random accesses */
+#define MAX_BENCHMARKS 16
+
+typedef struct benchmark
+{
+  const char * name;
+  const char * settings[4];
+  int num_cores;
+  int dimm_share; /* percent of the accesses with address bit 36 set */
+} benchmark_t;
+
+/* The 1-HMC system runs a single core: the addresses of a second core
+   would be placed beyond the HMC. */
+static const benchmark_t benchmarks[] = {
+  {"hmc", {"NUM_HMCS=1", "NUM_DIMMS=0", "NUM_CHANNELS=1", NULL}, 1, 0},
+  {"hmc+dimm", {"NUM_HMCS=1", "NUM_DIMMS=1", "NUM_CHANNELS=2", NULL}, 2, 25},
+  {"dimm", {"NUM_HMCS=0", "NUM_DIMMS=1", "NUM_CHANNELS=1", NULL}, 2, 100},
+};
+#define NUM_BENCHMARKS ((int)(sizeof(benchmarks)/sizeof(benchmarks[0])))
+
+typedef struct benchresult
+{
+  char name[32];
+  int status;
+  long long int cycles;
+  long long int instructions;
+  long long int requests;
+  double seconds;
+  long long int peak_rss_kb;
+} bench_result_t;
+
+/* xorshift64: the workloads must be the same on every run and host. */
+static unsigned long long int next_random(unsigned long long int * state)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/* One core's workload: bursts of 0-31 non-memory instructions between
+   70% reads and 30% writes, half of them streaming through memory and
+   half scattered over BENCH_FOOTPRINT. */
+static void make_workload(trace_data_t * data, int core, int dimm_share)
+{
+  unsigned long long int state = 0x9e3779b97f4a7c15ULL * (core + 1);
+  long long int stream = 0;
+
+  memset(data, 0, sizeof(trace_data_t));
+  data->decoded = (trace_record_t *)calloc(BENCH_RECORDS, sizeof(trace_record_t));
+  for (long long int i=0; i < BENCH_RECORDS; i++) {
+    trace_record_t * record = &data->decoded[i];
+    unsigned long long int r = next_random(&state);
+    long long int addr;
+
+    if (r & 1) {
+      addr = stream;
+      stream = (stream + 64) % BENCH_FOOTPRINT;
+    }
+    else
+      addr = (long long int)((r >> 8) % BENCH_FOOTPRINT) & ~63LL;
+    if ((int)((r >> 40) % 100) < dimm_share)
+      addr |= 1LL << 36;
+    record->addr = addr;
+    record->nonmemops = (int)((r >> 1) % 32);
+    record->optype = ((r >> 4) % 10 < 7) ? 'R' : 'W';
+    record->instrpc = 0x400000 + ((r >> 20) % 4096) * 4;
+  }
+  data->records = data->decoded;
+  data->num_records = BENCH_RECORDS;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Run one benchmark, keeping the fastest of 'repeat' runs. */
+static void run_benchmark(const benchmark_t * bench, int repeat, bench_result_t * result)
+{
+  trace_data_t data[MAX_BENCH_CORES];
+  const trace_data_t * traces[MAX_BENCH_CORES];
+  char * names[MAX_BENCH_CORES];
+  char name_buffer[MAX_BENCH_CORES][16];
+
+  memset(result, 0, sizeof(bench_result_t));
+  snprintf(result->name, sizeof(result->name), "%s", bench->name);
+  for (int c=0; c < bench->num_cores; c++) {
+    make_workload(&data[c], c, bench->dimm_share);
+    traces[c] = &data[c];
+    snprintf(name_buffer[c], sizeof(name_buffer[c]), "core%d", c);
+    names[c] = name_buffer[c];
+  }
+
+  FILE * out = fopen("/dev/null", "w");
+  for (int i=0; i < repeat && !result->status; i++) {
+    usimm_sim_t * sim = usimm_sim_create();
+    if (sim == NULL || out == NULL) {
+      result->status = -1;
+      break;
+    }
+    sim->out = out;
+    for (int s=0; bench->settings[s] && !result->status; s++)
+      result->status = usimm_sim_set(sim, bench->settings[s]);
+    if (!result->status)
+      result->status = usimm_sim_init_loaded(sim, bench->num_cores, names, traces);
+
+    double start = now();
+    if (!result->status)
+      result->status = usimm_sim_run(sim);
+    double seconds = now() - start;
+
+    if (!result->status && (i == 0 || seconds < result->seconds)) {
+      usimm_summary_t summary;
+      usimm_sim_summary(sim, &summary);
+      result->seconds = seconds;
+      result->cycles = summary.cycles;
+      result->requests = summary.reads_completed + summary.writes_completed;
+      result->instructions = 0;
+      for (int c=0; c < bench->num_cores; c++)
+        result->instructions += sim->committed[c];
+    }
+    usimm_sim_destroy(sim);
+  }
+  if (out)
+    fclose(out);
+  for (int c=0; c < bench->num_cores; c++)
+    unload_trace(&data[c]);
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  result->peak_rss_kb = usage.ru_maxrss;
+}
+
+/* Run a benchmark in a child process, so that the peak RSS is its own. */
+static void run_isolated(const benchmark_t * bench, int repeat, bench_result_t * result)
+{
+  int fd[2];
+
+  memset(result, 0, sizeof(bench_result_t));
+  snprintf(result->name, sizeof(result->name), "%s", bench->name);
+  result->status = -6;
+  if (pipe(fd))
+    return;
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(fd[0]);
+    close(fd[1]);
+    return;
+  }
+  if (pid == 0) {
+    close(fd[0]);
+    run_benchmark(bench, repeat, result);
+    _exit(write(fd[1], result, sizeof(bench_result_t)) == (ssize_t)sizeof(bench_result_t) ? 0 : 1);
+  }
+  close(fd[1]);
+  if (read(fd[0], result, sizeof(bench_result_t)) != (ssize_t)sizeof(bench_result_t))
+    result->status = -6;
+  close(fd[0]);
+  waitpid(pid, NULL, 0);
+}
+
+static double per_second(long long int count, double seconds)
+{
+  return (seconds > 0) ? count / seconds : 0;
+}
+
+static int read_baseline(const char * filename, bench_result_t * baseline, int * num_baseline)
+{
+  FILE * f = fopen(filename, "r");
+  char line[256];
+
+  *num_baseline = 0;
+  if (f == NULL) {
+    fprintf(stderr, "Could not open baseline %s; save one with --save.\n", filename);
+    return -5;
+  }
+  while (fgets(line, sizeof(line), f) && *num_baseline < MAX_BENCHMARKS) {
+    bench_result_t * b = &baseline[*num_baseline];
+    memset(b, 0, sizeof(bench_result_t));
+    if (line[0] == '#')
+      continue;
+    if (sscanf(line, "%31s %lld %lld %lld %lf %lld", b->name, &b->cycles, &b->instructions, &b->requests, &b->seconds, &b->peak_rss_kb) == 6)
+      (*num_baseline)++;
+  }
+  fclose(f);
+  return 0;
+}
+
+static int save_baseline(const char * filename, const bench_result_t * result, int num_results)
+{
+  FILE * f = fopen(filename, "w");
+  if (f == NULL) {
+    fprintf(stderr, "Could not create %s.  Quitting.\n", filename);
+    return -6;
+  }
+  fprintf(f, "# usimm-bench baseline: name cycles instructions requests seconds peak_rss_kb\n");
+  for (int i=0; i < num_results; i++)
+    fprintf(f, "%s %lld %lld %lld %.6f %lld\n", result[i].name, result[i].cycles, result[i].instructions, result[i].requests, result[i].seconds, result[i].peak_rss_kb);
+  fclose(f);
+  return 0;
+}
+
+/* Compare against the baseline.  Returns the number of regressions:
+   a benchmark slower or bigger than the baseline by more than
+   'tolerance', or whose simulated results changed. */
+static int compare(const bench_result_t * result, const bench_result_t * baseline, int num_baseline, double tolerance)
+{
+  const bench_result_t * b = NULL;
+  int regressions = 0;
+
+  for (int i=0; i < num_baseline; i++)
+    if (!strcmp(baseline[i].name, result->name))
+      b = &baseline[i];
+  if (b == NULL) {
+    printf("  %-10s not in the baseline\n", result->name);
+    return 0;
+  }
+
+  double speedup = (result->seconds > 0) ? b->seconds / result->seconds : 0;
+  double rss = b->peak_rss_kb ? (double)result->peak_rss_kb / b->peak_rss_kb : 1;
+  printf("  %-10s %6.2fx the baseline speed, %6.2fx its peak RSS", result->name, speedup, rss);
+  if (result->cycles != b->cycles || result->instructions != b->instructions || result->requests != b->requests) {
+    printf("  RESULTS CHANGED (%lld cycles, baseline %lld)", result->cycles, b->cycles);
+    regressions++;
+  }
+  if (speedup < 1 - tolerance) {
+    printf("  SLOWER");
+    regressions++;
+  }
+  if (rss > 1 + tolerance) {
+    printf("  BIGGER");
+    regressions++;
+  }
+  printf("\n");
+  return regressions;
+}
+
+static void usage(const char * program)
+{
+  fprintf(stderr,
+    "Usage: %s [options]\n"
+    "  --baseline FILE   compare against a saved baseline\n"
+    "  --save FILE       save the results as a baseline\n"
+    "  --repeat N        runs per benchmark, the fastest counts (default 3)\n"
+    "  --tolerance F     slowdown or growth counted as a regression (default 0.10)\n"
+    "  --only NAME       run only the named benchmark (hmc, hmc+dimm, dimm)\n",
+    program);
+}
+
+int main(int argc, char * argv[])
+{
+  const char * baseline_file = NULL;
+  const char * save_file = NULL;
+  const char * only = NULL;
+  int repeat = 3;
+  double tolerance = 0.10;
+
+  for (int i=1; i < argc; i++) {
+    if (i+1 == argc) {
+      usage(argv[0]);
+      return -3;
+    }
+    const char * arg = argv[i];
+    const char * value = argv[++i];
+    if (!strcmp(arg, "--baseline"))
+      baseline_file = value;
+    else if (!strcmp(arg, "--save"))
+      save_file = value;
+    else if (!strcmp(arg, "--repeat"))
+      repeat = atoi(value);
+    else if (!strcmp(arg, "--tolerance"))
+      tolerance = atof(value);
+    else if (!strcmp(arg, "--only"))
+      only = value;
+    else {
+      usage(argv[0]);
+      return -3;
+    }
+  }
+  if (repeat < 1)
+    repeat = 1;
+
+  bench_result_t result[MAX_BENCHMARKS];
+  int num_results = 0;
+  int status = 0;
+
+  printf("%-10s %12s %12s %10s %8s %14s %14s %14s %10s\n", "benchmark", "cycles", "instructions", "requests", "seconds",
+         "cycles/s", "instructions/s", "requests/s", "peak RSS");
+  for (int b=0; b < NUM_BENCHMARKS; b++) {
+    if (only && strcmp(only, benchmarks[b].name))
+      continue;
+    bench_result_t * r = &result[num_results++];
+    run_isolated(&benchmarks[b], repeat, r);
+    if (r->status) {
+      fprintf(stderr, "Benchmark %s failed with status %d\n", r->name, r->status);
+      status = r->status;
+      continue;
+    }
+    printf("%-10s %12lld %12lld %10lld %8.3f %14.0f %14.0f %14.0f %7lld MB\n", r->name, r->cycles, r->instructions, r->requests, r->seconds,
+           per_second(r->cycles, r->seconds), per_second(r->instructions, r->seconds), per_second(r->requests, r->seconds), r->peak_rss_kb / 1024);
+  }
+  if (status)
+    return status;
+
+  if (baseline_file) {
+    bench_result_t baseline[MAX_BENCHMARKS];
+    int num_baseline;
+    int regressions = 0;
+
+    status = read_baseline(baseline_file, baseline, &num_baseline);
+    if (status)
+      return status;
+    printf("\nAgainst %s (tolerance %.0f%%):\n", baseline_file, 100 * tolerance);
+    for (int i=0; i < num_results; i++)
+      regressions += compare(&result[i], baseline, num_baseline, tolerance);
+    if (regressions) {
+      printf("%d regression(s).\n", regressions);
+      status = 1;
+    }
+  }
+  if (save_file && save_baseline(save_file, result, num_results))
+    return -6;
+  return status;
+}
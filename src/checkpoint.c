@@ -0,0 +1,544 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "usimm.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "USIMMCP2"
+#define CHECKPOINT_MAGIC_SIZE 8
+
+typedef struct checkpointheader
+{
+  char magic[CHECKPOINT_MAGIC_SIZE];
+  long long int sim_size; // layout checks
+  long long int request_size;
+  int num_cores;
+  int num_config_params;
+} checkpoint_header_t;
+
+// A checkpoint file being written or read; the first failure sticks
+typedef struct checkpointfile
+{
+  FILE * f;
+  int failed;
+} checkpoint_file_t;
+
+static void put(checkpoint_file_t * cf, const void * data, size_t size)
+{
+	if(!cf->failed && size && fwrite(data, size, 1, cf->f) != 1)
+		cf->failed = 1;
+}
+
+static void get(checkpoint_file_t * cf, void * data, size_t size)
+{
+	if(!cf->failed && size && fread(data, size, 1, cf->f) != 1)
+		cf->failed = 1;
+	if(cf->failed)
+		memset(data, 0, size);
+}
+
+/********************************************************/
+/*	Requests					*/
+/********************************************************/
+
+// Requests are saved once each, numbered in the order the queues are
+// walked, and the queues and bank buckets are saved as lists of those
+// numbers.
+
+typedef struct requestnumber
+{
+  const request_t * request;
+  int number;
+} request_number_t;
+
+static int compare_request_numbers(const void * a, const void * b)
+{
+	const request_t * ra = ((const request_number_t*)a)->request;
+	const request_t * rb = ((const request_number_t*)b)->request;
+	return (ra > rb) - (ra < rb);
+}
+
+static int request_number(const request_number_t * numbers, int num_requests, const request_t * request)
+{
+	request_number_t key;
+	key.request = request;
+	const request_number_t * found = (const request_number_t*)bsearch(&key, numbers, num_requests, sizeof(request_number_t), compare_request_numbers);
+	return found ? found->number : -1;
+}
+
+// The heads of every queue linked through request_t.next, in a fixed
+// order. All channels are walked: addresses can decode to a channel the
+// configuration does not simulate.
+static int queue_heads(usimm_sim_t * sim, request_t *** heads)
+{
+	int n = 0;
+
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	{
+		for(int vault=0; vault<MAX_NUM_VAULTS; vault++)
+		{
+			heads[n++] = &sim->read_queue_head[channel][vault];
+			heads[n++] = &sim->write_queue_head[channel][vault];
+			heads[n++] = &sim->read_return_queue_head[channel][vault];
+		}
+	}
+	for(int core=0; core<sim->NUMCORES; core++)
+	{
+		for(int hmc=0; hmc<sim->NUM_HMCS; hmc++)
+		{
+			heads[n++] = &sim->read_queue_per_core_head[core][hmc];
+			heads[n++] = &sim->write_queue_per_core_head[core][hmc];
+		}
+	}
+	return n;
+}
+
+#define MAX_QUEUE_HEADS (3*MAX_NUM_CHANNELS*MAX_NUM_VAULTS + 2*MAX_NUM_CORES*MAX_NUM_HMCS)
+
+static vault_buckets_t * buckets_of(usimm_sim_t * sim, int channel, int vault, int type)
+{
+	return (type == READ) ? &sim->read_buckets[channel][vault] : &sim->write_buckets[channel][vault];
+}
+
+static int save_requests(usimm_sim_t * sim, checkpoint_file_t * cf)
+{
+	request_t ** heads[MAX_QUEUE_HEADS];
+	int num_heads = queue_heads(sim, heads);
+	int num_requests = 0;
+	request_t * request;
+
+	for(int h=0; h<num_heads; h++)
+		for(request = *heads[h]; request; request = request->next)
+			num_requests++;
+
+	request_number_t * numbers = (request_number_t*)malloc((num_requests+1) * sizeof(request_number_t));
+	if(numbers == NULL)
+		return -1;
+
+	// the requests, without their links
+	int n = 0;
+	put(cf, &num_requests, sizeof(int));
+	for(int h=0; h<num_heads; h++)
+	{
+		for(request = *heads[h]; request; request = request->next)
+		{
+			request_t copy = *request;
+
+			if(request->user_ptr)
+			{
+				fprintf(sim->out, "PANIC: Can not checkpoint a request carrying scheduler data (user_ptr).\n");
+				free(numbers);
+				return -1;
+			}
+			copy.next = copy.bank_prev = copy.bank_next = NULL;
+			put(cf, &copy, sizeof(request_t));
+			numbers[n].request = request;
+			numbers[n].number = n;
+			n++;
+		}
+	}
+	qsort(numbers, num_requests, sizeof(request_number_t), compare_request_numbers);
+
+	// the queues
+	for(int h=0; h<num_heads; h++)
+	{
+		int length = 0;
+		for(request = *heads[h]; request; request = request->next)
+			length++;
+		put(cf, &length, sizeof(int));
+		for(request = *heads[h]; request; request = request->next)
+		{
+			n = request_number(numbers, num_requests, request);
+			put(cf, &n, sizeof(int));
+		}
+	}
+
+	// the bank buckets
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	for(int vault=0; vault<MAX_NUM_VAULTS; vault++)
+	for(int type=READ; type<=WRITE; type++)
+	for(int i=0; i<MAX_NUM_BUCKETS; i++)
+	{
+		bank_bucket_t * bucket = &buckets_of(sim, channel, vault, type)->bucket[i];
+		int length = 0;
+		for(request = bucket->head; request; request = request->bank_next)
+			length++;
+		put(cf, &length, sizeof(int));
+		for(request = bucket->head; request; request = request->bank_next)
+		{
+			n = request_number(numbers, num_requests, request);
+			assert(n >= 0); // bucketed requests sit in a vault queue
+			put(cf, &n, sizeof(int));
+		}
+	}
+
+	free(numbers);
+	return 0;
+}
+
+static int restore_requests(usimm_sim_t * sim, checkpoint_file_t * cf)
+{
+	request_t ** heads[MAX_QUEUE_HEADS];
+	int num_heads = queue_heads(sim, heads);
+	int num_requests;
+
+	get(cf, &num_requests, sizeof(int));
+	if(cf->failed || num_requests < 0)
+		return -1;
+
+	request_t ** requests = (request_t**)malloc((num_requests+1) * sizeof(request_t*));
+	if(requests == NULL)
+		return -1;
+	for(int n=0; n<num_requests; n++)
+	{
+		requests[n] = alloc_request(sim);
+		get(cf, requests[n], sizeof(request_t));
+	}
+
+	// relink the queues and buckets; a number out of range means a
+	// damaged file
+	for(int h=0; h<num_heads && !cf->failed; h++)
+	{
+		request_t ** link = heads[h];
+		int length;
+
+		get(cf, &length, sizeof(int));
+		for(int k=0; k<length && !cf->failed; k++)
+		{
+			int n;
+			get(cf, &n, sizeof(int));
+			if(n < 0 || n >= num_requests)
+				cf->failed = 1;
+			else
+			{
+				*link = requests[n];
+				link = &requests[n]->next;
+			}
+		}
+		*link = NULL;
+	}
+
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	for(int vault=0; vault<MAX_NUM_VAULTS; vault++)
+	for(int type=READ; type<=WRITE; type++)
+	for(int i=0; i<MAX_NUM_BUCKETS && !cf->failed; i++)
+	{
+		bank_bucket_t * bucket = &buckets_of(sim, channel, vault, type)->bucket[i];
+		request_t * prev = NULL;
+		int length;
+
+		get(cf, &length, sizeof(int));
+		for(int k=0; k<length && !cf->failed; k++)
+		{
+			int n;
+			get(cf, &n, sizeof(int));
+			if(n < 0 || n >= num_requests)
+				cf->failed = 1;
+			else
+			{
+				requests[n]->bank_prev = prev;
+				if(prev)
+					prev->bank_next = requests[n];
+				else
+					bucket->head = requests[n];
+				prev = requests[n];
+			}
+		}
+	}
+
+	free(requests);
+	return cf->failed ? -1 : 0;
+}
+
+/********************************************************/
+/*	Checkpoint files				*/
+/********************************************************/
+
+static void put_header(usimm_sim_t * sim, checkpoint_file_t * cf)
+{
+	checkpoint_header_t header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+	header.sim_size = sizeof(usimm_sim_t);
+	header.request_size = sizeof(request_t);
+	header.num_cores = sim->NUMCORES;
+	for(header.num_config_params=0; sim->config[header.num_config_params].name; header.num_config_params++)
+		;
+	put(cf, &header, sizeof(header));
+}
+
+// Open a checkpoint and check that this build can read it
+static int open_checkpoint(usimm_sim_t * sim, checkpoint_file_t * cf, checkpoint_header_t * header, const char * filename)
+{
+	cf->f = fopen(filename, "rb");
+	cf->failed = 0;
+	if(cf->f == NULL)
+	{
+		fprintf(sim->out, "Could not open checkpoint %s.  Quitting.\n", filename);
+		return -5;
+	}
+	get(cf, header, sizeof(checkpoint_header_t));
+	if(cf->failed || memcmp(header->magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE))
+	{
+		fprintf(sim->out, "Panic.  %s is not a checkpoint.\n", filename);
+		fclose(cf->f);
+		return -1;
+	}
+	if(header->sim_size != sizeof(usimm_sim_t) || header->request_size != sizeof(request_t))
+	{
+		fprintf(sim->out, "Panic.  Checkpoint %s was written by a different build of usimm.\n", filename);
+		fclose(cf->f);
+		return -1;
+	}
+	return 0;
+}
+
+int write_checkpoint(usimm_sim_t * sim, const char * filename)
+{
+	checkpoint_file_t cf;
+
+	cf.f = fopen(filename, "wb");
+	cf.failed = 0;
+	if(cf.f == NULL)
+	{
+		fprintf(sim->out, "Could not create checkpoint %s.  Quitting.\n", filename);
+		return -6;
+	}
+
+	put_header(sim, &cf);
+
+	// configuration, by name
+	for(int i=0; sim->config[i].name; i++)
+	{
+		int length = strlen(sim->config[i].name);
+		put(&cf, &length, sizeof(int));
+		put(&cf, sim->config[i].name, length);
+		put(&cf, &sim->config[i].value, sizeof(double));
+	}
+
+	// the context itself; its pointers are meaningless in the file and
+	// what they point to follows
+	put(&cf, sim, sizeof(usimm_sim_t));
+
+	for(int numc=0; numc<sim->NUMCORES; numc++)
+	{
+		put(&cf, &sim->ROB[numc], sizeof(struct robstructure));
+		put(&cf, sim->ROB[numc].comptime, sim->ROBSIZE * sizeof(long long int));
+		put(&cf, sim->ROB[numc].mem_address, sim->ROBSIZE * sizeof(long long int));
+		put(&cf, sim->ROB[numc].optype, sim->ROBSIZE * sizeof(int));
+		put(&cf, sim->ROB[numc].instrpc, sim->ROBSIZE * sizeof(long long int));
+		put(&cf, &sim->prefixtable[numc], sizeof(int));
+		put(&cf, &sim->nonmemops[numc], sizeof(int));
+		put(&cf, &sim->opertype[numc], sizeof(char));
+		put(&cf, &sim->addr[numc], sizeof(long long int));
+		put(&cf, &sim->instrpc[numc], sizeof(long long int));
+		put(&cf, &sim->committed[numc], sizeof(long long int));
+		put(&cf, &sim->fetched[numc], sizeof(long long int));
+		put(&cf, &sim->time_done[numc], sizeof(long long int));
+		put(&cf, &sim->tif[numc].records_read, sizeof(long long int));
+	}
+
+	int status = save_requests(sim, &cf);
+	if(fclose(cf.f) || cf.failed)
+		status = -1;
+	if(status)
+	{
+		fprintf(sim->out, "Write error on checkpoint %s.  Quitting.\n", filename);
+		return -6;
+	}
+	return 0;
+}
+
+int read_checkpoint_config(usimm_sim_t * sim, const char * filename)
+{
+	checkpoint_file_t cf;
+	checkpoint_header_t header;
+	int status = open_checkpoint(sim, &cf, &header, filename);
+
+	if(status)
+		return status;
+	for(int i=0; i<header.num_config_params && !cf.failed; i++)
+	{
+		char name[256];
+		int length;
+		double value;
+
+		get(&cf, &length, sizeof(int));
+		if(length < 0 || length >= (int)sizeof(name))
+		{
+			cf.failed = 1;
+			break;
+		}
+		get(&cf, name, length);
+		name[length] = '\0';
+		get(&cf, &value, sizeof(double));
+
+		int p;
+		for(p=0; sim->config[p].name && strcmp(sim->config[p].name, name); p++)
+			;
+		if(!sim->config[p].name)
+		{
+			fprintf(sim->out, "Panic.  Checkpoint %s has unknown parameter %s.\n", filename, name);
+			fclose(cf.f);
+			return -1;
+		}
+		sim->config[p].value = value;
+	}
+	fclose(cf.f);
+	if(cf.failed)
+	{
+		fprintf(sim->out, "Panic.  Checkpoint %s is truncated.\n", filename);
+		return -1;
+	}
+	return 0;
+}
+
+int read_checkpoint_state(usimm_sim_t * sim, const char * filename)
+{
+	checkpoint_file_t cf;
+	checkpoint_header_t header;
+	int status = open_checkpoint(sim, &cf, &header, filename);
+
+	if(status)
+		return status;
+	if(header.num_cores != sim->NUMCORES)
+	{
+		fprintf(sim->out, "Panic.  Checkpoint %s was taken with %d traces, not %d.\n", filename, header.num_cores, sim->NUMCORES);
+		fclose(cf.f);
+		return -3;
+	}
+	for(int i=0; i<header.num_config_params; i++)
+	{
+		int length;
+		get(&cf, &length, sizeof(int));
+		if(!cf.failed && fseek(cf.f, length + sizeof(double), SEEK_CUR))
+			cf.failed = 1;
+	}
+
+	usimm_sim_t * saved = (usimm_sim_t*)malloc(sizeof(usimm_sim_t));
+	usimm_sim_t * fresh = (usimm_sim_t*)malloc(sizeof(usimm_sim_t));
+	if(saved == NULL || fresh == NULL)
+	{
+		free(saved);
+		free(fresh);
+		fclose(cf.f);
+		return -1;
+	}
+	get(&cf, saved, sizeof(usimm_sim_t));
+	if(cf.failed)
+	{
+		free(saved);
+		free(fresh);
+		fclose(cf.f);
+		fprintf(sim->out, "Panic.  Checkpoint %s is truncated.\n", filename);
+		return -1;
+	}
+
+	// Take over the saved context, except for what this run allocated
+	// and its own run-time settings. Every pointer member of the
+	// context must be listed here.
+	*fresh = *sim;
+	*sim = *saved;
+	sim->out = fresh->out;
+	sim->config = fresh->config;
+	sim->ROB = fresh->ROB;
+	sim->tif = fresh->tif;
+	sim->prefetch = fresh->prefetch;
+	sim->prefixtable = fresh->prefixtable;
+	sim->nonmemops = fresh->nonmemops;
+	sim->opertype = fresh->opertype;
+	sim->addr = fresh->addr;
+	sim->instrpc = fresh->instrpc;
+	sim->committed = fresh->committed;
+	sim->fetched = fresh->fetched;
+	sim->time_done = fresh->time_done;
+	sim->request_free_list = fresh->request_free_list;
+	sim->request_slab_nodes = fresh->request_slab_nodes;
+	sim->request_slabs = fresh->request_slabs;
+	sim->request_pool_slabs = fresh->request_pool_slabs;
+	sim->request_pool_live = fresh->request_pool_live;
+	memcpy(sim->read_queue_index, fresh->read_queue_index, sizeof(sim->read_queue_index));
+	memcpy(sim->write_queue_index, fresh->write_queue_index, sizeof(sim->write_queue_index));
+	memset(sim->read_queue_head, 0, sizeof(sim->read_queue_head));
+	memset(sim->write_queue_head, 0, sizeof(sim->write_queue_head));
+	memset(sim->read_return_queue_head, 0, sizeof(sim->read_return_queue_head));
+	memset(sim->read_queue_per_core_head, 0, sizeof(sim->read_queue_per_core_head));
+	memset(sim->write_queue_per_core_head, 0, sizeof(sim->write_queue_per_core_head));
+	memset(sim->vault_updates, 0, sizeof(sim->vault_updates));
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	{
+		for(int vault=0; vault<MAX_NUM_VAULTS; vault++)
+		{
+			for(int i=0; i<MAX_NUM_BUCKETS; i++)
+			{
+				sim->read_buckets[channel][vault].bucket[i].head = NULL;
+				sim->write_buckets[channel][vault].bucket[i].head = NULL;
+			}
+		}
+	}
+	sim->memory_threads = fresh->memory_threads;
+	sim->workers = fresh->workers;
+	sim->sampling = fresh->sampling;
+	sim->checkpoint_at = fresh->checkpoint_at;
+	sim->checkpoint_file = fresh->checkpoint_file;
+	sim->restore_file = fresh->restore_file;
+	sim->profile = fresh->profile;
+	sim->epoch = fresh->epoch;
+
+	for(int numc=0; numc<sim->NUMCORES && !cf.failed; numc++)
+	{
+		struct robstructure rob;
+		long long int records_read;
+
+		get(&cf, &rob, sizeof(struct robstructure));
+		sim->ROB[numc].head = rob.head;
+		sim->ROB[numc].tail = rob.tail;
+		sim->ROB[numc].inflight = rob.inflight;
+		sim->ROB[numc].tracedone = rob.tracedone;
+		get(&cf, sim->ROB[numc].comptime, sim->ROBSIZE * sizeof(long long int));
+		get(&cf, sim->ROB[numc].mem_address, sim->ROBSIZE * sizeof(long long int));
+		get(&cf, sim->ROB[numc].optype, sim->ROBSIZE * sizeof(int));
+		get(&cf, sim->ROB[numc].instrpc, sim->ROBSIZE * sizeof(long long int));
+		get(&cf, &sim->prefixtable[numc], sizeof(int));
+		get(&cf, &sim->nonmemops[numc], sizeof(int));
+		get(&cf, &sim->opertype[numc], sizeof(char));
+		get(&cf, &sim->addr[numc], sizeof(long long int));
+		get(&cf, &sim->instrpc[numc], sizeof(long long int));
+		get(&cf, &sim->committed[numc], sizeof(long long int));
+		get(&cf, &sim->fetched[numc], sizeof(long long int));
+		get(&cf, &sim->time_done[numc], sizeof(long long int));
+		get(&cf, &records_read, sizeof(long long int));
+		if(!cf.failed && skip_trace(&sim->tif[numc], records_read) <= 0)
+		{
+			fprintf(sim->out, "Panic.  Trace %d is shorter than in the checkpointed run.\n", numc);
+			status = -3;
+			cf.failed = 1;
+		}
+	}
+
+	// the queue index is not saved: its tables depend on how far they
+	// grew, so this run's empty tables are filled from the queues
+	if(!cf.failed && restore_requests(sim, &cf))
+		cf.failed = 1;
+	if(!cf.failed)
+		rebuild_queue_index(sim);
+	if(sim->request_pool_live > saved->request_pool_peak)
+		sim->request_pool_peak = sim->request_pool_live;
+
+	free(saved);
+	free(fresh);
+	fclose(cf.f);
+	if(cf.failed)
+	{
+		if(!status)
+		{
+			fprintf(sim->out, "Panic.  Checkpoint %s is damaged or truncated.\n", filename);
+			status = -1;
+		}
+		return status;
+	}
+	return 0;
+}
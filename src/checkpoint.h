@@ -0,0 +1,28 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include "params.h"
+
+// Checkpoints: the complete state of a simulation between two ticks,
+// written to a file that a later run resumes from. A checkpoint holds
+// the configuration, the ROBs and fetch state, the position reached in
+// every trace (not the traces themselves, which the restoring run must
+// be given again), every queued request with the queues and bank
+// buckets that link them, the queue indexes, and every other field of
+// the simulation context: DRAM and refresh state, scheduler state and
+// statistics. It can only be restored by a build of the simulator with
+// the same context layout.
+
+// Write a checkpoint of the simulation. Returns 0 on success.
+int write_checkpoint(usimm_sim_t * sim, const char * filename);
+
+// First half of a restore, before the simulation is initialized: take
+// over the configuration saved in the checkpoint. Returns 0 on success.
+int read_checkpoint_config(usimm_sim_t * sim, const char * filename);
+
+// Second half, once the simulation has been initialized on the same
+// traces: replace its state with the saved one and move every trace to
+// where the checkpointed run was. Returns 0 on success.
+int read_checkpoint_state(usimm_sim_t * sim, const char * filename);
+
+#endif //__CHECKPOINT_H__
@@ -2,7 +2,11 @@
 #ifndef __CONFIG_FILE_IN_H__
 #define __CONFIG_FILE_IN_H__
 
-#include "params.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "usimm.h"
 
 #define PROCESSOR_CLK_MULTIPLIER_VAL 	25
 #define DIMM_CLK_MULTIPLIER_VAL			100
@@ -103,118 +107,388 @@
 #define WQ_LOOKUP_LATENCY_HMC	10
 #define WQ_CAPACITY_HMC			96
 
-void read_config_vars()
+// Runtime configuration. The #defines above are the defaults; they are
+// collected into default_config_params[] under the same names (without
+// the _VAL suffix). Each simulation starts from its own copy of that
+// table (sim->config), which can be replaced at startup by config files
+// (read_config_file), by device (.vi) files loaded into the HMC or DIMM
+// section, and by KEY=VALUE overrides (set_config_override), each one
+// overriding what came before. read_config_vars() then derives the
+// simulation's parameters from the table.
+
+#define SYSTEM_PARAM(name) { #name, name##_VAL }
+#define DEVICE_PARAM(name) { #name "_HMC", name##_HMC }, { #name "_DIMM", name##_DIMM }
+
+static const config_param_t default_config_params[] = {
+	SYSTEM_PARAM(PROCESSOR_CLK_MULTIPLIER),
+	SYSTEM_PARAM(DIMM_CLK_MULTIPLIER),
+	SYSTEM_PARAM(HMC_CLK_MULTIPLIER),
+	SYSTEM_PARAM(SERDES_CLK_MULTIPLIER),
+	SYSTEM_PARAM(NUM_HMCS),
+	SYSTEM_PARAM(NUM_DIMMS),
+	SYSTEM_PARAM(ROBSIZE),
+	SYSTEM_PARAM(MAX_RETIRE),
+	SYSTEM_PARAM(MAX_FETCH),
+	SYSTEM_PARAM(PIPELINEDEPTH),
+	SYSTEM_PARAM(NUM_CHANNELS),
+	SYSTEM_PARAM(ADDRESS_MAPPING),
+	SYSTEM_PARAM(ADDRESS_BITS),
+	SYSTEM_PARAM(RQ_LINK_LATENCY),
+	SYSTEM_PARAM(WQ_LINK_LATENCY),
+	{ "NUM_SERDES_LINKS_PER_HMC", NUM_SERDES_LINKS_PER_HMC },
+
+	DEVICE_PARAM(NUM_VAULTS),
+	DEVICE_PARAM(NUM_RANKS),
+	DEVICE_PARAM(NUM_BANKS),
+	DEVICE_PARAM(NUM_ROWS),
+	DEVICE_PARAM(NUM_COLUMNS),
+	DEVICE_PARAM(CACHE_LINE_SIZE),
+	DEVICE_PARAM(T_RCD),
+	DEVICE_PARAM(T_RP),
+	DEVICE_PARAM(T_CAS),
+	DEVICE_PARAM(T_RC),
+	DEVICE_PARAM(T_RAS),
+	DEVICE_PARAM(T_RRD),
+	DEVICE_PARAM(T_FAW),
+	DEVICE_PARAM(T_WR),
+	DEVICE_PARAM(T_WTR),
+	DEVICE_PARAM(T_RTP),
+	DEVICE_PARAM(T_CCD),
+	DEVICE_PARAM(T_RFC),
+	DEVICE_PARAM(T_REFI),
+	DEVICE_PARAM(T_CWD),
+	DEVICE_PARAM(T_RTRS),
+	DEVICE_PARAM(T_PD_MIN),
+	DEVICE_PARAM(T_XP),
+	DEVICE_PARAM(T_XP_DLL),
+	DEVICE_PARAM(T_DATA_TRANS),
+	DEVICE_PARAM(VDD),
+	DEVICE_PARAM(IDD0),
+	DEVICE_PARAM(IDD2P0),
+	DEVICE_PARAM(IDD2P1),
+	DEVICE_PARAM(IDD2N),
+	DEVICE_PARAM(IDD3P),
+	DEVICE_PARAM(IDD3N),
+	DEVICE_PARAM(IDD4R),
+	DEVICE_PARAM(IDD4W),
+	DEVICE_PARAM(IDD5),
+	DEVICE_PARAM(RQ_LOOKUP_LATENCY),
+	DEVICE_PARAM(WQ_LOOKUP_LATENCY),
+	DEVICE_PARAM(WQ_CAPACITY),
+	{ NULL, 0 }
+};
+
+// A fresh copy of the default configuration table
+config_param_t * default_config()
 {
+	config_param_t * config = (config_param_t*)malloc(sizeof(default_config_params));
+
+	if(config)
+		memcpy(config, default_config_params, sizeof(default_config_params));
+	return config;
+}
+
+config_param_t * find_config_param(usimm_sim_t * sim, const char * name)
+{
+	for(int i=0; sim->config[i].name; i++)
+		if(!strcmp(sim->config[i].name, name))
+			return &sim->config[i];
+	return NULL;
+}
+
+// Value of a per-device parameter, e.g. device_param("T_RCD", "HMC")
+double device_param(usimm_sim_t * sim, const char * name, const char * device)
+{
+	char key[64];
+
+	snprintf(key, sizeof(key), "%s_%s", name, device);
+	return find_config_param(sim, key)->value;
+}
+
+#define SYSTEM_PARAM_VALUE(name) (find_config_param(sim, #name)->value)
+
+// Set a parameter from its textual value. Inside a device section
+// ("HMC" or "DIMM") a bare name such as T_RCD refers to that device.
+// Outside a section bare device names refer to the DIMMs, which is
+// what the original single-device USIMM config files describe.
+// Returns 0 on success, -1 for an unknown name and -2 for a bad value.
+int set_config_param(usimm_sim_t * sim, const char * name, const char * value, const char * section)
+{
+	char key[64];
+	char * end;
+	config_param_t * param = NULL;
+
+	snprintf(key, sizeof(key), "%s_%s", name, section ? section : "DIMM");
+	param = find_config_param(sim, key);
+	if(param == NULL)
+		param = find_config_param(sim, name);
+	if(param == NULL)
+		return -1;
+
+	double v = strtod(value, &end);
+	if(end == value || *end != '\0')
+		return -2;
+	param->value = v;
+	return 0;
+}
+
+// Read a config or device file of "NAME value" lines. "//" starts a
+// comment; "[HMC]", "[DIMM]" and "[SYSTEM]" switch the section that
+// bare device parameter names refer to. 'section' is the section the
+// file starts in (NULL for a system config file).
+// Returns 0 on success, nonzero after printing the problem.
+int read_config_file(usimm_sim_t * sim, const char * filename, const char * section)
+{
+	char line[256];
+	int line_num = 0;
+	FILE * f = fopen(filename, "r");
+
+	if(!f)
+	{
+		fprintf(sim->out, "Missing config file %s.  Quitting.\n", filename);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), f))
+	{
+		char name[64], value[64], extra[2];
+		char * comment = strstr(line, "//");
+
+		line_num++;
+		if(comment)
+			*comment = '\0';
+
+		if(sscanf(line, " [%63[^]]]", name) == 1)
+		{
+			if(!strcmp(name, "HMC") || !strcmp(name, "DIMM"))
+				section = (!strcmp(name, "HMC")) ? "HMC" : "DIMM";
+			else if(!strcmp(name, "SYSTEM"))
+				section = NULL;
+			else
+			{
+				fprintf(sim->out, "Panic.  Unknown section [%s] in %s line %d.\n", name, filename, line_num);
+				fclose(f);
+				return -2;
+			}
+			continue;
+		}
+
+		int fields = sscanf(line, "%63s %63s %1s", name, value, extra);
+		if(fields <= 0)
+			continue;
+		if(fields != 2)
+		{
+			fprintf(sim->out, "Panic.  Poor config format in %s line %d.\n", filename, line_num);
+			fclose(f);
+			return -2;
+		}
+
+		int status = set_config_param(sim, name, value, section);
+		if(status == -1)
+			fprintf(sim->out, "Warning: ignoring unknown parameter %s in %s line %d.\n", name, filename, line_num);
+		else if(status)
+		{
+			fprintf(sim->out, "Panic.  Bad value %s for %s in %s line %d.\n", value, name, filename, line_num);
+			fclose(f);
+			return -2;
+		}
+	}
+	fclose(f);
+	return 0;
+}
+
+// Apply a command-line override of the form NAME=VALUE
+int set_config_override(usimm_sim_t * sim, const char * assignment)
+{
+	char name[64];
+	const char * eq = strchr(assignment, '=');
+
+	if(eq == NULL || eq == assignment || eq - assignment >= (int)sizeof(name))
+	{
+		fprintf(sim->out, "Panic.  Expected NAME=VALUE, got %s.\n", assignment);
+		return -2;
+	}
+	memcpy(name, assignment, eq - assignment);
+	name[eq - assignment] = '\0';
+
+	int status = set_config_param(sim, name, eq + 1, NULL);
+	if(status == -1)
+		fprintf(sim->out, "Panic.  Unknown parameter %s.\n", name);
+	else if(status)
+		fprintf(sim->out, "Panic.  Bad value %s for %s.\n", eq + 1, name);
+	return status;
+}
+
+// Voltages and currents may be fractional; every other parameter is a
+// count or a number of cycles
+static int config_param_is_real(const char * name)
+{
+	return !strncmp(name, "VDD", 3) || !strncmp(name, "IDD", 3);
+}
+
+static int config_power_of_two(double value)
+{
+	long long int n = (long long int)value;
+	return n > 0 && (n & (n - 1)) == 0;
+}
+
+// Reject what the simulator can not run: fractional counts or cycles,
+// clocks and widths that would never let the simulation advance,
+// geometry the address decoder can not split into bit fields, and a
+// channel count that is not the HMCs plus the DIMMs.
+static int check_config_params(usimm_sim_t * sim)
+{
+	static const char * positive[] = {
+		"PROCESSOR_CLK_MULTIPLIER", "DIMM_CLK_MULTIPLIER", "HMC_CLK_MULTIPLIER", "SERDES_CLK_MULTIPLIER",
+		"ROBSIZE", "MAX_RETIRE", "MAX_FETCH", "NUM_SERDES_LINKS_PER_HMC",
+		"T_RC_HMC", "T_RC_DIMM", "T_REFI_HMC", "T_REFI_DIMM", "T_DATA_TRANS_HMC", "T_DATA_TRANS_DIMM",
+		"WQ_CAPACITY_HMC", "WQ_CAPACITY_DIMM", NULL
+	};
+	static const char * geometry[] = {
+		"NUM_VAULTS", "NUM_RANKS", "NUM_BANKS", "NUM_ROWS", "NUM_COLUMNS", "CACHE_LINE_SIZE", NULL
+	};
+
+	for(int i=0; sim->config[i].name; i++)
+	{
+		const config_param_t * param = &sim->config[i];
+
+		if(param->value < 0)
+		{
+			fprintf(sim->out, "Panic.  %s can not be negative, got %g.\n", param->name, param->value);
+			return -1;
+		}
+		if(!config_param_is_real(param->name) && param->value != (double)(long long int)param->value)
+		{
+			fprintf(sim->out, "Panic.  %s must be an integer, got %g.\n", param->name, param->value);
+			return -1;
+		}
+	}
+	for(int i=0; positive[i]; i++)
+	{
+		if(find_config_param(sim, positive[i])->value < 1)
+		{
+			fprintf(sim->out, "Panic.  %s must be at least 1.\n", positive[i]);
+			return -1;
+		}
+	}
+	for(int i=0; geometry[i]; i++)
+	{
+		for(int d=0; d<2; d++)
+		{
+			const char * dev = d ? "DIMM" : "HMC";
+
+			if(!config_power_of_two(device_param(sim, geometry[i], dev)))
+			{
+				fprintf(sim->out, "Panic.  %s_%s must be a power of two, got %g.\n", geometry[i], dev, device_param(sim, geometry[i], dev));
+				return -1;
+			}
+		}
+	}
+
+	double hmcs = SYSTEM_PARAM_VALUE(NUM_HMCS), dimms = SYSTEM_PARAM_VALUE(NUM_DIMMS);
+	if((hmcs && !config_power_of_two(hmcs)) || (dimms && !config_power_of_two(dimms)))
+	{
+		fprintf(sim->out, "Panic.  NUM_HMCS and NUM_DIMMS must be 0 or a power of two.\n");
+		return -1;
+	}
+	if(SYSTEM_PARAM_VALUE(NUM_CHANNELS) != hmcs + dimms)
+	{
+		fprintf(sim->out, "Panic.  NUM_CHANNELS is %g but NUM_HMCS + NUM_DIMMS is %g.\n", SYSTEM_PARAM_VALUE(NUM_CHANNELS), hmcs + dimms);
+		return -1;
+	}
+	return 0;
+}
+
+// Derive the simulator globals from the configuration. Returns 0, or
+// nonzero if the configuration is invalid or does not fit the
+// compiled-in limits.
+int read_config_vars(usimm_sim_t * sim)
+{
+	if(check_config_params(sim))
+		return -1;
+
+	sim->PROCESSOR_CLK_MULTIPLIER = SYSTEM_PARAM_VALUE(PROCESSOR_CLK_MULTIPLIER);
+	sim->DIMM_CLK_MULTIPLIER = SYSTEM_PARAM_VALUE(DIMM_CLK_MULTIPLIER);
+	sim->HMC_CLK_MULTIPLIER = SYSTEM_PARAM_VALUE(HMC_CLK_MULTIPLIER);
+	sim->SERDES_CLK_MULTIPLIER =  SYSTEM_PARAM_VALUE(SERDES_CLK_MULTIPLIER);
+	sim->NUM_HMCS = SYSTEM_PARAM_VALUE(NUM_HMCS);
+	sim->NUM_DIMMS = SYSTEM_PARAM_VALUE(NUM_DIMMS);
+	sim->ROBSIZE = SYSTEM_PARAM_VALUE(ROBSIZE);
+	sim->MAX_RETIRE = SYSTEM_PARAM_VALUE(MAX_RETIRE);
+	sim->MAX_FETCH = SYSTEM_PARAM_VALUE(MAX_FETCH);
+	sim->PIPELINEDEPTH = (int)SYSTEM_PARAM_VALUE(PIPELINEDEPTH) * sim->PROCESSOR_CLK_MULTIPLIER;
+	sim->NUM_CHANNELS = SYSTEM_PARAM_VALUE(NUM_CHANNELS);
 	
-	PROCESSOR_CLK_MULTIPLIER = PROCESSOR_CLK_MULTIPLIER_VAL;
-	DIMM_CLK_MULTIPLIER = DIMM_CLK_MULTIPLIER_VAL;
-	HMC_CLK_MULTIPLIER = HMC_CLK_MULTIPLIER_VAL;
-	SERDES_CLK_MULTIPLIER =  SERDES_CLK_MULTIPLIER_VAL;
-	NUM_HMCS = NUM_HMCS_VAL;
-	NUM_DIMMS = NUM_DIMMS_VAL;
-	ROBSIZE = ROBSIZE_VAL;
-	MAX_RETIRE = MAX_RETIRE_VAL;
-	MAX_FETCH = MAX_FETCH_VAL;
-	PIPELINEDEPTH = PIPELINEDEPTH_VAL * PROCESSOR_CLK_MULTIPLIER_VAL;
-	NUM_CHANNELS = NUM_CHANNELS_VAL;
-	
-	ADDRESS_MAPPING = ADDRESS_MAPPING_VAL;
-	ADDRESS_BITS = ADDRESS_BITS_VAL;
-	RQ_LINK_LATENCY = RQ_LINK_LATENCY_VAL * SERDES_CLK_MULTIPLIER / NUM_SERDES_LINKS_PER_HMC;
-	WQ_LINK_LATENCY = WQ_LINK_LATENCY_VAL * SERDES_CLK_MULTIPLIER / NUM_SERDES_LINKS_PER_HMC;
-	
-	for(int i = 0; i < NUM_CHANNELS; i++) {
+	sim->ADDRESS_MAPPING = SYSTEM_PARAM_VALUE(ADDRESS_MAPPING);
+	sim->ADDRESS_BITS = SYSTEM_PARAM_VALUE(ADDRESS_BITS);
+	int serdes_links = SYSTEM_PARAM_VALUE(NUM_SERDES_LINKS_PER_HMC);
+	sim->RQ_LINK_LATENCY = (int)SYSTEM_PARAM_VALUE(RQ_LINK_LATENCY) * sim->SERDES_CLK_MULTIPLIER / serdes_links;
+	sim->WQ_LINK_LATENCY = (int)SYSTEM_PARAM_VALUE(WQ_LINK_LATENCY) * sim->SERDES_CLK_MULTIPLIER / serdes_links;
+
+	if(sim->NUM_CHANNELS < 1 || sim->NUM_CHANNELS > MAX_NUM_CHANNELS || sim->NUM_HMCS < 0 || sim->NUM_HMCS > MAX_NUM_HMCS || sim->NUM_HMCS > sim->NUM_CHANNELS || serdes_links < 1)
+	{
+		fprintf(sim->out, "Panic.  Configuration exceeds the compiled-in channel limits.\n");
+		return -1;
+	}
 	
-		if(i < NUM_HMCS) {
-			MEMORY_CLK_MULTIPLIER[i] = HMC_CLK_MULTIPLIER;
-			NUM_VAULTS[i] = NUM_VAULTS_HMC;
-			NUM_RANKS[i] =  NUM_RANKS_HMC;
-			NUM_BANKS[i] = NUM_BANKS_HMC;
-			NUM_ROWS[i] = NUM_ROWS_HMC;
-			NUM_COLUMNS[i] = NUM_COLUMNS_HMC;
-			CACHE_LINE_SIZE[i] = CACHE_LINE_SIZE_HMC;
-			T_RCD[i] = T_RCD_HMC * HMC_CLK_MULTIPLIER;
-			T_RP[i] = T_RP_HMC * HMC_CLK_MULTIPLIER;
-			T_CAS[i] = T_CAS_HMC * HMC_CLK_MULTIPLIER;
-			T_RC[i] = T_RC_HMC * HMC_CLK_MULTIPLIER;
-			T_RAS[i] = T_RAS_HMC * HMC_CLK_MULTIPLIER;
-			T_RRD[i] = T_RRD_HMC * HMC_CLK_MULTIPLIER;
-			T_FAW[i] = T_FAW_HMC * HMC_CLK_MULTIPLIER;
-			T_WR[i] = T_WR_HMC * HMC_CLK_MULTIPLIER;
-			T_WTR[i] = T_WTR_HMC * HMC_CLK_MULTIPLIER;
-			T_RTP[i] = T_RTP_HMC * HMC_CLK_MULTIPLIER;
-			T_CCD[i] = T_CCD_HMC * HMC_CLK_MULTIPLIER;
-			T_RFC[i] = T_RFC_HMC * HMC_CLK_MULTIPLIER;
-			T_REFI[i] = T_REFI_HMC * HMC_CLK_MULTIPLIER;
-			T_CWD[i] = T_CWD_HMC * HMC_CLK_MULTIPLIER;
-			T_RTRS[i] = T_RTRS_HMC * HMC_CLK_MULTIPLIER;
-			T_PD_MIN[i] = T_PD_MIN_HMC * HMC_CLK_MULTIPLIER;
-			T_XP[i] = T_XP_HMC * HMC_CLK_MULTIPLIER;
-			T_XP_DLL[i] = T_XP_DLL_HMC * HMC_CLK_MULTIPLIER;
-			T_DATA_TRANS[i] = T_DATA_TRANS_HMC * HMC_CLK_MULTIPLIER;
-			VDD[i] = VDD_HMC;
-			IDD0[i] = IDD0_HMC;
-			IDD2P0[i] = IDD2P0_HMC;
-			IDD2P1[i] = IDD2P1_HMC;
-			IDD2N[i] = IDD2N_HMC;
-			IDD3P[i] = IDD3P_HMC;
-			IDD3N[i] = IDD3N_HMC;
-			IDD4R[i] = IDD4R_HMC;
-			IDD4W[i] = IDD4W_HMC;
-			IDD5[i] = IDD5_HMC;
-			
-			RQ_LOOKUP_LATENCY[i] = RQ_LOOKUP_LATENCY_HMC * PROCESSOR_CLK_MULTIPLIER_VAL;
-			WQ_LOOKUP_LATENCY[i] = WQ_LOOKUP_LATENCY_HMC * PROCESSOR_CLK_MULTIPLIER_VAL;
-			WQ_CAPACITY[i] = WQ_CAPACITY_HMC;
-		}
-		else {
-			MEMORY_CLK_MULTIPLIER[i] = DIMM_CLK_MULTIPLIER;
-			NUM_VAULTS[i] = NUM_VAULTS_DIMM;
-			NUM_RANKS[i] = NUM_RANKS_DIMM;
-			NUM_BANKS[i] = NUM_BANKS_DIMM;
-			NUM_ROWS[i] = NUM_ROWS_DIMM;
-			NUM_COLUMNS[i] = NUM_COLUMNS_DIMM;
-			CACHE_LINE_SIZE[i] = CACHE_LINE_SIZE_DIMM;
-			T_RCD[i] = T_RCD_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RP[i] = T_RP_DIMM * DIMM_CLK_MULTIPLIER;
-			T_CAS[i] = T_CAS_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RC[i] = T_RC_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RAS[i] = T_RAS_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RRD[i] = T_RRD_DIMM * DIMM_CLK_MULTIPLIER;
-			T_FAW[i] = T_FAW_DIMM * DIMM_CLK_MULTIPLIER;
-			T_WR[i] = T_WR_DIMM * DIMM_CLK_MULTIPLIER;
-			T_WTR[i] = T_WTR_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RTP[i] = T_RTP_DIMM * DIMM_CLK_MULTIPLIER;
-			T_CCD[i] = T_CCD_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RFC[i] = T_RFC_DIMM * DIMM_CLK_MULTIPLIER;
-			T_REFI[i] = T_REFI_DIMM * DIMM_CLK_MULTIPLIER;
-			T_CWD[i] = T_CWD_DIMM * DIMM_CLK_MULTIPLIER;
-			T_RTRS[i] = T_RTRS_DIMM * DIMM_CLK_MULTIPLIER;
-			T_PD_MIN[i] = T_PD_MIN_DIMM * DIMM_CLK_MULTIPLIER;
-			T_XP[i] = T_XP_DIMM * DIMM_CLK_MULTIPLIER;
-			T_XP_DLL[i] = T_XP_DLL_DIMM * DIMM_CLK_MULTIPLIER; 
-			T_DATA_TRANS[i] = T_DATA_TRANS_DIMM * DIMM_CLK_MULTIPLIER;
-			VDD[i] = VDD_DIMM;
-			IDD0[i] = IDD0_DIMM;
-			IDD2P0[i] = IDD2P0_DIMM;
-			IDD2P1[i] = IDD2P1_DIMM;
-			IDD2N[i] = IDD2N_DIMM;
-			IDD3P[i] = IDD3P_DIMM;
-			IDD3N[i] = IDD3N_DIMM;
-			IDD4R[i] = IDD4R_DIMM;
-			IDD4W[i] = IDD4W_DIMM;
-			IDD5[i] = IDD5_DIMM;
-
-			RQ_LOOKUP_LATENCY[i] = RQ_LOOKUP_LATENCY_DIMM * PROCESSOR_CLK_MULTIPLIER_VAL;
-			WQ_LOOKUP_LATENCY[i] = WQ_LOOKUP_LATENCY_DIMM * PROCESSOR_CLK_MULTIPLIER_VAL;
-			WQ_CAPACITY[i] = WQ_CAPACITY_DIMM;
+	for(int i = 0; i < sim->NUM_CHANNELS; i++) {
+
+		const char * dev = (i < sim->NUM_HMCS) ? "HMC" : "DIMM";
+		int clk = (i < sim->NUM_HMCS) ? sim->HMC_CLK_MULTIPLIER : sim->DIMM_CLK_MULTIPLIER;
+
+		sim->MEMORY_CLK_MULTIPLIER[i] = clk;
+		sim->NUM_VAULTS[i] = device_param(sim, "NUM_VAULTS", dev);
+		sim->NUM_RANKS[i] =  device_param(sim, "NUM_RANKS", dev);
+		sim->NUM_BANKS[i] = device_param(sim, "NUM_BANKS", dev);
+		sim->NUM_ROWS[i] = device_param(sim, "NUM_ROWS", dev);
+		sim->NUM_COLUMNS[i] = device_param(sim, "NUM_COLUMNS", dev);
+		sim->CACHE_LINE_SIZE[i] = device_param(sim, "CACHE_LINE_SIZE", dev);
+		sim->T_RCD[i] = (int)device_param(sim, "T_RCD", dev) * clk;
+		sim->T_RP[i] = (int)device_param(sim, "T_RP", dev) * clk;
+		sim->T_CAS[i] = (int)device_param(sim, "T_CAS", dev) * clk;
+		sim->T_RC[i] = (int)device_param(sim, "T_RC", dev) * clk;
+		sim->T_RAS[i] = (int)device_param(sim, "T_RAS", dev) * clk;
+		sim->T_RRD[i] = (int)device_param(sim, "T_RRD", dev) * clk;
+		sim->T_FAW[i] = (int)device_param(sim, "T_FAW", dev) * clk;
+		sim->T_WR[i] = (int)device_param(sim, "T_WR", dev) * clk;
+		sim->T_WTR[i] = (int)device_param(sim, "T_WTR", dev) * clk;
+		sim->T_RTP[i] = (int)device_param(sim, "T_RTP", dev) * clk;
+		sim->T_CCD[i] = (int)device_param(sim, "T_CCD", dev) * clk;
+		sim->T_RFC[i] = (int)device_param(sim, "T_RFC", dev) * clk;
+		sim->T_REFI[i] = (int)device_param(sim, "T_REFI", dev) * clk;
+		sim->T_CWD[i] = (int)device_param(sim, "T_CWD", dev) * clk;
+		sim->T_RTRS[i] = (int)device_param(sim, "T_RTRS", dev) * clk;
+		sim->T_PD_MIN[i] = (int)device_param(sim, "T_PD_MIN", dev) * clk;
+		sim->T_XP[i] = (int)device_param(sim, "T_XP", dev) * clk;
+		sim->T_XP_DLL[i] = (int)device_param(sim, "T_XP_DLL", dev) * clk;
+		sim->T_DATA_TRANS[i] = (int)device_param(sim, "T_DATA_TRANS", dev) * clk;
+		sim->VDD[i] = device_param(sim, "VDD", dev);
+		sim->IDD0[i] = device_param(sim, "IDD0", dev);
+		sim->IDD2P0[i] = device_param(sim, "IDD2P0", dev);
+		sim->IDD2P1[i] = device_param(sim, "IDD2P1", dev);
+		sim->IDD2N[i] = device_param(sim, "IDD2N", dev);
+		sim->IDD3P[i] = device_param(sim, "IDD3P", dev);
+		sim->IDD3N[i] = device_param(sim, "IDD3N", dev);
+		sim->IDD4R[i] = device_param(sim, "IDD4R", dev);
+		sim->IDD4W[i] = device_param(sim, "IDD4W", dev);
+		sim->IDD5[i] = device_param(sim, "IDD5", dev);
+
+		sim->RQ_LOOKUP_LATENCY[i] = (int)device_param(sim, "RQ_LOOKUP_LATENCY", dev) * sim->PROCESSOR_CLK_MULTIPLIER;
+		sim->WQ_LOOKUP_LATENCY[i] = (int)device_param(sim, "WQ_LOOKUP_LATENCY", dev) * sim->PROCESSOR_CLK_MULTIPLIER;
+		sim->WQ_CAPACITY[i] = device_param(sim, "WQ_CAPACITY", dev);
+
+		if(sim->NUM_VAULTS[i] < 1 || sim->NUM_VAULTS[i] > MAX_NUM_VAULTS || sim->NUM_RANKS[i] < 1 || sim->NUM_RANKS[i] > MAX_NUM_RANKS || sim->NUM_BANKS[i] < 1 || sim->NUM_BANKS[i] > MAX_NUM_BANKS)
+		{
+			fprintf(sim->out, "Panic.  %s configuration exceeds the compiled-in vault/rank/bank limits.\n", dev);
+			return -1;
 		}
 	}
+	return 0;
 }
 
-void print_params()
+void print_params(usimm_sim_t * sim)
 {
-	printf("PLACEHOLDER FOR SIMULATOR PARAMETERS.\n");
+	fprintf(sim->out, "PLACEHOLDER FOR SIMULATOR PARAMETERS.\n");
 }
 	
 
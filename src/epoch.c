@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "usimm.h"
+#include "epoch.h"
+
+// The CSV columns. Cycles are simulator cycles as in the "Cycles" of
+// the report; bandwidth and IPC are per processor cycle. A row fills
+// only the columns of its scope.
+//   vault  channel, vault, reads, writes (completed), bytes_per_cycle,
+//          read_queue, write_queue (lengths at the end of the epoch),
+//          row_hit_rate, activates, power_mw (per device, summed over
+//          the ranks)
+//   link   channel, request_link and response_link (busy fraction)
+//   core   core, ipc
+#define EPOCH_HEADER "epoch,start_cycle,end_cycle,scope,channel,vault,core,reads,writes,bytes_per_cycle,read_queue,write_queue,row_hit_rate,activates,power_mw,request_link,response_link,ipc\n"
+
+#define EPOCH_BUFFER_SIZE (1 << 20)
+#define EPOCH_PREFIX_SIZE 64
+
+static long long int vault_columns(usimm_sim_t * sim, int channel, int vault)
+{
+	long long int columns = 0;
+
+	for(int r=0; r<sim->NUM_RANKS[channel]; r++)
+		for(int b=0; b<sim->NUM_BANKS[channel]; b++)
+			columns += sim->stats_num_read[channel][vault][r][b] + sim->stats_num_write[channel][vault][r][b];
+	return columns;
+}
+
+static long long int vault_activates(usimm_sim_t * sim, int channel, int vault)
+{
+	long long int activates = 0;
+
+	for(int r=0; r<sim->NUM_RANKS[channel]; r++)
+		activates += sim->stats_num_activate[channel][vault][r];
+	return activates;
+}
+
+static double vault_energy(usimm_sim_t * sim, int channel, int vault)
+{
+	double energy = 0;
+
+	for(int r=0; r<sim->NUM_RANKS[channel]; r++)
+		energy += energy_so_far(sim, channel, vault, r);
+	return energy;
+}
+
+// Take the cumulative counts the next epoch is measured against
+static void start_epoch(usimm_sim_t * sim)
+{
+	epoch_stats_t * epoch = &sim->epoch;
+
+	for(int c=0; c<sim->NUM_CHANNELS; c++)
+	{
+		for(int v=0; v<sim->NUM_VAULTS[c]; v++)
+		{
+			epoch->reads[c][v] = sim->stats_reads_completed[c][v];
+			epoch->writes[c][v] = sim->stats_writes_completed[c][v];
+			epoch->columns[c][v] = vault_columns(sim, c, v);
+			epoch->activates[c][v] = vault_activates(sim, c, v);
+			epoch->energy[c][v] = vault_energy(sim, c, v);
+		}
+	}
+	for(int c=0; c<sim->NUM_HMCS; c++)
+	{
+		epoch->link_busy[c][0] = sim->stats_link_busy[c][0];
+		epoch->link_busy[c][1] = sim->stats_link_busy[c][1];
+	}
+	for(int numc=0; numc<sim->NUMCORES; numc++)
+		epoch->committed[numc] = sim->committed[numc];
+
+	long long int ticks = epoch->length * sim->PROCESSOR_CLK_MULTIPLIER;
+	epoch->start = sim->CYCLE_VAL;
+	epoch->end = (sim->CYCLE_VAL / ticks + 1) * ticks;
+}
+
+static void write_epoch(usimm_sim_t * sim)
+{
+	epoch_stats_t * epoch = &sim->epoch;
+	long long int cycles = sim->CYCLE_VAL - epoch->start;
+	double processor_cycles = (double)cycles / sim->PROCESSOR_CLK_MULTIPLIER;
+	char prefix[EPOCH_PREFIX_SIZE];
+
+	if(cycles <= 0)
+		return;
+	snprintf(prefix, sizeof(prefix), "%lld,%lld,%lld", epoch->number, epoch->start, sim->CYCLE_VAL);
+
+	for(int c=0; c<sim->NUM_CHANNELS; c++)
+	{
+		for(int v=0; v<sim->NUM_VAULTS[c]; v++)
+		{
+			long long int reads = sim->stats_reads_completed[c][v] - epoch->reads[c][v];
+			long long int writes = sim->stats_writes_completed[c][v] - epoch->writes[c][v];
+			long long int columns = vault_columns(sim, c, v) - epoch->columns[c][v];
+			long long int activates = vault_activates(sim, c, v) - epoch->activates[c][v];
+			double energy = vault_energy(sim, c, v) - epoch->energy[c][v];
+			double hit_rate = columns ? (double)(columns - activates) / columns : 0;
+
+			fprintf(epoch->f, "%s,vault,%d,%d,,%lld,%lld,%.4f,%lld,%lld,%.4f,%lld,%.3f,,,\n", prefix, c, v,
+					reads, writes, (double)(reads + writes) * sim->CACHE_LINE_SIZE[c] / processor_cycles,
+					sim->read_queue_length[c][v], sim->write_queue_length[c][v],
+					hit_rate < 0 ? 0 : hit_rate, activates, energy / cycles);
+		}
+		if(c < sim->NUM_HMCS)
+			fprintf(epoch->f, "%s,link,%d,,,,,,,,,,,%.4f,%.4f,\n", prefix, c,
+					(double)(sim->stats_link_busy[c][0] - epoch->link_busy[c][0]) / cycles,
+					(double)(sim->stats_link_busy[c][1] - epoch->link_busy[c][1]) / cycles);
+	}
+	for(int numc=0; numc<sim->NUMCORES; numc++)
+		fprintf(epoch->f, "%s,core,,,%d,,,,,,,,,,,%.4f\n", prefix, numc,
+				(sim->committed[numc] - epoch->committed[numc]) / processor_cycles);
+	epoch->number++;
+}
+
+int start_epochs(usimm_sim_t * sim)
+{
+	epoch_stats_t * epoch = &sim->epoch;
+
+	epoch->f = fopen(epoch->file, "w");
+	if(epoch->f == NULL)
+	{
+		fprintf(sim->out, "Could not create epoch file %s.  Quitting.\n", epoch->file);
+		return -6;
+	}
+	epoch->buffer = (char*)malloc(EPOCH_BUFFER_SIZE);
+	if(epoch->buffer)
+		setvbuf(epoch->f, epoch->buffer, _IOFBF, EPOCH_BUFFER_SIZE);
+	fputs(EPOCH_HEADER, epoch->f);
+	epoch->number = 0;
+	start_epoch(sim);
+	return 0;
+}
+
+void end_epoch(usimm_sim_t * sim)
+{
+	write_epoch(sim);
+	start_epoch(sim);
+}
+
+int finish_epochs(usimm_sim_t * sim)
+{
+	epoch_stats_t * epoch = &sim->epoch;
+	int status = 0;
+
+	if(epoch->f == NULL)
+		return 0;
+	write_epoch(sim);
+	if(ferror(epoch->f) | fclose(epoch->f))
+	{
+		fprintf(sim->out, "Write error on epoch file %s.\n", epoch->file);
+		status = -6;
+	}
+	free(epoch->buffer);
+	epoch->f = NULL;
+	epoch->buffer = NULL;
+	return status;
+}
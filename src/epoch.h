@@ -0,0 +1,50 @@
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <stdio.h>
+
+#include "memory_controller.h"
+
+// Epoch statistics: a time series of the run, written as CSV. At the
+// end of every epoch of 'length' processor cycles one row is written
+// per vault (bandwidth, queue occupancy at the end of the epoch,
+// row-hit rate, activates and power), per HMC link (utilization of
+// each direction) and per core (IPC); epoch.c lists the columns. The
+// idle fast-forward stops at the end of an epoch, so every row but the
+// final, partial one covers exactly one epoch. The rows are written
+// through a large stdio buffer.
+
+typedef struct epochstats
+{
+  long long int length; // processor cycles, 0: off; set before usimm_sim_run
+  const char * file;
+
+  FILE * f;
+  char * buffer;
+  long long int number;
+  long long int start; // cycle the current epoch started on
+  long long int end; // cycle it ends on
+
+  // cumulative counts when the current epoch started
+  long long int reads[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int writes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int columns[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int activates[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  double energy[MAX_NUM_CHANNELS][MAX_NUM_VAULTS]; // mW times cycles
+  long long int link_busy[MAX_NUM_HMCS][2];
+  long long int committed[MAX_NUM_CORES];
+} epoch_stats_t;
+
+// Open the stream and start the first epoch at the current cycle.
+// Returns 0 on success and -6 if the file can not be written.
+int start_epochs(usimm_sim_t * sim);
+
+// Write the rows of the epoch ending on the current cycle and start the
+// next one; called once the cycle reaches sim->epoch.end.
+void end_epoch(usimm_sim_t * sim);
+
+// Write the final, partial epoch and close the stream. Returns 0 on
+// success and -6 on a write error.
+int finish_epochs(usimm_sim_t * sim);
+
+#endif //__EPOCH_H__
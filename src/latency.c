@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "latency.h"
+
+static const char * latency_kind_name[NUM_LATENCY_KINDS] = {
+	"read", "read queue", "read link", "read return", "write", "write queue", "write link"
+};
+
+static int latency_bucket(long long int latency)
+{
+	if(latency < LATENCY_SUB_BUCKETS)
+		return latency < 0 ? 0 : (int)latency;
+	if(latency >= (1LL << LATENCY_MAX_BITS))
+		return LATENCY_BUCKETS - 1;
+
+	// the top LATENCY_SUB_BITS bits below the leading one pick the bucket
+	int shift = 63 - __builtin_clzll((unsigned long long int)latency) - LATENCY_SUB_BITS;
+	return (shift + 1) * LATENCY_SUB_BUCKETS + (int)((latency >> shift) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+// The largest latency counted in a bucket
+static long long int bucket_top(int bucket)
+{
+	if(bucket < LATENCY_SUB_BUCKETS)
+		return bucket;
+
+	int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+	long long int low = (long long int)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << shift;
+	return low + (1LL << shift) - 1;
+}
+
+void record_latency(latency_histogram_t * histogram, long long int latency)
+{
+	histogram->bucket[latency_bucket(latency)]++;
+	histogram->count++;
+	if(latency > histogram->max)
+		histogram->max = latency;
+}
+
+void merge_latency(latency_histogram_t * into, const latency_histogram_t * from)
+{
+	for(int i=0; i<LATENCY_BUCKETS; i++)
+		into->bucket[i] += from->bucket[i];
+	into->count += from->count;
+	if(from->max > into->max)
+		into->max = from->max;
+}
+
+long long int latency_percentile(const latency_histogram_t * histogram, double percent)
+{
+	long long int rank = (long long int)ceil(percent / 100.0 * histogram->count);
+	long long int seen = 0;
+
+	if(histogram->count == 0)
+		return 0;
+	if(rank < 1)
+		rank = 1;
+	for(int i=0; i<LATENCY_BUCKETS; i++)
+	{
+		seen += histogram->bucket[i];
+		if(seen >= rank)
+			return bucket_top(i) < histogram->max ? bucket_top(i) : histogram->max;
+	}
+	return histogram->max;
+}
+
+void print_latency_line(FILE * f, const char * indent, const char * name, const latency_histogram_t * histogram)
+{
+	if(histogram->count == 0)
+		return;
+	fprintf(f, "%s%-*s %10lld %9lld %9lld %9lld %9lld %9lld\n", indent, 16 - (int)strlen(indent), name, histogram->count,
+			latency_percentile(histogram, 50), latency_percentile(histogram, 90), latency_percentile(histogram, 99),
+			latency_percentile(histogram, 99.9), histogram->max);
+}
+
+void print_latency_stats(FILE * f, const latency_stats_t * stats, const char * indent)
+{
+	for(int k=0; k<NUM_LATENCY_KINDS; k++)
+		print_latency_line(f, indent, latency_kind_name[k], &stats->kind[k]);
+}
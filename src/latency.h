@@ -0,0 +1,66 @@
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include <stdio.h>
+
+// Log-linear (HDR style) latency histograms. Latencies below
+// LATENCY_SUB_BUCKETS cycles are counted exactly; every power of two
+// above is split into LATENCY_SUB_BUCKETS equal buckets, so a reported
+// percentile is within 1/LATENCY_SUB_BUCKETS of the true value. From
+// 2^LATENCY_MAX_BITS cycles (about 4M, far beyond any latency a sane
+// configuration produces) latencies share the last bucket; the maximum
+// is kept exactly. A histogram is a fixed 1.2 KB whatever the number of
+// requests, and recording a latency is a few instructions.
+
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_MAX_BITS 22
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS * (LATENCY_MAX_BITS - LATENCY_SUB_BITS + 1))
+
+typedef struct latencyhistogram
+{
+  long long int count;
+  long long int max;
+  unsigned int bucket[LATENCY_BUCKETS];
+} latency_histogram_t;
+
+// The latencies of a request, in cycles from when its core queued it:
+//   total   until the read data is back at the processor side, or the
+//           write is done
+//   queue   waiting in the vault or channel queue until the column
+//           command issues
+//   link    HMC only: waiting in the core's queue and crossing the link
+//           to the vault
+//   return  HMC reads only: from the data leaving the DRAM until the
+//           response crossed the link back
+#define LAT_READ 0
+#define LAT_READ_QUEUE 1
+#define LAT_READ_LINK 2
+#define LAT_READ_RETURN 3
+#define LAT_WRITE 4
+#define LAT_WRITE_QUEUE 5
+#define LAT_WRITE_LINK 6
+#define NUM_LATENCY_KINDS 7
+
+typedef struct latencystats
+{
+  latency_histogram_t kind[NUM_LATENCY_KINDS];
+} latency_stats_t;
+
+void record_latency(latency_histogram_t * histogram, long long int latency);
+
+// Add the counts of one histogram to another.
+void merge_latency(latency_histogram_t * into, const latency_histogram_t * from);
+
+// The latency that 'percent' percent of the recorded latencies do not
+// exceed (the upper end of its bucket), or 0 if none were recorded.
+long long int latency_percentile(const latency_histogram_t * histogram, double percent);
+
+// Print a "name count p50 p90 p99 p99.9 max" line, the name indented by
+// 'indent' within a 16 character column; nothing if none were recorded.
+void print_latency_line(FILE * f, const char * indent, const char * name, const latency_histogram_t * histogram);
+
+// Print one such line per recorded kind.
+void print_latency_stats(FILE * f, const latency_stats_t * stats, const char * indent);
+
+#endif //__LATENCY_H__
@@ -1,2215 +1,2943 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <assert.h>
-
-#include "utlist.h"
-
-#include "utils.h"
-
-#include "params.h"
-#include "memory_controller.h"
-#include "scheduler.h"
-#include "processor.h"
-
-// ROB Structure, used to release stall on instructions 
-// when the read request completes
-extern struct robstructure * ROB;
-
-// Current Processor Cycle
-extern long long int CYCLE_VAL;
-
-#define max(a,b) (((a)>(b))?(a):(b))
-
-#define BIG_ACTIVATION_WINDOW 1000000
-
-// moving window that captures each activate issued in the past 
-int activation_record[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][BIG_ACTIVATION_WINDOW];
-
-int is_writeq_full(int thread_id)
-{
-	for(int channel=0; channel<NUM_CHANNELS; channel++){
-		if(channel < NUM_HMCS) {
-			if(write_queue_length_for_core[thread_id][channel] == WQ_CAPACITY[channel])
-				return 1;
-		}
-		else {
-			for(int vault=0; vault<NUM_VAULTS[channel]; vault++) {				
-				if(write_queue_length[channel][vault] == WQ_CAPACITY[channel])
-					return 1;
-			}
-		}
-    }
-    return 0;
-}
-
-// record an activate in the activation record
-void record_activate(int channel, int vault, int rank, long long int cycle)
-{
-	assert(activation_record[channel][vault][rank][(cycle%BIG_ACTIVATION_WINDOW)] == 0); //can't have two commands issued the same cycle - hence no two activations in the same cycle
-	activation_record[channel][vault][rank][(cycle%BIG_ACTIVATION_WINDOW)]=1;
-	
-	return;
-}
-
-// Have there been 3 or less activates in the last T_FAW period 
-int is_T_FAW_met(int channel, int vault, int rank, int cycle)
-{
-	int start = cycle;
-
-	int number_of_activates =0 ;
-
-	if(start >= T_FAW[channel])
-	{
-	  for(int i=1; i<= T_FAW[channel]; i++)
-	  {
-	    if(activation_record[channel][vault][rank][(start-i)%BIG_ACTIVATION_WINDOW] == 1)
-	      number_of_activates ++;
-	  }
-	}
-	else
-	{
-	  for(int i=1 ; i<=start ; i++)
-	  {
-	    if(activation_record[channel][vault][rank][start-i]%BIG_ACTIVATION_WINDOW == 1)
-	      number_of_activates ++;
-	  }
-	}
-	if(number_of_activates < 4)
-		return 1;
-	else
-		return 0;
-}
-
-// shift the moving window, clear out the past
-void flush_activate_record(int channel, int vault, int rank, long long int cycle)
-{
-	if(cycle >= T_FAW[channel] + MEMORY_CLK_MULTIPLIER[channel])
-	{
-	  for(int i=1; i<=MEMORY_CLK_MULTIPLIER[channel] ;i++) 
-		activation_record[channel][vault][rank][(cycle-T_FAW[channel]-i)%BIG_ACTIVATION_WINDOW] = 0; // make sure cycle >tFAW
-	}
-
-}
-
-// initialize dram variables and statistics
-void init_memory_controller_vars()
-{
-    num_read_merge =0;
-	num_write_merge =0;
-	for(int i=0; i<NUM_CHANNELS; i++)
-	{
-		for(int v=0; v<NUM_VAULTS[i]; v++)
-		{
-			for(int j=0; j<NUM_RANKS[i]; j++)
-			{
-				for(int w=0;w<BIG_ACTIVATION_WINDOW;w++)
-					activation_record[i][v][j][w] = 0;
-
-				for (int k=0; k<NUM_BANKS[i]; k++)
-				{
-					dram_state[i][v][j][k].state = IDLE;
-					dram_state[i][v][j][k].active_row = -1;
-					dram_state[i][v][j][k].next_pre = -1;
-					dram_state[i][v][j][k].next_pre = -1;
-					dram_state[i][v][j][k].next_pre = -1;
-					dram_state[i][v][j][k].next_pre = -1;
-
-					cmd_precharge_issuable[i][v][j][k] = 0;
-
-					stats_num_activate_read[i][v][j][k]=0;
-					stats_num_activate_write[i][v][j][k]=0;
-					stats_num_activate_spec[i][v][j][k]=0;
-					stats_num_precharge[i][v][j][k]=0;
-					stats_num_read[i][v][j][k]=0;
-					stats_num_write[i][v][j][k]=0;
-					cas_issued_current_cycle[i][v][j][k]=0;
-					
-				}
-
-				cmd_all_bank_precharge_issuable[i][v][j] =0;
-				cmd_powerdown_fast_issuable[i][v][j]=0;
-				cmd_powerdown_slow_issuable[i][v][j]=0;
-				cmd_powerup_issuable[i][v][j]=0;
-				cmd_refresh_issuable[i][v][j]=0;
-
-				next_refresh_completion_deadline[i][v][j] = 8*T_REFI[i];
-				last_refresh_completion_deadline[i][v][j] = 0;
-				forced_refresh_mode_on[i][v][j]=0;
-				refresh_issue_deadline[i][v][j] = next_refresh_completion_deadline[i][v][j] - T_RP[i] - 8*T_RFC[i];
-				num_issued_refreshes[i][v][j] = 0;
-			
-				stats_time_spent_in_active_power_down[i][v][j]=0;
-				stats_time_spent_in_precharge_power_down_slow[i][v][j]=0;
-				stats_time_spent_in_precharge_power_down_fast[i][v][j]=0;
-				last_activate[i][v][j]=0;
-				//If average_gap_between_activates is 0 then we know that there have been no activates to [i][j]
-				average_gap_between_activates[i][v][j]=0;
-
-				stats_num_powerdown_slow[i][v][j]=0;
-				stats_num_powerdown_fast[i][v][j]=0;
-				stats_num_powerup[i][v][j]=0;
-
-				stats_num_activate[i][v][j]=0;
-
-				command_issued_current_cycle[i][v]=0;
-			}
-
-			read_queue_head[i][v]=NULL;
-			write_queue_head[i][v]=NULL;
-
-			read_queue_length[i][v]=0;
-			write_queue_length[i][v]=0;
-
-			read_return_queue_head[i][v]=NULL;
-			read_return_queue_length[i][v] = 0;
-
-			command_issued_current_cycle[i][v]=0;
-
-			// Stats
-			stats_reads_merged_per_vault[i][v]=0;
-			stats_writes_merged_per_vault[i][v]=0;
-
-			stats_reads_seen[i][v]=0;
-			stats_writes_seen[i][v]=0;
-			stats_reads_completed[i][v]=0;
-			stats_writes_completed[i][v]=0;
-			stats_average_read_latency[i][v]=0;
-			stats_average_read_queue_latency[i][v]=0;
-			stats_average_write_latency[i][v]=0;
-			stats_average_write_queue_latency[i][v]=0;
-			stats_page_hits[i][v]=0;
-			stats_read_row_hit_rate[i][v]=0;
-			
-			drain_writes[i][v] = 0;
-		}
-	}
-	
-	for(int cores = 0; cores < NUMCORES; cores++)
-	{
-		for(int channel=0; channel < NUM_HMCS; channel++)
-		{
-			read_queue_per_core_head[cores][channel] = NULL;
-			write_queue_per_core_head[cores][channel] =  NULL;
-
-			write_queue_length_for_core[cores][channel] = 0;
-			read_queue_length_for_core[cores][channel] = 0;
-			
-			drain_write_for_core[cores][channel] = 0;
-			
-			next_request_schedule_time[channel] = 0;
-			next_respond_schedule_time[channel] = 0;
-		}
-	}
-}
-
-/********************************************************/
-/*	Utility Functions				*/
-/********************************************************/
-
-
-unsigned int log_base2(unsigned int new_value)
-{
-	int i;
-	for (i = 0; i < 32; i++) {
-		new_value >>= 1;
-		if (new_value == 0)
-			break;
-	}
-	return i;
-}
-
-// Function to decompose the incoming DRAM address into the
-// constituent channel, rank, bank, row and column ids. 
-// Note : To prevent memory leaks, call free() on the pointer returned
-// by this function after you have used the return value.
-dram_address_t * calc_dram_addr(long long int physical_address)
-{
-
-
-	long long int input_a, temp_b, temp_a;
-	
-	//right now, first 64GB reserved for HMC, next 64GB for DIMMs
-	int channel_num = 0;
-	int is_dimm_address = 0;
-	if(NUM_HMCS != 0) {
-		is_dimm_address = physical_address >> 36;
-		if(!is_dimm_address)
-			channel_num = 0;
-		else if(NUM_CHANNELS != NUM_HMCS)
-			channel_num = NUM_HMCS; 
-	}
-	else {
-		is_dimm_address = 1;
-		channel_num = 0;
-	}
-	
-	int channelBitWidth = (is_dimm_address)?log_base2(NUM_DIMMS):log_base2(NUM_HMCS);
-	int vaultBitWidth = log_base2(NUM_VAULTS[channel_num]);
-	int rankBitWidth = log_base2(NUM_RANKS[channel_num]);
-	int bankBitWidth = log_base2(NUM_BANKS[channel_num]);
-	int rowBitWidth = log_base2(NUM_ROWS[channel_num]);
-	int colBitWidth = log_base2(NUM_COLUMNS[channel_num]);
-	int byteOffsetWidth = log_base2(CACHE_LINE_SIZE[channel_num]);
-
-
-
-	dram_address_t * this_a = (dram_address_t*)malloc(sizeof(dram_address_t));
-
-	this_a->actual_address = physical_address;
-
-	input_a = physical_address;
-
-	input_a = input_a >> byteOffsetWidth;		  // strip out the cache_offset
-
-
-	if(!is_dimm_address) {
-		temp_b = input_a;   	
-		input_a = input_a >> channelBitWidth;
-		temp_a  = input_a << channelBitWidth;
-		this_a->channel = temp_a ^ temp_b; 		// strip out the channel address
-		
-		temp_b = input_a;   	
-		input_a = input_a >> vaultBitWidth;
-		temp_a  = input_a << vaultBitWidth;
-		this_a->vault = temp_a ^ temp_b; 		// strip out the vault address
-
-
-		temp_b = input_a;
-		input_a = input_a >> bankBitWidth;
-		temp_a  = input_a << bankBitWidth;
-		this_a->bank = temp_a ^ temp_b;		// strip out the bank address 
-
-
-		temp_b = input_a;
-		input_a = input_a >> rankBitWidth;
-		temp_a  = input_a << rankBitWidth;
-		this_a->rank = temp_a ^ temp_b;     		// strip out the rank address
-
-
-		temp_b = input_a;
-		input_a = input_a >> colBitWidth;
-		temp_a  = input_a << colBitWidth;
-		this_a->column = temp_a ^ temp_b;		//strip out the column address
-
-
-		temp_b = input_a;
-		input_a = input_a >> rowBitWidth;
-		temp_a  = input_a << rowBitWidth;
-		this_a->row = temp_a ^ temp_b;			// strip out the row number
-	}
-	else if(is_dimm_address && ADDRESS_MAPPING == 0)
-	{
-		this_a->vault = 0;
-			
-		temp_b = input_a;				
-		input_a = input_a >> colBitWidth;
-		temp_a  = input_a << colBitWidth;
-		this_a->column = temp_a ^ temp_b;		//strip out the column address
-		
-
-		temp_b = input_a;   				
-		input_a = input_a >> channelBitWidth;
-		temp_a  = input_a << channelBitWidth;
-		this_a->channel = temp_a ^ temp_b; 		// strip out the channel address
-		this_a->channel += NUM_HMCS;
-
-		temp_b = input_a;				
-		input_a = input_a >> bankBitWidth;
-		temp_a  = input_a << bankBitWidth;
-		this_a->bank = temp_a ^ temp_b;		// strip out the bank address 
-
-
-		temp_b = input_a;			
-		input_a = input_a >> rankBitWidth;
-		temp_a  = input_a << rankBitWidth;
-		this_a->rank = temp_a ^ temp_b;     		// strip out the rank address
-
-
-		temp_b = input_a;		
-		input_a = input_a >> rowBitWidth;
-		temp_a  = input_a << rowBitWidth;
-		this_a->row = temp_a ^ temp_b;		// strip out the row number
-	}
-	else if(is_dimm_address && ADDRESS_MAPPING == 1)
-	{
-		this_a->vault = 0;
-
-		temp_b = input_a;   	
-		input_a = input_a >> channelBitWidth;
-		temp_a  = input_a << channelBitWidth;
-		this_a->channel = temp_a ^ temp_b; 		// strip out the channel address
-		this_a->channel += NUM_HMCS;
-
-
-		temp_b = input_a;
-		input_a = input_a >> bankBitWidth;
-		temp_a  = input_a << bankBitWidth;
-		this_a->bank = temp_a ^ temp_b;		// strip out the bank address 
-
-
-		temp_b = input_a;
-		input_a = input_a >> rankBitWidth;
-		temp_a  = input_a << rankBitWidth;
-		this_a->rank = temp_a ^ temp_b;     		// strip out the rank address
-
-
-		temp_b = input_a;
-		input_a = input_a >> colBitWidth;
-		temp_a  = input_a << colBitWidth;
-		this_a->column = temp_a ^ temp_b;		//strip out the column address
-
-
-		temp_b = input_a;
-		input_a = input_a >> rowBitWidth;
-		temp_a  = input_a << rowBitWidth;
-		this_a->row = temp_a ^ temp_b;			// strip out the row number
-	}
-	return(this_a);
-}
-
-// Function to create a new request node to be inserted into the read
-// or write queue.
-void * init_new_node(long long int physical_address, long long int arrival_time, optype_t type, int thread_id, int instruction_id, long long int instruction_pc)
-{
-	request_t * new_node = NULL;
-
-	new_node = (request_t*)malloc(sizeof(request_t));
-
-	if(new_node == NULL)
-	{
-		printf("FATAL : Malloc Error\n");
-
-		exit(-1);
-	}
-	else
-	{
-
-		new_node->physical_address = physical_address;
-
-		new_node->arrival_time = arrival_time;
-
-		new_node->dispatch_time = -100;
-
-		new_node->completion_time = -100;
-
-		new_node->latency = -100;
-
-		new_node->thread_id = thread_id;
-
-		new_node->next_command = NOP;
-
-		new_node->command_issuable = 0;
-
-		new_node->operation_type = type;
-
-		new_node->request_served = 0;
-
-		new_node->instruction_id = instruction_id;
-
-		new_node->instruction_pc = instruction_pc;
-
-		new_node->next = NULL;
-
-		dram_address_t * this_node_addr = calc_dram_addr(physical_address);
-
-		new_node->dram_addr.actual_address = physical_address;
-		new_node->dram_addr.channel = this_node_addr->channel;
-		new_node->dram_addr.vault = this_node_addr->vault;
-		new_node->dram_addr.rank = this_node_addr->rank;
-		new_node->dram_addr.bank = this_node_addr->bank;
-		new_node->dram_addr.row = this_node_addr->row;
-		new_node->dram_addr.column = this_node_addr->column;
-
-		free(this_node_addr);
-
-		new_node->user_ptr = NULL;
-
-		return (new_node);
-	}
-}
-
-// Function that checks to see if an incoming read can be served by a
-// write request pending in the write queue and return
-// WQ_LOOKUP_LATENCY if there is a match. Also the function goes over
-// the read_queue to see if there is a pending read for the same
-// address and avoids duplication. The 2nd read is assumed to be
-// serviced when the original request completes.
-
-int read_matches_write_or_read_queue(long long int physical_address, int thread_id)
-{
-	//get channel info
-	dram_address_t * this_addr = calc_dram_addr(physical_address);
-	int channel = this_addr->channel;
-	int vault = this_addr->vault;
-	free(this_addr);
-
-	request_t * wr_ptr = NULL;
-	request_t * rd_ptr = NULL;
-
-	if(channel < NUM_HMCS) {
-		LL_FOREACH(write_queue_per_core_head[thread_id][channel], wr_ptr)
-		{
-			if(wr_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_read_merge ++;
-			  stats_reads_merged_per_vault[channel][vault]++;
-			  return WQ_LOOKUP_LATENCY[channel];
-			}
-		}
-		LL_FOREACH(read_queue_per_core_head[thread_id][channel], rd_ptr)
-		{
-			if(rd_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_read_merge ++;
-			  stats_reads_merged_per_vault[channel][vault]++;
-			  return RQ_LOOKUP_LATENCY[channel];
-			}
-		}
-	}
-
-	else {
-		LL_FOREACH(write_queue_head[channel][vault], wr_ptr)
-		{
-			if(wr_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_read_merge ++;
-			  stats_reads_merged_per_vault[channel][vault]++;
-			  return WQ_LOOKUP_LATENCY[channel];
-			}
-		}
-
-		LL_FOREACH(read_queue_head[channel][vault], rd_ptr)
-		{
-			if(rd_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_read_merge ++;
-			  stats_reads_merged_per_vault[channel][vault]++;
-			  return RQ_LOOKUP_LATENCY[channel];
-			}
-		}
-	}
-	return 0;
-}
-
-// Function to merge writes to the same address
-int write_exists_in_write_queue(long long int physical_address, int thread_id)
-{
-	//get channel info
-	dram_address_t * this_addr = calc_dram_addr(physical_address);
-	int channel = this_addr->channel;
-	int vault = this_addr->vault;
-	free(this_addr);
-	
-	request_t * wr_ptr = NULL;
-
-	if(channel < NUM_HMCS) {
-		LL_FOREACH(write_queue_per_core_head[thread_id][channel], wr_ptr)
-		{
-			if(wr_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_write_merge ++;
-			  stats_writes_merged_per_vault[channel][vault]++;
-			  return 1;
-			}
-		}
-	}
-	else {
-		LL_FOREACH(write_queue_head[channel][vault], wr_ptr)
-		{
-			if(wr_ptr->dram_addr.actual_address == physical_address)
-			{
-			  num_write_merge ++;
-			  stats_writes_merged_per_vault[channel][vault]++;
-			  return 1;
-			}
-		}
-	}
-	return 0;
-
-}
-
-
-void transfer_request_to_HMCs(int channel)
-{
-	request_t * transfer_request = NULL;
-	optype_t this_op = READ;
-	int vault = 0;
-
-	if(CYCLE_VAL>=next_request_schedule_time[channel] && CYCLE_VAL)
-	{	
-		// gets next request to be transmistted through Link to HMC
-		transfer_request = schedule_to_hmc(channel);
-		if(transfer_request != NULL)
-		{
-			dram_address_t * this_addr = calc_dram_addr(transfer_request->physical_address);
-			vault = this_addr->vault;
-			free(this_addr);
-			this_op = transfer_request->operation_type;
-			
-			// updating the arrival time for vault of the request to next_request_schedule_time 
-			transfer_request->arrival_time = next_request_schedule_time[channel];
-			
-			if(this_op == READ)
-			{
-				LL_DELETE(read_queue_per_core_head[transfer_request->thread_id][channel],transfer_request);
-				read_queue_length_for_core[transfer_request->thread_id][channel]-- ;
-
-				LL_APPEND(read_queue_head[channel][vault], transfer_request);
-				read_queue_length[channel][vault] ++;
-
-			}
-			else if(this_op == WRITE)
-			{
-				LL_DELETE(write_queue_per_core_head[transfer_request->thread_id][channel],transfer_request);
-				write_queue_length_for_core[transfer_request->thread_id][channel]-- ;
-
-				LL_APPEND(write_queue_head[channel][vault], transfer_request);
-				write_queue_length[channel][vault] ++;
-			}
-			else
-			{
-				printf("PANIC: SCHED_ERROR : Request selected is not defined with operation types:%lld.\n", CYCLE_VAL);
-			}
-		}
-		else
-		{
-
-		}
-	}
-	else
-	{
-			// Wait unit next_request_schedule_time to make a new transfer
-	}
-	//printf(" Next SCheduled time : %lld \n", next_request_schedule_time);
-}
-
-void transfer_response_to_PROCESSOR(int channel)
-{
-	request_t * transfer_request = NULL;
-
-	if(CYCLE_VAL>=next_respond_schedule_time[channel]  && CYCLE_VAL)
-	{	
-		// gets next request to be transmistted through Link to HMC
-		transfer_request = schedule_completed_requests(channel);
-		if(transfer_request != NULL)
-		{			
-			assert(transfer_request->operation_type==READ);
-			assert(transfer_request->request_served==1);
-			// updating the arrival time for vault of the request to next_request_schedule_time 
-			//transfer_request->arrival_time = next_request_schedule_time;
-			transfer_request->request_served = 2 ;
-			ROB[transfer_request->thread_id].comptime[transfer_request->instruction_id] = next_respond_schedule_time[channel] + PIPELINEDEPTH ;
-		}
-		else
-		{
-			// No responses left
-		}
-	}
-	else
-	{
-			// Wait unit next_request_schedule_time to make a new transfer
-	}
-	//printf(" Next response scheduled time : %lld \n", next_respond_schedule_time);
-}
-
-// Insert a new read to the read queue
-request_t * insert_read(long long int physical_address, long long int arrival_time, int thread_id, int instruction_id, long long int instruction_pc)
-{
-
-	optype_t this_op = READ;
-
-	//get channel info
-	dram_address_t * this_addr = calc_dram_addr(physical_address);
-	int channel = this_addr->channel;
-	int vault = this_addr->vault;
-	free(this_addr);
-
-	stats_reads_seen[channel][vault]++;
-
-	request_t * new_node = init_new_node(physical_address, arrival_time, this_op, thread_id, instruction_id, instruction_pc);
-
-	if(channel < NUM_HMCS) {
-		LL_APPEND(read_queue_per_core_head[thread_id][channel], new_node);
-		read_queue_length_for_core[thread_id][channel]++;
-	}
-	else {
-		LL_APPEND(read_queue_head[channel][vault], new_node);
-		read_queue_length[channel][vault]++;
-	}
-
-	//UT_MEM_DEBUG("\nCyc: %lld New READ:%lld Core:%d Chan:%d Rank:%d Bank:%d Row:%lld RD_Q_Length:%lld\n", CYCLE_VAL, new_node->id, new_node->thread_id, new_node->dram_addr.channel,  new_node->dram_addr.rank,  new_node->dram_addr.bank,  new_node->dram_addr.row, read_queue_length[channel]);
-	
-	return new_node;
-}
-
-// Insert a new write to the write queue
-request_t * insert_write(long long int physical_address, long long int arrival_time, int thread_id, int instruction_id)
-{
-	optype_t this_op = WRITE;
-
-	dram_address_t * this_addr = calc_dram_addr(physical_address);
-	int channel = this_addr->channel;
-	int vault = this_addr->vault;
-	free(this_addr);
-
-	stats_writes_seen[channel][vault]++;
-
-	request_t * new_node = init_new_node(physical_address, arrival_time, this_op, thread_id, instruction_id, 0);
-
-	if(channel < NUM_HMCS) {
-		LL_APPEND(write_queue_per_core_head[thread_id][channel], new_node);
-		write_queue_length_for_core[thread_id][channel]++;
-	}
-	else {
-		LL_APPEND(write_queue_head[channel][vault], new_node);
-		write_queue_length[channel][vault]++;
-	}
-
-	//UT_MEM_DEBUG("\nCyc: %lld New WRITE:%lld Core:%d Chan:%d Rank:%d Bank:%d Row:%lld WR_Q_Length:%lld\n", CYCLE_VAL, new_node->id, new_node->thread_id, new_node->dram_addr.channel,  new_node->dram_addr.rank,  new_node->dram_addr.bank,  new_node->dram_addr.row, write_queue_length[channel]);
-
-	return new_node;
-}
-
-// Function to update the states of the read queue requests.
-// Each DRAM cycle, this function iterates over the read queue and
-// updates the next_command and command_issuable fields to mark which
-// commands can be issued this cycle
-void update_read_queue_commands(int channel, int vault)
-{
-	request_t * curr = NULL;
-
-	LL_FOREACH(read_queue_head[channel][vault],curr)
-	{
-		// ignore the requests whose completion time has been determined
-		// these requests will be removed this very cycle 
-		if(curr->request_served == 1)
-			continue; 
-
-		int bank = curr->dram_addr.bank;
-
-		int rank = curr->dram_addr.rank;
-
-		int row = curr->dram_addr.row;
-
-		switch (dram_state[channel][vault][rank][bank].state)
-		{
-		  // if the DRAM bank has no rows open and the chip is
-		  // powered up, the next command for the request
-		  // should be ACT.
-			case IDLE:
-			case PRECHARGING:
-			case REFRESHING:
-
-			  
-				curr->next_command = ACT_CMD;
-
-
-				if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_act && is_T_FAW_met(channel, vault, rank, CYCLE_VAL))
-					curr->command_issuable = 1;
-				else
-					curr->command_issuable = 0;
-				
-				// check if we are in OR too close to the forced refresh period
-				if(forced_refresh_mode_on[channel][vault][rank] || ((CYCLE_VAL + T_RAS[channel]) > refresh_issue_deadline[channel][vault][rank]))
-					curr->command_issuable = 0;
-				break;
-
-			case ROW_ACTIVE:
-
-				// if the bank is active then check if this is a row-hit or not
-				// If the request is to the currently
-				// opened row, the next command should
-				// be a COL_RD, else it should be a
-				// PRECHARGE
-				if(row == dram_state[channel][vault][rank][bank].active_row)
-				{
-					curr->next_command = COL_READ_CMD;
-					
-					if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_read)
-						curr->command_issuable = 1;
-					else
-						curr->command_issuable = 0;
-					
-					if(forced_refresh_mode_on[channel][vault][rank] ||((CYCLE_VAL + T_RTP[channel]) > refresh_issue_deadline[channel][vault][rank]))
-						curr->command_issuable = 0;
-				}
-				else
-				{
-					curr->next_command = PRE_CMD;
-
-					if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_pre)
-						curr->command_issuable = 1;
-					else
-						curr->command_issuable = 0;
-					
-					if(forced_refresh_mode_on[channel][vault][rank]|| ((CYCLE_VAL+T_RP[channel]) > refresh_issue_deadline[channel][vault][rank]))
-						curr->command_issuable = 0;
-
-				}
-				
-				break;
-				// if the chip was powered, down the
-				// next command required is power_up
-
-			case PRECHARGE_POWER_DOWN_SLOW :
-			case PRECHARGE_POWER_DOWN_FAST:
-			case ACTIVE_POWER_DOWN :
-
-				curr->next_command = PWR_UP_CMD;
-
-				if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_powerup)
-					curr->command_issuable = 1;
-				else
-					curr->command_issuable=0;
-				
-				if((dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW) && ((CYCLE_VAL + T_XP_DLL[channel]) > refresh_issue_deadline[channel][vault][rank] ))
-					curr->command_issuable = 0;
-				else if(((dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST) || (dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN)) && ((CYCLE_VAL + T_XP[channel]) > refresh_issue_deadline[channel][vault][rank] ))
-					curr->command_issuable = 0;
-
-				break;
-
-
-			default : break;
-		}
-	}
-}
-
-// Similar to update_read_queue above, but for write queue
-void update_write_queue_commands(int channel, int vault)
-{
-	request_t * curr = NULL;
-
-	LL_FOREACH(write_queue_head[channel][vault], curr)
-	{
-
-		if(curr->request_served == 2 && channel < NUM_HMCS)
-			continue; 
-		else if(curr->request_served == 1 && channel >= NUM_HMCS)
-			continue;
-		
-		int bank = curr->dram_addr.bank;
-
-		int rank = curr->dram_addr.rank;
-
-		int row = curr->dram_addr.row;
-
-		switch (dram_state[channel][vault][rank][bank].state)
-		{
-			case IDLE:
-			case PRECHARGING:
-			case REFRESHING:
-				curr->next_command = ACT_CMD;
-
-				if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_act && is_T_FAW_met(channel, vault, rank, CYCLE_VAL))
-					curr->command_issuable = 1;
-				else
-					curr->command_issuable = 0;
-				
-				// check if we are in or too close to the forced refresh period
-				if(forced_refresh_mode_on[channel][vault][rank] || ((CYCLE_VAL + T_RAS[channel]) > refresh_issue_deadline[channel][vault][rank]))
-					curr->command_issuable = 0;
-
-				break;
-
-
-			case ROW_ACTIVE:
-
-				if(row == dram_state[channel][vault][rank][bank].active_row)
-				{
-					curr->next_command = COL_WRITE_CMD;
-
-					if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_write)
-						curr->command_issuable = 1;
-					else
-						curr->command_issuable = 0;
-
-					if(forced_refresh_mode_on[channel][vault][rank]|| ((CYCLE_VAL+T_CWD[channel]+T_DATA_TRANS[channel]+T_WR[channel]) > refresh_issue_deadline[channel][vault][rank]))
-						curr->command_issuable = 0;
-				}
-				else
-				{
-					curr->next_command = PRE_CMD;
-
-					if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_pre)
-						curr->command_issuable = 1;
-					else
-						curr->command_issuable = 0;
-
-					if(forced_refresh_mode_on[channel][vault][rank]|| ((CYCLE_VAL+T_RP[channel]) > refresh_issue_deadline[channel][vault][rank]))
-						curr->command_issuable = 0;
-
-				}
-				
-				
-				break;
-
-			case PRECHARGE_POWER_DOWN_SLOW:
-			case PRECHARGE_POWER_DOWN_FAST:
-			case ACTIVE_POWER_DOWN :
-
-				curr->next_command = PWR_UP_CMD;
-
-				if(CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_powerup)
-					curr->command_issuable = 1;
-				else
-					curr->command_issuable = 0;
-
-				if(forced_refresh_mode_on[channel][vault][rank])
-					curr->command_issuable= 0;
-
-				if((dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW) && ((CYCLE_VAL + T_XP_DLL[channel]) > refresh_issue_deadline[channel][vault][rank] ))
-					curr->command_issuable = 0;
-				else if(((dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST) || (dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN)) && ((CYCLE_VAL + T_XP[channel]) > refresh_issue_deadline[channel][vault][rank] ))
-					curr->command_issuable = 0;
-
-				break;
-
-			default : break;
-		}
-	}
-}
-
-// Remove finished requests from the queues.
-void clean_queues(int channel, int vault)
-{
-
-	request_t * rd_ptr =  NULL;
-	request_t * rd_tmp = NULL;
-	request_t * wrt_ptr = NULL;
-	request_t * wrt_tmp = NULL;
-
-	// Delete all READ requests whose completion time has been determined i.e. COL_RD has been issued
-	if(channel < NUM_HMCS) {
-		LL_FOREACH_SAFE(read_return_queue_head[channel][vault],rd_ptr,rd_tmp) 
-		{
-			if(rd_ptr->request_served == 2)
-			{
-				assert(rd_ptr->next_command == COL_READ_CMD);
-				assert(rd_ptr->completion_time != -100);
-				LL_DELETE(read_return_queue_head[channel][vault],rd_ptr);
-				if(rd_ptr->user_ptr)
-					free(rd_ptr->user_ptr);
-
-				free(rd_ptr);
-				read_return_queue_length[channel][vault]--;
-				assert(read_return_queue_length[channel][vault]>=0);
-			}
-		}
-	}
-	else {
-		LL_FOREACH_SAFE(read_queue_head[channel][vault],rd_ptr,rd_tmp) 
-		{
-			if(rd_ptr->request_served == 1)
-			{
-				assert(rd_ptr->next_command == COL_READ_CMD);
-				assert(rd_ptr->completion_time != -100);
-				LL_DELETE(read_queue_head[channel][vault],rd_ptr);
-				if(rd_ptr->user_ptr)
-					free(rd_ptr->user_ptr);
-
-				free(rd_ptr);
-				read_queue_length[channel][vault]--;
-				assert(read_queue_length[channel][vault]>=0);
-			}
-		}
-	}
-
-	// Delete all WRITE requests whose completion time has been determined i.e COL_WRITE has been issued
-	LL_FOREACH_SAFE(write_queue_head[channel][vault],wrt_ptr,wrt_tmp) 
-	{
-		if((wrt_ptr->request_served == 2 && channel < NUM_HMCS) || (wrt_ptr->request_served == 1 && channel >= NUM_HMCS))
-		{
-			assert(wrt_ptr->next_command == COL_WRITE_CMD);
-
-			LL_DELETE(write_queue_head[channel][vault],wrt_ptr);
-
-			if(wrt_ptr->user_ptr)
-				free(wrt_ptr->user_ptr);
-
-			free(wrt_ptr);
-
-			write_queue_length[channel][vault]--;
-
-			assert(write_queue_length[channel][vault]>=0);
-		}
-	}
-}
-
-// function to update a completed read request to read return queue of each vault 
-void update_read_return_queue(int channel, int vault)
-{
-	request_t * request = NULL;
-	
-	LL_FOREACH(read_queue_head[channel][vault],request)
-	{
-		if(request->request_served == 1 && (CYCLE_VAL >= request->completion_time))
-		{
-			assert(request->next_command == COL_READ_CMD);
-	
-			assert(request->completion_time != -100);
-		
-			LL_DELETE(read_queue_head[channel][vault],request);
-		
-			read_queue_length[channel][vault]--;
-		
-			assert(read_queue_length[channel][vault]>=0);
-		
-			LL_APPEND(read_return_queue_head[channel][vault],request);
-		
-			read_return_queue_length[channel][vault]++;
-
-			//printf(" Updated Read Return queue with hmc id %d vault %d \n", hmc , vault );
-		}
-	}
-}
-
-
-// This affects state change
-// Issue a valid command for a request in either the read or write
-// queue.
-// Upon issuing the request, the dram_state is changed and the
-// next_"cmd" variables are updated to indicate when the next "cmd"
-// can be issued to each bank
-int issue_request_command(request_t * request) 
-{
-	long long int cycle =  CYCLE_VAL;
-	if(request->command_issuable != 1 || command_issued_current_cycle[request->dram_addr.channel][request->dram_addr.vault] || CYCLE_VAL < request->arrival_time)
-	{
-		printf("PANIC: SCHED_ERROR : Command for request selected can not be issued in  cycle:%lld.\n", CYCLE_VAL);
-		return 0;
-	}
-
-	int channel = request->dram_addr.channel;
-	int vault = request->dram_addr.vault;
-	int rank = request->dram_addr.rank;
-	int bank = request->dram_addr.bank;
-	long long int row = request->dram_addr.row;
-	command_t cmd = request->next_command;
-
-	switch(cmd)
-	{
-		case ACT_CMD :
-
-			assert(dram_state[channel][vault][rank][bank].state == PRECHARGING || dram_state[channel][vault][rank][bank].state == IDLE || dram_state[channel][vault][rank][bank].state == REFRESHING);
-
-			//UT_MEM_DEBUG("\nCycle: %lld Cmd:ACT Req:%lld Chan:%d Rank:%d Bank:%d Row:%lld\n", CYCLE_VAL, request->id, channel, vault, rank, bank, row);
-
-			// open row
-			dram_state[channel][vault][rank][bank].state = ROW_ACTIVE;
-
-			dram_state[channel][vault][rank][bank].active_row = row;
-
-			dram_state[channel][vault][rank][bank].next_pre = max((cycle + T_RAS[channel]) , dram_state[channel][vault][rank][bank].next_pre);
-			
-			dram_state[channel][vault][rank][bank].next_refresh = max((cycle + T_RAS[channel]) , dram_state[channel][vault][rank][bank].next_refresh);
-
-			dram_state[channel][vault][rank][bank].next_read = max(cycle + T_RCD[channel], dram_state[channel][vault][rank][bank].next_read); 
-
-			dram_state[channel][vault][rank][bank].next_write = max(cycle + T_RCD[channel],  dram_state[channel][vault][rank][bank].next_write);
-
-			dram_state[channel][vault][rank][bank].next_act = max(cycle + T_RC[channel],  dram_state[channel][vault][rank][bank].next_act);
-
-			dram_state[channel][vault][rank][bank].next_powerdown = max(cycle + T_RCD[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-			for(int i=0;i<NUM_BANKS[channel];i++)
-				if(i!=bank)
-					dram_state[channel][vault][rank][i].next_act = max(cycle+T_RRD[channel], dram_state[channel][vault][rank][i].next_act);
-
-			record_activate(channel, vault, rank, cycle);
-
-			if(request->operation_type == READ)
-				stats_num_activate_read[channel][vault][rank][bank]++;
-			else
-				stats_num_activate_write[channel][vault][rank][bank]++;
-
-			stats_num_activate[channel][vault][rank]++;
-
-			average_gap_between_activates[channel][vault][rank] = ((average_gap_between_activates[channel][vault][rank]*(stats_num_activate[channel][vault][rank]-1)) + (CYCLE_VAL-last_activate[channel][vault][rank]))/stats_num_activate[channel][vault][rank];
-
-			last_activate[channel][vault][rank] = CYCLE_VAL;
-
-			command_issued_current_cycle[channel][vault] = 1;
-			break;
-
-		case COL_READ_CMD :
-
-			assert(dram_state[channel][vault][rank][bank].state == ROW_ACTIVE) ;
-
-			dram_state[channel][vault][rank][bank].next_pre = max(cycle + T_RTP[channel] , dram_state[channel][vault][rank][bank].next_pre);
-			
-			dram_state[channel][vault][rank][bank].next_refresh = max(cycle + T_RTP[channel] , dram_state[channel][vault][rank][bank].next_refresh);
-
-			dram_state[channel][vault][rank][bank].next_powerdown = max (cycle+T_RTP[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-			for(int i=0;i<NUM_RANKS[channel];i++)
-			{
-				for(int j=0;j<NUM_BANKS[channel];j++)
-				{
-					if(i!=rank)
-						dram_state[channel][vault][i][j].next_read = max(cycle+ T_DATA_TRANS[channel] + T_RTRS[channel], dram_state[channel][vault][i][j].next_read);
-
-					else
-						dram_state[channel][vault][i][j].next_read = max(cycle + max(T_CCD[channel], T_DATA_TRANS[channel]), dram_state[channel][vault][i][j].next_read); 
-
-					dram_state[channel][vault][i][j].next_write = max(cycle + T_CAS[channel]+ T_DATA_TRANS[channel] + T_RTRS[channel]- T_CWD[channel] ,  dram_state[channel][vault][i][j].next_write);
-				}
-			}
-
-			// set the completion time of this read request
-			// in the ROB and the controller queue.
-			request->completion_time = CYCLE_VAL+ T_CAS[channel] + T_DATA_TRANS[channel] ;
-			request->latency = request->completion_time - request->arrival_time;
-			request->dispatch_time = CYCLE_VAL;
-			request->request_served = 1;
-
-			// update the ROB with the completion time
-			if(channel >= NUM_HMCS)
-				ROB[request->thread_id].comptime[request->instruction_id] = request->completion_time+PIPELINEDEPTH;
-
-			stats_reads_completed[channel][vault]++;
-			stats_average_read_latency[channel][vault] = ((stats_reads_completed[channel][vault]-1)*stats_average_read_latency[channel][vault] + request->latency)/stats_reads_completed[channel][vault];
-			stats_average_read_queue_latency[channel][vault] = ((stats_reads_completed[channel][vault]-1)*stats_average_read_queue_latency[channel][vault] + (request->dispatch_time - request->arrival_time))/stats_reads_completed[channel][vault];
-			//UT_MEM_DEBUG("Req:%lld finishes at Cycle: %lld\n", request->id, request->completion_time);
-
-			//printf("Cycle: %10lld, Reads  Completed = %5lld, this_latency= %5lld, latency = %f\n", CYCLE_VAL, stats_reads_completed[channel][vault], request->latency, stats_average_read_latency[channel][vault]);	
-
-			stats_num_read[channel][vault][rank][bank]++;
-
-			for(int i=0; i<NUM_RANKS[channel] ;i++)
-			{
-				if(i!=rank)
-					stats_time_spent_terminating_reads_from_other_ranks[channel][vault][i] += T_DATA_TRANS[channel];
-			}
-
-			command_issued_current_cycle[channel][vault] = 1;
-			cas_issued_current_cycle[channel][vault][rank][bank]=1;
-			break;
-
-		case COL_WRITE_CMD :
-
-
-			assert(dram_state[channel][vault][rank][bank].state == ROW_ACTIVE);
-
-			//UT_MEM_DEBUG("\nCycle: %lld Cmd: COL_WRITE Req:%lld Chan:%d Rank:%d Bank:%d \n", CYCLE_VAL, request->id, channel, vault, rank, bank);
-
-			dram_state[channel][vault][rank][bank].next_pre = max(cycle + T_CWD[channel] +T_DATA_TRANS[channel] + T_WR[channel], dram_state[channel][vault][rank][bank].next_pre);
-			
-			dram_state[channel][vault][rank][bank].next_refresh = max(cycle + T_CWD[channel] +T_DATA_TRANS[channel] + T_WR[channel], dram_state[channel][vault][rank][bank].next_refresh);
-
-			dram_state[channel][vault][rank][bank].next_powerdown = max (cycle + T_CWD[channel] + T_DATA_TRANS[channel] + T_WR[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-			for(int i=0;i<NUM_RANKS[channel];i++)
-			{
-				for(int j=0;j<NUM_BANKS[channel];j++)
-				{
-					if(i!=rank)
-					{
-						dram_state[channel][vault][i][j].next_write = max(cycle + T_DATA_TRANS[channel] + T_RTRS[channel], dram_state[channel][vault][i][j].next_write);
-
-						dram_state[channel][vault][i][j].next_read = max(cycle + T_CWD[channel] + T_DATA_TRANS[channel] + T_RTRS[channel] - T_CAS[channel], dram_state[channel][vault][i][j].next_read);
-					}
-					else
-					{
-						dram_state[channel][vault][i][j].next_write = max(cycle + max(T_CCD[channel], T_DATA_TRANS[channel]), dram_state[channel][vault][i][j].next_write); 
-
-						dram_state[channel][vault][i][j].next_read = max(cycle + T_CWD[channel] + T_DATA_TRANS[channel] + T_WTR[channel] ,  dram_state[channel][vault][i][j].next_read);
-					}
-				}
-			}
-
-			// set the completion time of this write request
-			request->completion_time = CYCLE_VAL+ T_DATA_TRANS[channel] + T_WR[channel];
-			request->latency = request->completion_time - request->arrival_time;
-			request->dispatch_time = CYCLE_VAL;
-			request->request_served = (channel<NUM_HMCS)?2:1;
-
-			stats_writes_completed[channel][vault]++;
-
-			stats_num_write[channel][vault][rank][bank]++;
-			
-			stats_average_write_latency[channel][vault] = ((stats_writes_completed[channel][vault]-1)*stats_average_write_latency[channel][vault] + request->latency)/stats_writes_completed[channel][vault];
-			stats_average_write_queue_latency[channel][vault] = ((stats_writes_completed[channel][vault]-1)*stats_average_write_queue_latency[channel][vault] + (request->dispatch_time - request->arrival_time))/stats_writes_completed[channel][vault];
-			//UT_MEM_DEBUG("Req:%lld finishes at Cycle: %lld\n", request->id, request->completion_time);
-
-			//printf("Cycle: %10lld, Writes Completed = %5lld, this_latency= %5lld, latency = %f\n", CYCLE_VAL, stats_writes_completed[channel][vault], request->latency, stats_average_write_latency[channel][vault]);	
-
-
-			for(int i=0; i<NUM_RANKS[channel] ;i++)
-			{
-				if(i!=rank)
-					stats_time_spent_terminating_writes_to_other_ranks[channel][vault][i] += T_DATA_TRANS[channel];
-			}
-
-			command_issued_current_cycle[channel][vault] = 1;
-			cas_issued_current_cycle[channel][vault][rank][bank] = 2;
-			break;
-
-		case PRE_CMD :
-
-			assert(dram_state[channel][vault][rank][bank].state == ROW_ACTIVE || dram_state[channel][vault][rank][bank].state == PRECHARGING || dram_state[channel][vault][rank][bank].state == IDLE || dram_state[channel][vault][rank][bank].state ==  REFRESHING) ;
-
-			//UT_MEM_DEBUG("\nCycle: %lld Cmd:PRE Req:%lld Chan:%d Rank:%d Bank:%d \n", CYCLE_VAL, request->id, channel, vault, rank, bank);
-
-			dram_state[channel][vault][rank][bank].state = PRECHARGING ;
-
-			dram_state[channel][vault][rank][bank].active_row = -1;
-
-			dram_state[channel][vault][rank][bank].next_act = max(cycle+T_RP[channel], dram_state[channel][vault][rank][bank].next_act);
-
-			dram_state[channel][vault][rank][bank].next_powerdown = max(cycle+T_RP[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-			dram_state[channel][vault][rank][bank].next_pre = max(cycle+T_RP[channel], dram_state[channel][vault][rank][bank].next_pre);
-
-			dram_state[channel][vault][rank][bank].next_refresh = max(cycle+T_RP[channel], dram_state[channel][vault][rank][bank].next_refresh);
-
-			stats_num_precharge[channel][vault][rank][bank] ++;
-
-			command_issued_current_cycle[channel][vault] = 1;
-
-			break;
-
-		case PWR_UP_CMD :
-
-			assert(dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW || dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST || dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN) ;
-
-			//UT_MEM_DEBUG("\nCycle: %lld Cmd: PWR_UP_CMD Chan:%d Rank:%d \n", CYCLE_VAL, channel, vault, rank);
-
-			for(int i=0; i<NUM_BANKS[channel] ; i++)
-			{
-
-				if(dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW || dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_FAST)
-				{
-					dram_state[channel][vault][rank][i].state = IDLE;
-					dram_state[channel][vault][rank][i].active_row = -1;
-				}
-				else
-				{
-					dram_state[channel][vault][rank][i].state = ROW_ACTIVE;
-				}
-
-				if(dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW)
-				{
-					dram_state[channel][vault][rank][i].next_powerdown = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_powerdown);
-
-					dram_state[channel][vault][rank][i].next_pre= max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_pre);
-
-					dram_state[channel][vault][rank][i].next_read = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_read);
-
-					dram_state[channel][vault][rank][i].next_write = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_write);
-
-					dram_state[channel][vault][rank][i].next_act = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_act);
-
-					dram_state[channel][vault][rank][i].next_refresh = max(cycle + T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_refresh);
-				}
-				else
-				{
-
-					dram_state[channel][vault][rank][i].next_powerdown = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_powerdown);
-
-					dram_state[channel][vault][rank][i].next_pre= max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_pre);
-
-					dram_state[channel][vault][rank][i].next_read = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_read);
-
-					dram_state[channel][vault][rank][i].next_write = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_write);
-
-					dram_state[channel][vault][rank][i].next_act = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_act);
-					
-					dram_state[channel][vault][rank][i].next_refresh = max(cycle + T_XP[channel], dram_state[channel][vault][rank][i].next_refresh);
-				}
-			}
-
-			stats_num_powerup[channel][vault][rank]++;
-			command_issued_current_cycle[channel][vault] =1;
-
-			break ;
-		case NOP :
-
-			//UT_MEM_DEBUG("\nCycle: %lld Cmd: NOP Chan:%d\n", CYCLE_VAL, channel);
-			break;
-
-		default :
-			break;
-	}
-	return 1;
-}
-
-int are_all_writes_completed()
-{
-	for(int channel=0; channel<NUM_CHANNELS; channel++)
-	{
-		if(channel<NUM_HMCS) {
-			for(int core=0; core<NUMCORES; core++) {
-				if(write_queue_length_for_core[core][channel])
-					return 0;
-			}
-		}
-		for(int vault=0; vault<NUM_VAULTS[channel]; vault++)
-		{
-				if(write_queue_length[channel][vault])
-					return 0;
-		}
-	}
-	
-	return 1;
-}
-
-// Function called to see if the rank can be transitioned into a fast low
-// power state - ACT_PDN or PRE_PDN_FAST. 
-int is_powerdown_fast_allowed(int channel, int vault, int rank)
-{
-	int flag =0;
-
-	// if already a command has been issued this cycle, or if
-	// forced refreshes are underway, or if issuing this command
-	// will cause us to miss the refresh deadline, do not allow it
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank] || (CYCLE_VAL +T_PD_MIN[channel] + T_XP[channel] > refresh_issue_deadline[channel][vault][rank])) 
-	  return 0;
-
-	// command can be allowed if the next_powerdown is met for all banks in the rank
-	for(int i =0; i < NUM_BANKS[channel] ; i++)
-	{
-	  if((dram_state[channel][vault][rank][i].state == PRECHARGING || dram_state[channel][vault][rank][i].state == ROW_ACTIVE || dram_state[channel][vault][rank][i].state == IDLE || dram_state[channel][vault][rank][i].state == REFRESHING) && CYCLE_VAL >= dram_state[channel][vault][rank][i].next_powerdown)
-	    flag = 1;
-	  else
-	    return 0;
-	}
-
-	return flag;
-}
-
-// Function to see if the rank can be transitioned into a slow low
-// power state - i.e. PRE_PDN_SLOW
-int is_powerdown_slow_allowed(int channel, int vault, int rank)
-{
-	int flag =0;
-
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank] || (CYCLE_VAL +T_PD_MIN[channel]+T_XP_DLL[channel] > refresh_issue_deadline[channel][vault][rank])) 
-	  return 0;
-
-	// Sleep command can be allowed if the next_powerdown is met for all banks in the rank
-	// and if all the banks are precharged
-	for(int i =0; i < NUM_BANKS[channel] ; i++)
-	{
-	  if(dram_state[channel][vault][rank][i].state == ROW_ACTIVE)
-	    return 0;
-	  else
-	  {
-	    if((dram_state[channel][vault][rank][i].state == PRECHARGING || dram_state[channel][vault][rank][i].state == IDLE || dram_state[channel][vault][rank][i].state == REFRESHING) && CYCLE_VAL >= dram_state[channel][vault][rank][i].next_powerdown)
-	      flag = 1;
-	    else
-	      return 0;
-	  }
-	}
-	return flag;
-}
-
-// Function to see if the rank can be powered up
-int is_powerup_allowed(int channel, int vault, int rank)
-{
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank])
-	  return 0;
-
-	if(((dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW) ||(dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST) || (dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)) && (CYCLE_VAL >= dram_state[channel][vault][rank][0].next_powerup))
-	{
-	  // check if issuing it will cause us to miss the refresh
-	  // deadline. If it does, don't allow it. The forced
-	  // refreshes will issue an implicit power up anyway
-		if((dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW) && ((CYCLE_VAL + T_XP_DLL[channel]) > refresh_issue_deadline[channel][vault][0]))
-			return 0;
-		if(((dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST) || (dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)) && (( CYCLE_VAL +T_XP[channel]) > refresh_issue_deadline[channel][vault][0]))
-			return 0;
-		return 1;
-	}
-	else
-		return 0;
-}
-
-// Function to see if the bank can be activated or not
-int is_activate_allowed(int channel, int vault, int rank, int bank)
-{
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank] || (CYCLE_VAL + T_RAS[channel] > refresh_issue_deadline[channel][vault][rank])) 
-	  return 0;
-	if ((dram_state[channel][vault][rank][bank].state == IDLE || dram_state[channel][vault][rank][bank].state == PRECHARGING || dram_state[channel][vault][rank][bank].state == REFRESHING) && (CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_act) && (is_T_FAW_met(channel,vault,rank,CYCLE_VAL)))
-	  return 1;
-	else 
-	  return 0;
-}
-
-// Function to see if the rank can be precharged or not
-int is_autoprecharge_allowed(int channel, int vault, int rank, int bank)
-{
-  long long int start_precharge = 0;
-  if(cas_issued_current_cycle[channel][vault][rank][bank] == 1)
-    start_precharge = max(CYCLE_VAL + T_RTP[channel], dram_state[channel][vault][rank][bank].next_pre);
-  else
-    start_precharge = max(CYCLE_VAL + T_CWD[channel] + T_DATA_TRANS[channel] + T_WR[channel], dram_state[channel][vault][rank][bank].next_pre);
-  
-  if(((cas_issued_current_cycle[channel][vault][rank][bank] == 1) && ((start_precharge+T_RP[channel]) <= refresh_issue_deadline[channel][vault][rank])) ||((cas_issued_current_cycle[channel][vault][rank][bank] == 2)&& ((start_precharge+T_RP[channel]) <= refresh_issue_deadline[channel][vault][rank])))
-    return 1;
-  else
-    return 0;
-}
-
-
-// Function to see if the rank can be precharged or not
-int is_precharge_allowed(int channel, int vault, int rank, int bank)
-{
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank] || (CYCLE_VAL + T_RP[channel] > refresh_issue_deadline[channel][vault][rank])) 
-	    return 0;
-
-	if((dram_state[channel][vault][rank][bank].state == ROW_ACTIVE || dram_state[channel][vault][rank][bank].state == IDLE || dram_state[channel][vault][rank][bank].state == PRECHARGING || dram_state[channel][vault][rank][bank].state ==  REFRESHING) && ( CYCLE_VAL >= dram_state[channel][vault][rank][bank].next_pre))
-	  return 1;
-	else
-	  return 0;
-}
-
-
-// function to see if all banks can be precharged this cycle
-int is_all_bank_precharge_allowed(int channel, int vault, int rank)
-{
-  	int flag = 0;
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank] || (CYCLE_VAL + T_RP[channel] > refresh_issue_deadline[channel][vault][rank])) 
-	  return 0;
-
-	for(int i =0; i<NUM_BANKS[channel] ;i++)
-	{
-	  if((dram_state[channel][vault][rank][i].state == ROW_ACTIVE || dram_state[channel][vault][rank][i].state == IDLE || dram_state[channel][vault][rank][i].state == PRECHARGING || dram_state[channel][vault][rank][i].state ==  REFRESHING) && ( CYCLE_VAL >= dram_state[channel][vault][rank][i].next_pre))
-	    flag = 1;
-	  else
-	    return 0;
-	}
-	return flag;
-}
-
-// function to see if refresh can be allowed this cycle
-
-int is_refresh_allowed(int channel, int vault, int rank)
-{
-	if (command_issued_current_cycle[channel][vault] || forced_refresh_mode_on[channel][vault][rank]) 
-	  return 0;
-
-	for(int b=0; b< NUM_BANKS[channel]; b++)
-	{
-		if(CYCLE_VAL < dram_state[channel][vault][rank][b].next_refresh)
-			return 0;
-	}
-	return 1;
-}
-
-// Function to put a rank into the low power mode
-int issue_powerdown_command(int channel, int vault, int rank, command_t cmd)
-{
-	if(command_issued_current_cycle[channel][vault]) {
-		printf("PANIC : SCHED_ERROR: Got beat. POWER_DOWN command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-
-	// if right CMD has been used
-	if ((cmd != PWR_DN_FAST_CMD) && (cmd != PWR_DN_SLOW_CMD)) {
-		printf("PANIC: SCHED_ERROR : Only PWR_DN_SLOW_CMD or PWR_DN_FAST_CMD can be used to put DRAM rank to sleep\n");
-		return 0;
-	}
-	// if the powerdown command can indeed be issued
-	if(((cmd == PWR_DN_FAST_CMD) && !is_powerdown_fast_allowed(channel, vault, rank)) || ((cmd == PWR_DN_SLOW_CMD) && !is_powerdown_slow_allowed(channel, vault, rank))) {
-		printf("PANIC : SCHED_ERROR: POWER_DOWN command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-
-	for(int i=0; i<NUM_BANKS[channel] ; i++)
-	{
-	        // next_powerup and refresh times
-		dram_state[channel][vault][rank][i].next_powerup = max(CYCLE_VAL+T_PD_MIN[channel], dram_state[channel][vault][rank][i].next_powerdown);
-		dram_state[channel][vault][rank][i].next_refresh = max(CYCLE_VAL+T_PD_MIN[channel], dram_state[channel][vault][rank][i].next_refresh);
-		
-		// state change
-		if(dram_state[channel][vault][rank][i].state == IDLE || dram_state[channel][vault][rank][i].state == PRECHARGING || dram_state[channel][vault][rank][i].state == REFRESHING)
-		{
-			if(cmd == PWR_DN_SLOW_CMD)
-			{
-				dram_state[channel][vault][rank][i].state= PRECHARGE_POWER_DOWN_SLOW;
-				stats_num_powerdown_slow[channel][vault][rank]++;
-			}
-			else if(cmd == PWR_DN_FAST_CMD)
-			{
-				dram_state[channel][vault][rank][i].state = PRECHARGE_POWER_DOWN_FAST;
-				stats_num_powerdown_fast[channel][vault][rank]++;
-			}
-
-			dram_state[channel][vault][rank][i].active_row = -1;
-		}
-		else if(dram_state[channel][vault][rank][i].state == ROW_ACTIVE)
-		{
-			dram_state[channel][vault][rank][i].state = ACTIVE_POWER_DOWN;
-		}
-	}
-	command_issued_current_cycle[channel][vault] = 1;
-	return 1;
-}
-
-
-// Function to power a rank up
-int issue_powerup_command(int channel, int vault, int rank)
-{
-	if(!is_powerup_allowed(channel, vault, rank)) 
-	{
-		printf("PANIC : SCHED_ERROR: POWER_UP command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-	else
-	{
-		long long int cycle =  CYCLE_VAL;
-		for(int i=0; i<NUM_BANKS[channel] ; i++)
-		{
-
-			if(dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW || dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_FAST)
-			{
-				dram_state[channel][vault][rank][i].state = IDLE;
-				dram_state[channel][vault][rank][i].active_row = -1;
-			}
-			else
-			{
-				dram_state[channel][vault][rank][i].state = ROW_ACTIVE;
-			}
-
-			if(dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW)
-			{
-				dram_state[channel][vault][rank][i].next_powerdown = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_powerdown);
-
-				dram_state[channel][vault][rank][i].next_pre= max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_pre);
-
-				dram_state[channel][vault][rank][i].next_read = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_read);
-
-				dram_state[channel][vault][rank][i].next_write = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_write);
-
-				dram_state[channel][vault][rank][i].next_act = max(cycle+T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_act);
-
-				dram_state[channel][vault][rank][i].next_refresh = max(cycle + T_XP_DLL[channel], dram_state[channel][vault][rank][i].next_refresh);
-			}
-			else
-			{
-
-				dram_state[channel][vault][rank][i].next_powerdown = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_powerdown);
-
-				dram_state[channel][vault][rank][i].next_pre= max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_pre);
-
-				dram_state[channel][vault][rank][i].next_read = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_read);
-
-				dram_state[channel][vault][rank][i].next_write = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_write);
-
-				dram_state[channel][vault][rank][i].next_act = max(cycle+T_XP[channel], dram_state[channel][vault][rank][i].next_act);
-
-				dram_state[channel][vault][rank][i].next_refresh = max(cycle + T_XP[channel], dram_state[channel][vault][rank][i].next_refresh);
-			}
-		}
-
-		command_issued_current_cycle[channel][vault] = 1;
-		return 1;
-
-	}
-}
-
-// Function to issue a precharge command to a specific bank
-int issue_autoprecharge(int channel, int vault, int rank, int bank)
-{
-  if(!is_autoprecharge_allowed(channel,vault,rank,bank))
-    return 0;
-  else
-  {
-    long long int start_precharge = 0;
-
-    dram_state[channel][vault][rank][bank].active_row = -1;
-
-    dram_state[channel][vault][rank][bank].state = PRECHARGING;
-
-    if(cas_issued_current_cycle[channel][vault][rank][bank] == 1)
-      start_precharge = max(CYCLE_VAL + T_RTP[channel], dram_state[channel][vault][rank][bank].next_pre);
-    else
-      start_precharge = max(CYCLE_VAL + T_CWD[channel] + T_DATA_TRANS[channel] + T_WR[channel], dram_state[channel][vault][rank][bank].next_pre);
-
-    dram_state[channel][vault][rank][bank].next_act = max(start_precharge + T_RP[channel], dram_state[channel][vault][rank][bank].next_act);
-
-    dram_state[channel][vault][rank][bank].next_powerdown = max(start_precharge + T_RP[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-    dram_state[channel][vault][rank][bank].next_pre = max(start_precharge + T_RP[channel], dram_state[channel][vault][rank][bank].next_pre);
-
-    dram_state[channel][vault][rank][bank].next_refresh = max(start_precharge + T_RP[channel], dram_state[channel][vault][rank][bank].next_refresh);
-
-    stats_num_precharge[channel][vault][rank][bank] ++;
-
-    // reset the cas_issued_current_cycle 
-    for(int r = 0; r < NUM_RANKS[channel] ; r++)
-      for(int b = 0; b < NUM_BANKS[channel] ; b++)
-	cas_issued_current_cycle[channel][vault][r][b]=0;
-	  
-
-    return 1;
-  }
-}
-
-// Function to issue an activate command to a specific row
-int issue_activate_command(int channel, int vault, int rank, int bank, long long int row)
-{
-  if(!is_activate_allowed(channel, vault, rank, bank))
-  {
-		printf("PANIC : SCHED_ERROR: ACTIVATE command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-  }
-  else
-  {
-    long long int cycle = CYCLE_VAL;
-
-    dram_state[channel][vault][rank][bank].state = ROW_ACTIVE;
-
-    dram_state[channel][vault][rank][bank].active_row = row;
-
-    dram_state[channel][vault][rank][bank].next_pre = max((cycle + T_RAS[channel]) , dram_state[channel][vault][rank][bank].next_pre);
-
-    dram_state[channel][vault][rank][bank].next_refresh = max((cycle + T_RAS[channel]) , dram_state[channel][vault][rank][bank].next_refresh);
-
-    dram_state[channel][vault][rank][bank].next_read = max(cycle + T_RCD[channel], dram_state[channel][vault][rank][bank].next_read); 
-
-    dram_state[channel][vault][rank][bank].next_write = max(cycle + T_RCD[channel],  dram_state[channel][vault][rank][bank].next_write);
-
-    dram_state[channel][vault][rank][bank].next_act = max(cycle + T_RC[channel],  dram_state[channel][vault][rank][bank].next_act);
-
-    dram_state[channel][vault][rank][bank].next_powerdown = max(cycle + T_RCD[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-    for(int i=0;i<NUM_BANKS[channel];i++)
-      if(i!=bank)
-	dram_state[channel][vault][rank][i].next_act = max(cycle+T_RRD[channel], dram_state[channel][vault][rank][i].next_act);
-
-    record_activate(channel, vault, rank, cycle);
-
-    stats_num_activate[channel][vault][rank]++;
-    stats_num_activate_spec[channel][vault][rank][bank]++;
-
-    average_gap_between_activates[channel][vault][rank] = ((average_gap_between_activates[channel][vault][rank]*(stats_num_activate[channel][vault][rank]-1)) + (CYCLE_VAL-last_activate[channel][vault][rank]))/stats_num_activate[channel][vault][rank];
-
-    last_activate[channel][vault][rank] = CYCLE_VAL;
-
-    command_issued_current_cycle[channel][vault] = 1;
-
-    return 1;
-
-  }
-}
-
-// Function to issue a precharge command to a specific bank
-int issue_precharge_command(int channel, int vault, int rank, int bank)
-{
-	if(!is_precharge_allowed(channel, vault, rank, bank))
-	{
-		printf("PANIC : SCHED_ERROR: PRECHARGE command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-	else
-	{
-		dram_state[channel][vault][rank][bank].state = PRECHARGING;
-
-		dram_state[channel][vault][rank][bank].active_row = -1;
-
-		dram_state[channel][vault][rank][bank].next_act = max(CYCLE_VAL+T_RP[channel], dram_state[channel][vault][rank][bank].next_act);
-		
-		dram_state[channel][vault][rank][bank].next_powerdown = max(CYCLE_VAL+T_RP[channel], dram_state[channel][vault][rank][bank].next_powerdown);
-
-		dram_state[channel][vault][rank][bank].next_pre = max(CYCLE_VAL+T_RP[channel], dram_state[channel][vault][rank][bank].next_pre);
-		
-		dram_state[channel][vault][rank][bank].next_refresh = max(CYCLE_VAL+T_RP[channel], dram_state[channel][vault][rank][bank].next_refresh);
-
-		stats_num_precharge[channel][vault][rank][bank]++;
-		
-		command_issued_current_cycle[channel][vault] = 1;
-		
-		return 1;
-	}
-}
-
-// Function to precharge a rank
-int issue_all_bank_precharge_command(int channel, int vault, int rank)
-{
-	if(!is_all_bank_precharge_allowed(channel, vault, rank))
-	{
-		printf("PANIC : SCHED_ERROR: ALL_BANK_PRECHARGE command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-	else
-	{
-		for(int i =0;i<NUM_BANKS[channel]; i++)
-		{
-			issue_precharge_command(channel, vault, rank, i);
-			command_issued_current_cycle[channel][vault] = 0; /* Since issue_precharge_command would have set this, we need to reset it. */
-		}
-		command_issued_current_cycle[channel][vault] = 1;
-		return 1;
-	}
-}
-
-// Function to issue a refresh
-int issue_refresh_command(int channel,int vault, int rank)
-{
-
-	if(!is_refresh_allowed(channel, vault, rank))
-	{
-		printf("PANIC : SCHED_ERROR: REFRESH command not issuable in cycle:%lld\n", CYCLE_VAL);
-		return 0;
-	}
-	else
-	{
-		num_issued_refreshes[channel][vault][rank]++;
-		long long int cycle = CYCLE_VAL;
-
-		if(dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW)
-		{
-		  for(int b=0; b<NUM_BANKS[channel] ; b++)
-		  {
-		    dram_state[channel][vault][rank][b].next_act = max(cycle + T_XP_DLL[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_act);
-		    dram_state[channel][vault][rank][b].next_pre = max(cycle + T_XP_DLL[channel]  + T_RFC[channel], dram_state[channel][vault][rank][b].next_pre);
-		    dram_state[channel][vault][rank][b].next_refresh = max(cycle + T_XP_DLL[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_refresh);
-		    dram_state[channel][vault][rank][b].next_powerdown = max(cycle + T_XP_DLL[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_powerdown);
-		  }
-		}
-		else if(dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST)
-		{
-		  for(int b=0; b<NUM_BANKS[channel] ; b++)
-		  {
-					dram_state[channel][vault][rank][b].next_act = max(cycle + T_XP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_act);
-					dram_state[channel][vault][rank][b].next_pre = max(cycle + T_XP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_pre);
-					dram_state[channel][vault][rank][b].next_refresh = max(cycle + T_XP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_refresh);
-					dram_state[channel][vault][rank][b].next_powerdown = max(cycle + T_XP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_powerdown);
-		  }
-		}
-		else if(dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)
-		{
-		  for(int b=0; b<NUM_BANKS[channel] ; b++)
-		  {
-		    dram_state[channel][vault][rank][b].next_act = max(cycle + T_XP[channel] + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_act);
-		    dram_state[channel][vault][rank][b].next_pre = max(cycle + T_XP[channel] + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_pre);
-		    dram_state[channel][vault][rank][b].next_refresh = max(cycle + T_XP[channel] + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_refresh);
-		    dram_state[channel][vault][rank][b].next_powerdown = max(cycle + T_XP[channel] + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_powerdown);
-		  }
-		}
-		else // rank powered up
-		{
-		  int flag = 0;
-		  for(int b=0; b<NUM_BANKS[channel] ; b++)
-		  {
-		    if(dram_state[channel][vault][rank][b].state == ROW_ACTIVE)
-		    {
-		      flag =1;
-		      break;
-		    }
-		  }
-		  if(flag) // at least a single bank is open
-		  {
-		    for(int b=0; b<NUM_BANKS[channel] ; b++)
-		    {
-		      dram_state[channel][vault][rank][b].next_act = max(cycle + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_act);
-		      dram_state[channel][vault][rank][b].next_pre = max(cycle + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_pre);
-		      dram_state[channel][vault][rank][b].next_refresh = max(cycle + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_refresh);
-		      dram_state[channel][vault][rank][b].next_powerdown = max(cycle + T_RP[channel] + T_RFC[channel], dram_state[channel][vault][rank][b].next_powerdown);
-		    }
-		  }
-		  else // everything precharged
-		  {
-		    for(int b=0; b<NUM_BANKS[channel] ; b++)
-		    {
-		    dram_state[channel][vault][rank][b].next_act = max(cycle + T_RFC[channel], dram_state[channel][vault][rank][b].next_act);
-		    dram_state[channel][vault][rank][b].next_pre = max(cycle + T_RFC[channel], dram_state[channel][vault][rank][b].next_pre);
-		    dram_state[channel][vault][rank][b].next_refresh = max(cycle + T_RFC[channel], dram_state[channel][vault][rank][b].next_refresh);
-		    dram_state[channel][vault][rank][b].next_powerdown = max(cycle + T_RFC[channel], dram_state[channel][vault][rank][b].next_powerdown);
-		    }
-		  }
-
-		}
-		for(int b=0; b<NUM_BANKS[channel] ; b++)
-		{
-			dram_state[channel][vault][rank][b].active_row = -1;
-			dram_state[channel][vault][rank][b].state = REFRESHING;
-		}
-		command_issued_current_cycle[channel][vault] = 1;
-		return 1;
-	}
-}
-
-void issue_forced_refresh_commands(int channel, int vault, int rank)
-{
-	for(int b=0; b < NUM_BANKS[channel]; b++)
-	{
-
-		dram_state[channel][vault][rank][b].state = REFRESHING;
-		dram_state[channel][vault][rank][b].active_row = -1;
-
-		dram_state[channel][vault][rank][b].next_act = next_refresh_completion_deadline[channel][vault][rank];
-		dram_state[channel][vault][rank][b].next_pre = next_refresh_completion_deadline[channel][vault][rank];
-		dram_state[channel][vault][rank][b].next_refresh = next_refresh_completion_deadline[channel][vault][rank];
-		dram_state[channel][vault][rank][b].next_powerdown = next_refresh_completion_deadline[channel][vault][rank];
-	}
-}
-
-
-void gather_stats(int channel, int vault)
-{
-	for(int i=0; i<NUM_RANKS[channel]; i++)
-	{
-
-		if(dram_state[channel][vault][i][0].state == PRECHARGE_POWER_DOWN_SLOW)
-			stats_time_spent_in_precharge_power_down_slow[channel][vault][i]+=MEMORY_CLK_MULTIPLIER[channel];
-		else if(dram_state[channel][vault][i][0].state == PRECHARGE_POWER_DOWN_FAST)
-			stats_time_spent_in_precharge_power_down_fast[channel][vault][i]+=MEMORY_CLK_MULTIPLIER[channel];
-		else if(dram_state[channel][vault][i][0].state == ACTIVE_POWER_DOWN)
-			stats_time_spent_in_active_power_down[channel][vault][i]+=MEMORY_CLK_MULTIPLIER[channel];
-		else 
-		{
-			for(int b=0; b<NUM_BANKS[channel]; b++)
-			{
-				if(dram_state[channel][vault][i][b].state == ROW_ACTIVE)
-				{
-					stats_time_spent_in_active_standby[channel][vault][i]+=MEMORY_CLK_MULTIPLIER[channel];
-					break;
-				}
-			}
-			stats_time_spent_in_power_up[channel][vault][i]+=MEMORY_CLK_MULTIPLIER[channel];
-		}
-	}
-}
-
-void print_stats()
-{
-	long long int activates_for_reads = 0;
-	long long int activates_for_spec = 0;
-	long long int activates_for_writes = 0;
-	long long int read_cmds = 0;
-	long long int write_cmds = 0;
-	long long int hmc_read_cmds = 0;
-	long long int hmc_write_cmds = 0;
-	long long int total_read_cmds = 0;
-	long long int total_write_cmds = 0;
-
-	for(int c=0 ; c < NUM_CHANNELS ; c++)
-	{
-		hmc_read_cmds = 0;
-		hmc_write_cmds = 0;
-		for(int v=0; v < NUM_VAULTS[c]; v++) {
-			
-			activates_for_writes = 0;
-			activates_for_reads = 0;
-			activates_for_spec = 0;
-			read_cmds = 0;
-			write_cmds = 0;
-			for(int r=0;r<NUM_RANKS[c] ;r++)
-			{
-				for(int b=0; b<NUM_BANKS[c] ; b++)
-				{
-					activates_for_writes += stats_num_activate_write[c][v][r][b];
-					activates_for_reads += stats_num_activate_read[c][v][r][b];
-					activates_for_spec += stats_num_activate_spec[c][v][r][b];
-					read_cmds += stats_num_read[c][v][r][b];
-					write_cmds += stats_num_write[c][v][r][b];
-				}
-			}
-			
-			if(NUM_VAULTS[c] > 1) {
-				printf("-------- Vault %d Stats-----------\n",c);
-				hmc_read_cmds += read_cmds;
-				hmc_write_cmds += write_cmds;
-			}
-			else
-				printf("-------- Channel %d Stats-----------\n",c);
-			printf("Total Reads Serviced :          %-7lld\n", stats_reads_completed[c][v]);
-			printf("Total Writes Serviced :         %-7lld\n", stats_writes_completed[c][v]);
-			printf("Average Read Latency :          %7.5f\n", (double)stats_average_read_latency[c][v]);
-			printf("Average Read Queue Latency :    %7.5f\n", (double)stats_average_read_queue_latency[c][v]);
-			printf("Average Write Latency :         %7.5f\n", (double)stats_average_write_latency[c][v]);
-			printf("Average Write Queue Latency :   %7.5f\n", (double)stats_average_write_queue_latency[c][v]);
-			printf("Read Page Hit Rate :            %7.5f\n",((double)(read_cmds-activates_for_reads-activates_for_spec)/read_cmds));
-			printf("Write Page Hit Rate :           %7.5f\n",((double)(write_cmds-activates_for_writes)/write_cmds));
-			printf("------------------------------------\n");
-			
-			total_read_cmds += read_cmds;
-			total_write_cmds += write_cmds;
-		}
-		printf("------------------------------------\n");
-		printf("Total Reads Served for HMC %d :            %lld\n", c , hmc_read_cmds);
-		printf("Total Writes Served for HMC %d :           %lld\n", c , hmc_write_cmds);
-		printf("------------------------------------\n");	
-	}
-	printf("------------------------------------\n");
-	printf("Total Reads Served :            %lld\n", total_read_cmds );
-	printf("Total Writes Served :           %lld\n", total_write_cmds);
-	printf("------------------------------------\n");
-}
-
-void update_issuable_commands(int channel, int vault)
-{
-	for(int rank = 0; rank < NUM_RANKS[channel]; rank++)
-	{
-		for(int bank = 0; bank < NUM_BANKS[channel] ; bank++)
-			cmd_precharge_issuable[channel][vault][rank][bank] = is_precharge_allowed(channel, vault, rank, bank);
-
-		cmd_all_bank_precharge_issuable[channel][vault][rank] = is_all_bank_precharge_allowed(channel, vault, rank) ;
-		
-		cmd_powerdown_fast_issuable[channel][vault][rank] =  is_powerdown_fast_allowed(channel, vault, rank);
-
-		cmd_powerdown_slow_issuable[channel][vault][rank] =  is_powerdown_slow_allowed(channel, vault, rank);
-
-		cmd_refresh_issuable[channel][vault][rank] = is_refresh_allowed(channel, vault, rank);
-
-		cmd_powerup_issuable[channel][vault][rank] = is_powerup_allowed(channel, vault, rank);
-	}
-}
-
-// function that updates the dram state and schedules auto-refresh if
-// necessary. This is called every DRAM cycle
-void update_memory(int channel)
-{
-	for(int vault=0;vault<NUM_VAULTS[channel];vault++)
-	{
-	        // make every channel ready to receive a new command
-	  	command_issued_current_cycle[channel][vault] = 0;
-		for(int rank =0;rank<NUM_RANKS[channel] ; rank++)
-		{
-			//reset variable
-		    for(int bank=0; bank<NUM_BANKS[channel]; bank++)
-				cas_issued_current_cycle[channel][vault][rank][bank] = 0;
-
-		    // clean out the activate record for
-			// CYCLE_VAL - T_FAW[channel]
-			flush_activate_record(channel, vault, rank, CYCLE_VAL); 
-
-			// if we are at the refresh completion
-			// deadline
-			if(CYCLE_VAL == next_refresh_completion_deadline[channel][vault][rank])
-			{
-			  	// calculate the next
-				// refresh_issue_deadline
-				num_issued_refreshes[channel][vault][rank] = 0;
-				last_refresh_completion_deadline[channel][vault][rank] = CYCLE_VAL;
-				next_refresh_completion_deadline[channel][vault][rank] = CYCLE_VAL + 8 * T_REFI[channel];
-				refresh_issue_deadline[channel][vault][rank] = next_refresh_completion_deadline[channel][vault][rank] - T_RP[channel] - 8 * T_RFC[channel];
-				forced_refresh_mode_on[channel][vault][rank] = 0;
-				issued_forced_refresh_commands[channel][vault][rank] = 0;
-			}
-			else if((CYCLE_VAL == refresh_issue_deadline[channel][vault][rank]) && (num_issued_refreshes[channel][vault][rank] < 8))
-			{
-			    // refresh_issue_deadline has been
-				// reached. Do the auto-refreshes
-				forced_refresh_mode_on[channel][vault][rank] = 1;
-				issue_forced_refresh_commands(channel, vault, rank);
-			}
-			else if(CYCLE_VAL < refresh_issue_deadline[channel][vault][rank])
-			{
-				//update the refresh_issue deadline
-				refresh_issue_deadline[channel][vault][rank] = next_refresh_completion_deadline[channel][vault][rank] - T_RP[channel] - (8-num_issued_refreshes[channel][vault][rank]) * T_RFC[channel];
-			}
-
-		}
-
-		// update the variables corresponding to the non-queue
-		// variables
-		update_issuable_commands(channel, vault);
-		
-		// update the request cmds in the queues
-		update_read_queue_commands(channel, vault);
-
-		update_write_queue_commands(channel, vault);
-		
-		update_read_return_queue(channel, vault);
-		
-		// remove finished requests
-		clean_queues(channel, vault);
-	}
-}
-
-
-
-//------------------------------------------------------------
-// Calculate Power: It calculates and returns average power used by every Rank on Every 
-// Channel during the course of the simulation 
-// Units : Time- ns; Current mA; Voltage V; Power mW; 
-//------------------------------------------------------------
-
- float calculate_power(int channel, int vault, int rank, int print_stats_type, int chips_per_rank)
-{
-	/*
-	Power is calculated using the equations from Technical Note "TN-41-01: Calculating Memory System Power for DDR"
-	The current values IDD* are taken from the data sheets. 
-	These are average current values that the chip will draw when certain actions occur as frequently as possible.
-	i.e., the worst case power consumption
-	Eg: when ACTs happen every tRC
-		pds_<component> is the power calculated by directly using the current values from the data sheet. 'pds' stands for 
-	PowerDataSheet. This will the power drawn by the chip when operating under the activity that is assumed in the data 
-	sheet. This mostly represents the worst case power
-		These pds_<*> components need to be derated in accordance with the activity that is observed. Eg: If ACTs occur slower
-	than every tRC, then pds_act will be derated to give "psch_act" (SCHeduled Power consumed by Activate) 
-	*/
-
-/*------------------------------------------------------------
-// total_power is the sum of of 13 components listed below 
-// Note: CKE is the ClocK Enable to every chip.
-// Note: Even though the reads and write are to a different rank on the same channel, the Pull-Up and the Pull-Down resistors continue 
-// 		to burn some power. psch_termWoth and psch_termWoth stand for the power dissipated in the rank in question when the reads and
-// 		writes are to other ranks on the channel
-
-	psch_act 						-> Power dissipated by activating a row
-  psch_act_pdn 				-> Power dissipated when CKE is low (disabled) and all banks are precharged
-  psch_act_stby 			-> Power dissipated when CKE is high (enabled) and at least one back is active (row is open)
-  psch_pre_pdn_fast  	-> Power dissipated when CKE is low (disabled) and all banks are precharged and chip is in fast power down
-  psch_pre_pdn_slow  	-> Power dissipated when CKE is low (disabled) and all banks are precharged and chip is in fast slow  down
-  psch_pre_stby 			-> Power dissipated when CKE is high (enabled) and at least one back is active (row is open)
-  psch_termWoth 			-> Power dissipated when a Write termiantes at the other set of chips.
-  psch_termRoth 			-> Power dissipated when a Read  termiantes at the other set of chips
-  psch_termW 					-> Power dissipated when a Write termiantes at the set of chips in question
-  psch_dq 						-> Power dissipated when a Read  termiantes at the set of chips in question (Data Pins on the chip are called DQ)
-  psch_ref 						-> Power dissipated during Refresh
-  psch_rd 						-> Power dissipated during a Read  (does ot include power to open a row)
-  psch_wr 						-> Power dissipated during a Write (does ot include power to open a row)
-
-------------------------------------------------------------*/
-
-	float pds_act ;						
-	float pds_act_pdn;
-	float pds_act_stby;
-	float pds_pre_pdn_fast;
-	float pds_pre_pdn_slow;
-	float pds_pre_stby;
-	float pds_wr;
-	float pds_rd;
-	float pds_ref;
-	float pds_dq;
-	float pds_termW;
-	float pds_termRoth;
-	float pds_termWoth;
-
-	float psch_act;
-	float psch_pre_pdn_slow;
-	float psch_pre_pdn_fast;
-	float psch_act_pdn;
-	float psch_act_stby;
-	float psch_pre_stby;
-	float psch_rd;
-	float psch_wr;
-	float psch_ref;
-	float psch_dq;
-	float psch_termW;
-	float psch_termRoth;
-	float psch_termWoth;
-
-	float total_chip_power;
-	float total_rank_power;
-
-	long long int writes =0 , reads=0;
-
-	static int print_total_cycles=0;
-
-
-	/*----------------------------------------------------
-  //Calculating DataSheet Power
-	----------------------------------------------------*/
-
-	pds_act = (IDD0[channel] - (IDD3N[channel] * T_RAS[channel] + IDD2N[channel] *(T_RC[channel] - T_RAS[channel]))/T_RC[channel]) * VDD[channel];
-	
-	pds_pre_pdn_slow = IDD2P0[channel] * VDD[channel];
-
-	pds_pre_pdn_fast = IDD2P1[channel] * VDD[channel];
-
-	pds_act_pdn = IDD3P[channel] * VDD[channel];
-
-	pds_pre_stby = IDD2N[channel] * VDD[channel];
-	pds_act_stby = IDD3N[channel] * VDD[channel];
-
-	pds_wr = (IDD4W[channel] - IDD3N[channel]) * VDD[channel];
-
-	pds_rd = (IDD4R[channel] - IDD3N[channel]) * VDD[channel];
-
-	pds_ref = (IDD5[channel] - IDD3N[channel]) * VDD[channel];
-
-
-	/*----------------------------------------------------
-	//On Die Termination (ODT) Power:
-	//Values obtained from Micron Technical Note
-	//This is dependent on the termination configuration of the simulated configuration
-	//our simulator uses the same config as that used in the Tech Note
-	----------------------------------------------------*/
-	pds_dq = 3.2 * 10;
-
-	pds_termW = 0;
-
-	pds_termRoth = 24.9 * 10;
-
-	pds_termWoth = 20.8 * 11;
-
-	/*----------------------------------------------------
-	//Derating worst case power to represent system activity
-	----------------------------------------------------*/
-
-	//average_gap_between_activates was initialised to 0. So if it is still
-	//0, then no ACTs have happened to this rank.
-	//Hence activate-power is also 0
-	if (average_gap_between_activates[channel][vault][rank] == 0)
-	{
-		psch_act = 0;
-	} else {
-		psch_act = pds_act * T_RC[channel]/(average_gap_between_activates[channel][vault][rank]);
-	}
-	
-	psch_act_pdn = pds_act_pdn * ((double)stats_time_spent_in_active_power_down[channel][vault][rank]/CYCLE_VAL);
-	psch_pre_pdn_slow = pds_pre_pdn_slow * ((double)stats_time_spent_in_precharge_power_down_slow[channel][vault][rank]/CYCLE_VAL);
-	psch_pre_pdn_fast = pds_pre_pdn_fast * ((double)stats_time_spent_in_precharge_power_down_fast[channel][vault][rank]/CYCLE_VAL);
-
-	psch_act_stby = pds_act_stby * ((double)stats_time_spent_in_active_standby[channel][vault][rank]/CYCLE_VAL);
-
-	/*----------------------------------------------------
-  //pds_pre_stby assumes that the system is powered up and every 
-	//row has been precharged during every cycle 
-	// In reality, the chip could have been in a power-down mode
-	//or a row could have been active. The time spent in these modes 
-	//should be deducted from total time
-	----------------------------------------------------*/
-	psch_pre_stby = pds_pre_stby * ((double)(CYCLE_VAL - stats_time_spent_in_active_standby[channel][vault][rank]- stats_time_spent_in_precharge_power_down_slow[channel][vault][rank] - stats_time_spent_in_precharge_power_down_fast[channel][vault][rank] - stats_time_spent_in_active_power_down[channel][vault][rank]))/CYCLE_VAL;
-
-	/*----------------------------------------------------
-  //Calculate Total Reads ans Writes performed in the system
-	----------------------------------------------------*/
-	
-	for(int i=0;i<NUM_BANKS[channel];i++)
-	{
-		writes+= stats_num_write[channel][vault][rank][i];
-		reads+=stats_num_read[channel][vault][rank][i];
-	}
-
-	/*----------------------------------------------------
-  // pds<rd/wr> assumes that there is rd/wr happening every cycle
-	// T_DATA_TRANS is the number of cycles it takes for one rd/wr
-	----------------------------------------------------*/
-	psch_wr = pds_wr * (writes*T_DATA_TRANS[channel])/CYCLE_VAL;
-
-	psch_rd = pds_rd * (reads*T_DATA_TRANS[channel])/CYCLE_VAL;
-
-	/*----------------------------------------------------
-  //pds_ref assumes that there is always a refresh happening.
-	//in reality, refresh consumes only T_RFC out of every t_REFI
-	----------------------------------------------------*/
-	psch_ref = pds_ref * T_RFC[channel]/T_REFI[channel]; 
-
-	psch_dq = pds_dq * (reads*T_DATA_TRANS[channel])/CYCLE_VAL;
-
-	psch_termW = pds_termW * (writes*T_DATA_TRANS[channel])/CYCLE_VAL;
-
-
-	psch_termRoth = pds_termRoth *  ((double)stats_time_spent_terminating_reads_from_other_ranks[channel][vault][rank]/CYCLE_VAL);
-	psch_termWoth = pds_termWoth * ((double)stats_time_spent_terminating_writes_to_other_ranks[channel][vault][rank]/CYCLE_VAL);
-
-
-	total_chip_power = psch_act + psch_termWoth + psch_termRoth + psch_termW + psch_dq + psch_ref + psch_rd + psch_wr + psch_pre_stby + psch_act_stby + psch_pre_pdn_fast + psch_pre_pdn_slow + psch_act_pdn  ;
-	total_rank_power = total_chip_power * chips_per_rank;
-
-	double time_in_pre_stby = (((double)(CYCLE_VAL - stats_time_spent_in_active_standby[channel][vault][rank]- stats_time_spent_in_precharge_power_down_slow[channel][vault][rank] - stats_time_spent_in_precharge_power_down_fast[channel][vault][rank] - stats_time_spent_in_active_power_down[channel][vault][rank]))/CYCLE_VAL);
-
-	if (print_total_cycles ==0) {
-
-
-		printf ("\n#-----------------------------Simulated Cycles Break-Up-------------------------------------------\n");
-		printf ("Note:  1.(Read Cycles + Write Cycles + Read Other + Write Other) should add up to %% cycles during which\n");
-		printf ("          the channel is busy. This should be the same for all Ranks on a Channel\n");
-		printf ("       2.(PRE_PDN_FAST + PRE_PDN_SLOW + ACT_PDN + ACT_STBY + PRE_STBY) should add up to 100%%\n");
-		printf ("       3.Power Down means Clock Enable, CKE = 0. In Standby mode, CKE = 1\n");
-		printf ("#-------------------------------------------------------------------------------------------------\n");
-		printf ("Total Simulation Cycles                      %11lld\n",CYCLE_VAL );
-		printf ("---------------------------------------------------------------\n\n");
-
-		print_total_cycles = 1;
-	}
-
-	if (print_stats_type == 0) {
-		/*
-		printf ("%3d %6d %13.2f %13.2f %13.2f %13.2f %15.2f %15.2f %15.2f %13.2f %11.2f \n",\
-				channel,\
-				rank,\
-				(double)reads/CYCLE_VAL,\
-				(double)writes/CYCLE_VAL,\
-				psch_termRoth,\
-				psch_termWoth,\
-				((double)stats_time_spent_in_precharge_power_down_fast[channel][rank]/CYCLE_VAL),\
-				((double)stats_time_spent_in_precharge_power_down_slow[channel][rank]/CYCLE_VAL),\
-				((double)stats_time_spent_in_active_power_down[channel][rank]/CYCLE_VAL),\
-				((double)stats_time_spent_in_active_standby[channel][rank]/CYCLE_VAL),\
-				(((double)(CYCLE_VAL - stats_time_spent_in_active_standby[channel][rank]- stats_time_spent_in_precharge_power_down_slow[channel][rank] - stats_time_spent_in_precharge_power_down_fast[channel][rank] - stats_time_spent_in_active_power_down[channel][rank]))/CYCLE_VAL)
-				);
-	*/
-		printf ("Channel %d Rank %d Read Cycles(%%)           %9.2f # %% cycles the Rank performed a Read\n",channel, rank, (double)reads*T_DATA_TRANS[channel]/CYCLE_VAL ); 
-		printf ("Channel %d Rank %d Write Cycles(%%)          %9.2f # %% cycles the Rank performed a Write\n",channel, rank, (double)writes*T_DATA_TRANS[channel]/CYCLE_VAL ); 
-		printf ("Channel %d Rank %d Read Other(%%)            %9.2f # %% cycles other Ranks on the channel performed a Read\n",channel, rank, \
-					   ((double)stats_time_spent_terminating_reads_from_other_ranks[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d Write Other(%%)           %9.2f # %% cycles other Ranks on the channel performed a Write\n",channel, rank,\
-					  ((double)stats_time_spent_terminating_writes_to_other_ranks[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d PRE_PDN_FAST(%%)          %9.2f # %% cycles the Rank was in Fast Power Down and all Banks were Precharged\n",channel, rank, \
-						((double)stats_time_spent_in_precharge_power_down_fast[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d PRE_PDN_SLOW(%%)          %9.2f # %% cycles the Rank was in Slow Power Down and all Banks were Precharged\n",channel, rank, \
-						((double)stats_time_spent_in_precharge_power_down_slow[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d ACT_PDN(%%)               %9.2f # %% cycles the Rank was in Active Power Down and atleast one Bank was Active\n",channel, rank, \
-						((double)stats_time_spent_in_active_power_down[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d ACT_STBY(%%)              %9.2f # %% cycles the Rank was in Standby and atleast one bank was Active\n",channel, rank,\
-						 ((double)stats_time_spent_in_active_standby[channel][vault][rank]/CYCLE_VAL) ); 
-		printf ("Channel %d Rank %d PRE_STBY(%%)              %9.2f # %% cycles the Rank was in Standby and all Banks were Precharged\n",channel, rank, time_in_pre_stby ); 
-		printf ("---------------------------------------------------------------\n\n");
-
-
-	} else if (print_stats_type == 1) {
-		/*----------------------------------------------------
-		// Total Power is the sum total of all the components calculated above
-		----------------------------------------------------*/
-
-
-		printf ("Channel %d Rank %d Background(mw)          %9.2f # depends only on Power Down time and time all banks were precharged\n",channel, rank, psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby); 
-		printf ("Channel %d Rank %d Act(mW)                 %9.2f # power spend bringing data to the row buffer\n",channel, rank, psch_act); 
-		printf ("Channel %d Rank %d Read(mW)                %9.2f # power spent doing a Read  after the Row Buffer is open\n",channel, rank, psch_rd); 
-		printf ("Channel %d Rank %d Write(mW)               %9.2f # power spent doing a Write after the Row Buffer is open\n",channel, rank, psch_wr); 
-		printf ("Channel %d Rank %d Read Terminate(mW)      %9.2f # power dissipated in ODT resistors during Read\n",channel, rank, psch_dq); 
-		printf ("Channel %d Rank %d Write Terminate(mW)     %9.2f # power dissipated in ODT resistors during Write\n",channel, rank, psch_termW); 
-		printf ("Channel %d Rank %d termRoth(mW)            %9.2f # power dissipated in ODT resistors during Reads  in other ranks\n",channel, rank, psch_termRoth); 
-		printf ("Channel %d Rank %d termWoth(mW)            %9.2f # power dissipated in ODT resistors during Writes in other ranks\n",channel, rank, psch_termWoth); 
-		printf ("Channel %d Rank %d Refresh(mW)             %9.2f # depends on frequency of Refresh (tREFI)\n",channel, rank, psch_ref); 
-		printf ("---------------------------------------------------------------\n");
-		printf ("Channel %d Rank %d Total Rank Power(mW)    %9.2f # (Sum of above components)*(num chips in each Rank)\n",channel, rank, total_rank_power);
-		printf ("---------------------------------------------------------------\n\n");
-
-
-
-/*
-
- printf("%3d %11d %16.2f %16.2f %17.2f %13.2f %13.2f %20.2f %21.2f %24.2f %12.2f %13.2f\n",\
-				channel,\
-				rank,\
-				total_rank_power, \
-				psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby, \
-				psch_act, \
-				psch_rd, \
-				psch_wr, \
-				psch_dq, \
-				psch_termW, \
-				psch_termRoth, \
-				psch_termWoth, \
-				psch_ref                                                                                  
-
-				);
-*/
-
-/*
-		printf("Channel:%d Rank:%d Total background power : %f mW\n", channel, rank, psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby);
-		printf("Channel:%d, Rank:%d Total activate power : %f,%f,%d,%f mW\n", channel, rank, psch_act,pds_act,T_RC,average_gap_between_activates[channel][rank]);
-		printf("Channel:%d, Rank:%d Total I/O and termination power: %f rd:%f wr:%f dq:%f termW:%f termRoth:%f termWoth:%f mW\n", channel, rank, psch_rd+psch_wr+psch_dq+psch_termW+psch_termRoth+psch_termWoth, psch_rd, psch_wr, psch_dq, psch_termW, psch_termRoth, psch_termWoth);
-
-		printf("Channel:%d, Rank:%d Total refresh power: %f mW\n", channel, rank, psch_ref);
-		printf("Channel:%d, Rank:%d Total Rank power: %f mW\n\n", channel, rank, total_rank_power);
-		printf("------------------------------------------------\n");
-		*/
-
-	} else {
-		printf ("PANIC: FN_CALL_ERROR: In calculate_power(), print_stats_type can only be 1 or 0\n");
-		assert (-1);
-	}
-
-	return total_rank_power;
-
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+
+#include "utlist.h"
+
+#include "utils.h"
+
+#include "usimm.h"
+
+#define max(a,b) (((a)>(b))?(a):(b))
+
+int is_writeq_full(usimm_sim_t * sim, int thread_id)
+{
+	for(int channel=0; channel<sim->NUM_CHANNELS; channel++){
+		if(channel < sim->NUM_HMCS) {
+			if(sim->write_queue_length_for_core[thread_id][channel] == sim->WQ_CAPACITY[channel])
+				return 1;
+		}
+		else {
+			for(int vault=0; vault<sim->NUM_VAULTS[channel]; vault++) {				
+				if(sim->write_queue_length[channel][vault] == sim->WQ_CAPACITY[channel])
+					return 1;
+			}
+		}
+    }
+    return 0;
+}
+
+// record an activate in the activation record
+void record_activate(usimm_sim_t * sim, int channel, int vault, int rank, long long int cycle)
+{
+	int newest = (sim->activation_head[channel][vault][rank] + ACTIVATION_WINDOW_SIZE - 1) % ACTIVATION_WINDOW_SIZE;
+	assert(sim->activation_record[channel][vault][rank][newest] < cycle); //can't have two commands issued the same cycle - hence no two activations in the same cycle
+
+	// the new activate replaces the oldest one
+	sim->activation_record[channel][vault][rank][sim->activation_head[channel][vault][rank]] = cycle;
+	sim->activation_head[channel][vault][rank] = (sim->activation_head[channel][vault][rank] + 1) % ACTIVATION_WINDOW_SIZE;
+	
+	return;
+}
+
+// First cycle at which another activate fits in the T_FAW window, i.e.
+// once the oldest of the last four activates is more than T_FAW old
+long long int T_FAW_met_cycle(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	return sim->activation_record[channel][vault][rank][sim->activation_head[channel][vault][rank]] + sim->T_FAW[channel] + 1;
+}
+
+// Have there been 3 or less activates in the last T_FAW period 
+int is_T_FAW_met(usimm_sim_t * sim, int channel, int vault, int rank, long long int cycle)
+{
+	if(cycle >= T_FAW_met_cycle(sim, channel, vault, rank))
+		return 1;
+	else
+		return 0;
+}
+
+// On die termination power (mW) from the Micron technical note, for the
+// termination configuration the simulator uses
+#define ODT_DQ_POWER (3.2 * 10)
+#define ODT_TERM_W_POWER 0
+#define ODT_TERM_R_OTHER_POWER (24.9 * 10)
+#define ODT_TERM_W_OTHER_POWER (20.8 * 11)
+
+// Energy is charged as it is spent, in mW times cycles per device, from
+// the same data sheet currents as calculate_power: a command's energy
+// when it issues, and the background energy of a rank's power state
+// when the state changes (see credit_rank_state).
+
+// Background power (mW) of the state the rank is in now
+static double background_power(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	switch(sim->dram_state[channel][vault][rank][0].state)
+	{
+		case PRECHARGE_POWER_DOWN_SLOW :
+			return sim->IDD2P0[channel] * sim->VDD[channel];
+		case PRECHARGE_POWER_DOWN_FAST :
+			return sim->IDD2P1[channel] * sim->VDD[channel];
+		case ACTIVE_POWER_DOWN :
+			return sim->IDD3P[channel] * sim->VDD[channel];
+		default :
+			for(int b=0; b<sim->NUM_BANKS[channel]; b++)
+				if(sim->dram_state[channel][vault][rank][b].state == ROW_ACTIVE)
+					return sim->IDD3N[channel] * sim->VDD[channel];
+			return sim->IDD2N[channel] * sim->VDD[channel];
+	}
+}
+
+// The residency counter the state the rank is in now is credited to, or
+// NULL for precharge standby, which is whatever time is left over
+static long long int * residency_counter(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	switch(sim->dram_state[channel][vault][rank][0].state)
+	{
+		case PRECHARGE_POWER_DOWN_SLOW :
+			return &sim->stats_time_spent_in_precharge_power_down_slow[channel][vault][rank];
+		case PRECHARGE_POWER_DOWN_FAST :
+			return &sim->stats_time_spent_in_precharge_power_down_fast[channel][vault][rank];
+		case ACTIVE_POWER_DOWN :
+			return &sim->stats_time_spent_in_active_power_down[channel][vault][rank];
+		default :
+			for(int b=0; b<sim->NUM_BANKS[channel]; b++)
+				if(sim->dram_state[channel][vault][rank][b].state == ROW_ACTIVE)
+					return &sim->stats_time_spent_in_active_standby[channel][vault][rank];
+			return NULL;
+	}
+}
+
+// Residency is accounted on transitions: the time from state_since up to
+// cycle until is credited to the residency counter and the background
+// energy of the state the rank is in now. Called before the state of any
+// bank of the rank changes, and once at the end of the run.
+static void credit_rank_state_until(usimm_sim_t * sim, int channel, int vault, int rank, long long int until)
+{
+	long long int cycles = until - sim->state_since[channel][vault][rank];
+	long long int * counter = residency_counter(sim, channel, vault, rank);
+
+	if(cycles <= 0)
+		return;
+	if(counter)
+		*counter += cycles;
+	if(!counter || counter == &sim->stats_time_spent_in_active_standby[channel][vault][rank])
+		sim->stats_time_spent_in_power_up[channel][vault][rank] += cycles;
+	sim->stats_energy[channel][vault][rank] += background_power(sim, channel, vault, rank) * cycles;
+	sim->state_since[channel][vault][rank] = until;
+}
+
+static void credit_rank_state(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	credit_rank_state_until(sim, channel, vault, rank, sim->CYCLE_VAL);
+}
+
+// A memory cycle's residency used to be counted when the cycle started, so
+// the run is accounted up to the end of each channel's last memory cycle,
+// which may lie past the final CYCLE_VAL
+void finish_rank_residency(usimm_sim_t * sim)
+{
+	for(int channel=0; channel<sim->NUM_CHANNELS; channel++)
+	{
+		long long int period = sim->MEMORY_CLK_MULTIPLIER[channel];
+		long long int until = (sim->CYCLE_VAL + period - 1) / period * period;
+		for(int vault=0; vault<sim->NUM_VAULTS[channel]; vault++)
+			for(int rank=0; rank<sim->NUM_RANKS[channel]; rank++)
+				credit_rank_state_until(sim, channel, vault, rank, until);
+	}
+}
+
+// Charge the energy of an activate, a refresh or a column access; a column
+// access also costs the other ranks of the vault termination energy
+static void charge_command_energy(usimm_sim_t * sim, int channel, int vault, int rank, command_t cmd)
+{
+	double power = 0, others = 0, cycles = sim->T_DATA_TRANS[channel];
+
+	switch(cmd)
+	{
+		case ACT_CMD :
+			power = (sim->IDD0[channel] - (sim->IDD3N[channel] * sim->T_RAS[channel] + sim->IDD2N[channel] * (sim->T_RC[channel] - sim->T_RAS[channel])) / sim->T_RC[channel]) * sim->VDD[channel];
+			cycles = sim->T_RC[channel];
+			break;
+		case COL_READ_CMD :
+			power = (sim->IDD4R[channel] - sim->IDD3N[channel]) * sim->VDD[channel] + ODT_DQ_POWER;
+			others = ODT_TERM_R_OTHER_POWER;
+			break;
+		case COL_WRITE_CMD :
+			power = (sim->IDD4W[channel] - sim->IDD3N[channel]) * sim->VDD[channel] + ODT_TERM_W_POWER;
+			others = ODT_TERM_W_OTHER_POWER;
+			break;
+		case REF_CMD :
+			power = (sim->IDD5[channel] - sim->IDD3N[channel]) * sim->VDD[channel];
+			cycles = sim->T_RFC[channel];
+			break;
+		default :
+			return;
+	}
+	sim->stats_energy[channel][vault][rank] += power * cycles;
+	if(others > 0)
+		for(int i=0; i<sim->NUM_RANKS[channel]; i++)
+			if(i != rank)
+				sim->stats_energy[channel][vault][i] += others * cycles;
+}
+
+// A residency counter of the rank as it would read if the rank were
+// credited now; nothing is credited, so readers mid-run change no state
+static long long int rank_residency(usimm_sim_t * sim, int channel, int vault, int rank, long long int counter[][MAX_NUM_VAULTS][MAX_NUM_RANKS])
+{
+	long long int pending = sim->CYCLE_VAL - sim->state_since[channel][vault][rank];
+
+	if(pending > 0 && residency_counter(sim, channel, vault, rank) == &counter[channel][vault][rank])
+		return counter[channel][vault][rank] + pending;
+	return counter[channel][vault][rank];
+}
+
+double energy_so_far(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	return sim->stats_energy[channel][vault][rank] + background_power(sim, channel, vault, rank) * (sim->CYCLE_VAL - sim->state_since[channel][vault][rank]);
+}
+
+// initialize dram variables and statistics
+void init_memory_controller_vars(usimm_sim_t * sim)
+{
+    sim->num_read_merge =0;
+	sim->num_write_merge =0;
+	init_address_map(sim);
+	init_request_pool(sim);
+	init_queue_index(sim);
+	for(int i=0; i<sim->NUM_CHANNELS; i++)
+	{
+		for(int v=0; v<sim->NUM_VAULTS[i]; v++)
+		{
+			for(int j=0; j<sim->NUM_RANKS[i]; j++)
+			{
+				// no activates yet: all slots lie beyond any T_FAW window
+				for(int w=0;w<ACTIVATION_WINDOW_SIZE;w++)
+					sim->activation_record[i][v][j][w] = -sim->T_FAW[i]-1;
+				sim->activation_head[i][v][j] = 0;
+
+				for (int k=0; k<sim->NUM_BANKS[i]; k++)
+				{
+					sim->dram_state[i][v][j][k].state = IDLE;
+					sim->dram_state[i][v][j][k].active_row = -1;
+					sim->dram_state[i][v][j][k].next_pre = -1;
+					sim->dram_state[i][v][j][k].next_pre = -1;
+					sim->dram_state[i][v][j][k].next_pre = -1;
+					sim->dram_state[i][v][j][k].next_pre = -1;
+
+					sim->cmd_precharge_issuable[i][v][j][k] = 0;
+
+					sim->stats_num_activate_read[i][v][j][k]=0;
+					sim->stats_num_activate_write[i][v][j][k]=0;
+					sim->stats_num_activate_spec[i][v][j][k]=0;
+					sim->stats_num_precharge[i][v][j][k]=0;
+					sim->stats_num_read[i][v][j][k]=0;
+					sim->stats_num_write[i][v][j][k]=0;
+					sim->cas_issued_current_cycle[i][v][j][k]=0;
+				}
+
+				sim->cmd_all_bank_precharge_issuable[i][v][j] =0;
+				sim->cmd_powerdown_fast_issuable[i][v][j]=0;
+				sim->cmd_powerdown_slow_issuable[i][v][j]=0;
+				sim->cmd_powerup_issuable[i][v][j]=0;
+				sim->cmd_refresh_issuable[i][v][j]=0;
+
+				sim->next_refresh_completion_deadline[i][v][j] = 8*sim->T_REFI[i];
+				sim->last_refresh_completion_deadline[i][v][j] = 0;
+				sim->forced_refresh_mode_on[i][v][j]=0;
+				sim->refresh_issue_deadline[i][v][j] = sim->next_refresh_completion_deadline[i][v][j] - sim->T_RP[i] - 8*sim->T_RFC[i];
+				sim->num_issued_refreshes[i][v][j] = 0;
+			
+				sim->stats_time_spent_in_active_standby[i][v][j]=0;
+				sim->stats_time_spent_in_active_power_down[i][v][j]=0;
+				sim->stats_time_spent_in_precharge_power_down_slow[i][v][j]=0;
+				sim->stats_time_spent_in_precharge_power_down_fast[i][v][j]=0;
+				sim->stats_time_spent_in_power_up[i][v][j]=0;
+				sim->last_activate[i][v][j]=0;
+				//If average_gap_between_activates is 0 then we know that there have been no activates to [i][j]
+				sim->average_gap_between_activates[i][v][j]=0;
+
+				sim->stats_num_powerdown_slow[i][v][j]=0;
+				sim->stats_num_powerdown_fast[i][v][j]=0;
+				sim->stats_num_powerup[i][v][j]=0;
+
+				sim->stats_num_activate[i][v][j]=0;
+
+				sim->stats_energy[i][v][j]=0;
+				sim->state_since[i][v][j]=0;
+
+				sim->command_issued_current_cycle[i][v]=0;
+			}
+
+			sim->read_queue_head[i][v]=NULL;
+			sim->write_queue_head[i][v]=NULL;
+
+			memset(&sim->read_buckets[i][v], 0, sizeof(vault_buckets_t));
+			memset(&sim->write_buckets[i][v], 0, sizeof(vault_buckets_t));
+			sim->read_buckets[i][v].wakeup = -1;
+			sim->write_buckets[i][v].wakeup = -1;
+			for(int k=0; k<MAX_NUM_BUCKETS; k++)
+			{
+				sim->read_buckets[i][v].bucket[k].wakeup = -1;
+				sim->write_buckets[i][v].bucket[k].wakeup = -1;
+				sim->read_buckets[i][v].bucket[k].hit_row = -1;
+				sim->write_buckets[i][v].bucket[k].hit_row = -1;
+			}
+
+			sim->read_queue_length[i][v]=0;
+			sim->write_queue_length[i][v]=0;
+
+			sim->read_return_queue_head[i][v]=NULL;
+			sim->read_return_queue_length[i][v] = 0;
+
+			sim->command_issued_current_cycle[i][v]=0;
+
+			// Stats
+			sim->stats_reads_merged_per_vault[i][v]=0;
+			sim->stats_writes_merged_per_vault[i][v]=0;
+
+			sim->stats_reads_seen[i][v]=0;
+			sim->stats_writes_seen[i][v]=0;
+			sim->stats_reads_completed[i][v]=0;
+			sim->stats_writes_completed[i][v]=0;
+			sim->stats_average_read_latency[i][v]=0;
+			sim->stats_average_read_queue_latency[i][v]=0;
+			sim->stats_average_write_latency[i][v]=0;
+			sim->stats_average_write_queue_latency[i][v]=0;
+			sim->stats_page_hits[i][v]=0;
+			sim->stats_read_row_hit_rate[i][v]=0;
+			
+			sim->drain_writes[i][v] = 0;
+		}
+	}
+	memset(sim->vault_read_latency, 0, sizeof(sim->vault_read_latency));
+	memset(sim->vault_write_latency, 0, sizeof(sim->vault_write_latency));
+	memset(sim->channel_latency, 0, sizeof(sim->channel_latency));
+	memset(sim->core_latency, 0, sizeof(sim->core_latency));
+	
+	for(int cores = 0; cores < sim->NUMCORES; cores++)
+	{
+		for(int channel=0; channel < sim->NUM_HMCS; channel++)
+		{
+			sim->read_queue_per_core_head[cores][channel] = NULL;
+			sim->write_queue_per_core_head[cores][channel] =  NULL;
+
+			sim->write_queue_length_for_core[cores][channel] = 0;
+			sim->read_queue_length_for_core[cores][channel] = 0;
+			
+			sim->drain_write_for_core[cores][channel] = 0;
+			
+			sim->next_request_schedule_time[channel] = 0;
+			sim->next_respond_schedule_time[channel] = 0;
+			sim->stats_link_busy[channel][0] = 0;
+			sim->stats_link_busy[channel][1] = 0;
+		}
+	}
+}
+
+/********************************************************/
+/*	Utility Functions				*/
+/********************************************************/
+
+
+unsigned int log_base2(unsigned int new_value)
+{
+	int i;
+	for (i = 0; i < 32; i++) {
+		new_value >>= 1;
+		if (new_value == 0)
+			break;
+	}
+	return i;
+}
+
+// The address map is built once from the configuration: for each of
+// the two address spaces (HMC below bit 36, DIMM above it) every
+// coordinate is a contiguous bit field, so decoding an address is one
+// shift and one mask per field and never touches the heap.
+
+// Place a field of the given width at shift and return the shift of
+// the next field up.
+static int map_field(addr_field_t * field, int shift, int width)
+{
+	field->shift = shift;
+	field->mask = (1LL << width) - 1;
+	return shift + width;
+}
+
+void init_address_map(usimm_sim_t * sim)
+{
+	for(int is_dimm_address=0; is_dimm_address<2; is_dimm_address++)
+	{
+		//right now, first 64GB reserved for HMC, next 64GB for DIMMs
+		int channel_num = 0;
+		if(sim->NUM_HMCS != 0 && is_dimm_address && sim->NUM_CHANNELS != sim->NUM_HMCS)
+			channel_num = sim->NUM_HMCS;
+
+		int channelBitWidth = (is_dimm_address)?log_base2(sim->NUM_DIMMS):log_base2(sim->NUM_HMCS);
+		int vaultBitWidth = log_base2(sim->NUM_VAULTS[channel_num]);
+		int rankBitWidth = log_base2(sim->NUM_RANKS[channel_num]);
+		int bankBitWidth = log_base2(sim->NUM_BANKS[channel_num]);
+		int rowBitWidth = log_base2(sim->NUM_ROWS[channel_num]);
+		int colBitWidth = log_base2(sim->NUM_COLUMNS[channel_num]);
+		int byteOffsetWidth = log_base2(sim->CACHE_LINE_SIZE[channel_num]);
+
+		addr_map_t * map = &sim->address_map[is_dimm_address];
+		int shift = byteOffsetWidth;		  // skip the cache_offset
+
+		if(!is_dimm_address) {
+			map->channel_base = 0;
+			shift = map_field(&map->channel, shift, channelBitWidth);
+			shift = map_field(&map->vault, shift, vaultBitWidth);
+			shift = map_field(&map->bank, shift, bankBitWidth);
+			shift = map_field(&map->rank, shift, rankBitWidth);
+			shift = map_field(&map->column, shift, colBitWidth);
+			shift = map_field(&map->row, shift, rowBitWidth);
+		}
+		else if(sim->ADDRESS_MAPPING == 0) {
+			map->channel_base = sim->NUM_HMCS;
+			map_field(&map->vault, 0, 0);
+			shift = map_field(&map->column, shift, colBitWidth);
+			shift = map_field(&map->channel, shift, channelBitWidth);
+			shift = map_field(&map->bank, shift, bankBitWidth);
+			shift = map_field(&map->rank, shift, rankBitWidth);
+			shift = map_field(&map->row, shift, rowBitWidth);
+		}
+		else {
+			map->channel_base = sim->NUM_HMCS;
+			map_field(&map->vault, 0, 0);
+			shift = map_field(&map->channel, shift, channelBitWidth);
+			shift = map_field(&map->bank, shift, bankBitWidth);
+			shift = map_field(&map->rank, shift, rankBitWidth);
+			shift = map_field(&map->column, shift, colBitWidth);
+			shift = map_field(&map->row, shift, rowBitWidth);
+		}
+	}
+}
+
+// Function to decompose the incoming DRAM address into the
+// constituent channel, vault, rank, bank, row and column ids.
+// The result is returned by value; init_new_node caches it in the
+// request so it is decoded once per request.
+dram_address_t calc_dram_addr(usimm_sim_t * sim, long long int physical_address)
+{
+	int is_dimm_address = (sim->NUM_HMCS != 0)?((physical_address >> 36) != 0):1;
+	const addr_map_t * map = &sim->address_map[is_dimm_address];
+	dram_address_t this_a;
+
+	this_a.actual_address = physical_address;
+	this_a.channel = map->channel_base + ((physical_address >> map->channel.shift) & map->channel.mask);
+	this_a.vault = (physical_address >> map->vault.shift) & map->vault.mask;
+	this_a.rank = (physical_address >> map->rank.shift) & map->rank.mask;
+	this_a.bank = (physical_address >> map->bank.shift) & map->bank.mask;
+	this_a.row = (physical_address >> map->row.shift) & map->row.mask;
+	this_a.column = (physical_address >> map->column.shift) & map->column.mask;
+
+	return this_a;
+}
+
+// Functional warmup: leave open the row an access to physical_address
+// would open, as an open-page controller would, without any timing,
+// commands or statistics. A sampled run warms between windows while the
+// detailed simulation still has requests in flight, so a bank is only
+// warmed when nothing is queued to it and it is powered up and done
+// precharging or refreshing; any other bank keeps its state.
+void warm_open_row(usimm_sim_t * sim, long long int physical_address)
+{
+	dram_address_t this_addr = calc_dram_addr(sim, physical_address);
+	int channel = this_addr.channel, vault = this_addr.vault, rank = this_addr.rank;
+
+	if(channel >= sim->NUM_CHANNELS)
+		return; // a DIMM address on a system without DIMMs
+
+	bank_t * bank = &sim->dram_state[channel][vault][rank][this_addr.bank];
+	int i = rank * sim->NUM_BANKS[channel] + this_addr.bank;
+
+	if(sim->read_buckets[channel][vault].bucket[i].head || sim->write_buckets[channel][vault].bucket[i].head)
+		return;
+	if(bank->state != IDLE && bank->state != ROW_ACTIVE && !((bank->state == PRECHARGING || bank->state == REFRESHING) && sim->CYCLE_VAL >= bank->next_act))
+		return;
+
+	credit_rank_state(sim, channel, vault, rank);
+	bank->state = ROW_ACTIVE;
+	bank->active_row = this_addr.row;
+	mark_bank_dirty(sim, channel, vault, rank, this_addr.bank);
+}
+
+// Request pool: request_t nodes are carved out of cache-line aligned
+// slabs and recycled through a free list threaded on the next pointer.
+// The first slab is sized for every ROB entry plus every write queue
+// slot, so a run normally never allocates again after init; if the
+// estimate is exceeded another slab of the same size is added.
+
+#define CACHE_LINE_BYTES 64
+#define REQUEST_NODE_BYTES (((sizeof(request_t) + CACHE_LINE_BYTES - 1) / CACHE_LINE_BYTES) * CACHE_LINE_BYTES)
+
+static void grow_request_pool(usimm_sim_t * sim)
+{
+	char * slab = (char*)malloc(sim->request_slab_nodes * REQUEST_NODE_BYTES + CACHE_LINE_BYTES);
+
+	if(slab == NULL)
+	{
+		fprintf(sim->out, "FATAL : Malloc Error\n");
+
+		exit(-1);
+	}
+	void ** slabs = (void**)realloc(sim->request_slabs, (sim->request_pool_slabs + 1) * sizeof(void*));
+	if(slabs == NULL)
+	{
+		fprintf(sim->out, "FATAL : Malloc Error\n");
+
+		exit(-1);
+	}
+	sim->request_slabs = slabs;
+	sim->request_slabs[sim->request_pool_slabs++] = slab;
+
+	// the slab lives as long as the simulation; align the first node
+	// and push all nodes onto the free list
+	char * first = slab + (CACHE_LINE_BYTES - ((unsigned long)slab % CACHE_LINE_BYTES)) % CACHE_LINE_BYTES;
+	for(long long int i=sim->request_slab_nodes-1; i>=0; i--)
+	{
+		request_t * node = (request_t*)(first + i * REQUEST_NODE_BYTES);
+		node->next = sim->request_free_list;
+		sim->request_free_list = node;
+	}
+}
+
+void init_request_pool(usimm_sim_t * sim)
+{
+	sim->request_slab_nodes = (long long int)sim->NUMCORES * sim->ROBSIZE;
+	for(int i=0; i<sim->NUM_CHANNELS; i++)
+		sim->request_slab_nodes += (long long int)sim->NUM_VAULTS[i] * sim->WQ_CAPACITY[i];
+	if(sim->NUM_HMCS)
+		sim->request_slab_nodes += (long long int)sim->NUMCORES * sim->NUM_HMCS * sim->WQ_CAPACITY[0];
+
+	sim->request_free_list = NULL;
+	sim->request_slabs = NULL;
+	sim->request_pool_live = 0;
+	sim->request_pool_peak = 0;
+	sim->request_pool_slabs = 0;
+	grow_request_pool(sim);
+}
+
+request_t * alloc_request(usimm_sim_t * sim)
+{
+	if(sim->request_free_list == NULL)
+		grow_request_pool(sim);
+
+	request_t * node = sim->request_free_list;
+	sim->request_free_list = node->next;
+
+	sim->request_pool_live++;
+	if(sim->request_pool_live > sim->request_pool_peak)
+		sim->request_pool_peak = sim->request_pool_live;
+
+	return node;
+}
+
+// Requests finished while their vault is stepped are held back on the
+// vault and only returned to the pool by merge_vault_updates().
+void free_request(usimm_sim_t * sim, request_t * node)
+{
+	vault_updates_t * updates = &sim->vault_updates[node->dram_addr.channel][node->dram_addr.vault];
+
+	node->next = updates->freed_requests;
+	updates->freed_requests = node;
+	updates->num_freed++;
+}
+
+// Record a completion time to be written to the ROB after the step
+static void post_completion(usimm_sim_t * sim, request_t * request, long long int comptime)
+{
+	vault_updates_t * updates = &sim->vault_updates[request->dram_addr.channel][request->dram_addr.vault];
+
+	assert(updates->num_completions < MAX_COMPLETIONS_PER_STEP);
+	updates->completion[updates->num_completions].thread_id = request->thread_id;
+	updates->completion[updates->num_completions].instruction_id = request->instruction_id;
+	updates->completion[updates->num_completions].comptime = comptime;
+	updates->num_completions++;
+}
+
+// Record the latencies of a finished request for its channel and core,
+// and its total latency for its vault
+static void record_request_latency(usimm_sim_t * sim, const request_t * request)
+{
+	int channel = request->dram_addr.channel, vault = request->dram_addr.vault;
+	latency_stats_t * per_channel = &sim->channel_latency[channel];
+	latency_stats_t * core = &sim->core_latency[request->thread_id];
+	int hmc = channel < sim->NUM_HMCS;
+	long long int latency[NUM_LATENCY_KINDS];
+	int first, last;
+
+	if(request->operation_type == READ)
+	{
+		first = LAT_READ;
+		last = hmc ? LAT_READ_RETURN : LAT_READ_QUEUE;
+		latency[LAT_READ] = (hmc ? request->response_time : request->completion_time) - request->insert_time;
+		latency[LAT_READ_QUEUE] = request->dispatch_time - request->arrival_time;
+		latency[LAT_READ_LINK] = request->arrival_time - request->insert_time;
+		latency[LAT_READ_RETURN] = request->response_time - request->completion_time;
+	}
+	else
+	{
+		first = LAT_WRITE;
+		last = hmc ? LAT_WRITE_LINK : LAT_WRITE_QUEUE;
+		latency[LAT_WRITE] = request->completion_time - request->insert_time;
+		latency[LAT_WRITE_QUEUE] = request->dispatch_time - request->arrival_time;
+		latency[LAT_WRITE_LINK] = request->arrival_time - request->insert_time;
+	}
+	for(int k=first; k<=last; k++)
+	{
+		record_latency(&per_channel->kind[k], latency[k]);
+		record_latency(&core->kind[k], latency[k]);
+	}
+	if(request->operation_type == READ)
+		record_latency(&sim->vault_read_latency[channel][vault], latency[LAT_READ]);
+	else
+		record_latency(&sim->vault_write_latency[channel][vault], latency[LAT_WRITE]);
+}
+
+// Vaults are merged from the last to the first so that the pool hands
+// requests out again in the order a serial step would have freed them.
+// The latencies of the freed requests are recorded here rather than
+// while stepping, as the per-core histograms are shared by all vaults.
+void merge_vault_updates(usimm_sim_t * sim)
+{
+	for(int channel=0; channel<sim->NUM_CHANNELS; channel++)
+	for(int vault=sim->NUM_VAULTS[channel]-1; vault>=0; vault--)
+	{
+		vault_updates_t * updates = &sim->vault_updates[channel][vault];
+
+		for(int i=0; i<updates->num_completions; i++)
+			sim->ROB[updates->completion[i].thread_id].comptime[updates->completion[i].instruction_id] = updates->completion[i].comptime;
+		updates->num_completions = 0;
+
+		while(updates->freed_requests)
+		{
+			request_t * node = updates->freed_requests;
+			updates->freed_requests = node->next;
+			record_request_latency(sim, node);
+			node->next = sim->request_free_list;
+			sim->request_free_list = node;
+		}
+		sim->request_pool_live -= updates->num_freed;
+		assert(sim->request_pool_live >= 0);
+		updates->num_freed = 0;
+	}
+}
+
+// Queue index: the fetch stage asks whether a read or write to an
+// address is already queued (read_matches_write_or_read_queue,
+// write_exists_in_write_queue). Rather than walking the queues, every
+// request sitting in a queue that those checks search -- the per-core
+// queues of an HMC, the vault queues of a DIMM -- is counted in an
+// open-addressing table keyed by address and owner. The owner is the
+// core for HMC queues and -1 for DIMM queues (the address already
+// selects the channel and vault). Reads and writes have separate tables,
+// and every channel has its own pair so that channels stepped in
+// parallel never touch the same table.
+
+static long long int queue_index_home(const queue_index_t * index, long long int address, int owner)
+{
+	unsigned long long int key = ((unsigned long long int)address >> 6) ^ ((unsigned long long int)(owner + 1) << 58);
+	return (long long int)((key * 0x9E3779B97F4A7C15ULL) >> 20) & index->mask;
+}
+
+static void alloc_queue_index(queue_index_t * index, long long int size)
+{
+	index->entries = (queue_index_entry_t*)calloc(size, sizeof(queue_index_entry_t));
+	if(index->entries == NULL)
+	{
+		printf("FATAL : Malloc Error\n");
+
+		exit(-1);
+	}
+	index->mask = size - 1;
+	index->used = 0;
+}
+
+static void queue_index_add(queue_index_t * index, long long int address, int owner);
+
+static void grow_queue_index(queue_index_t * index)
+{
+	queue_index_t old = *index;
+
+	alloc_queue_index(index, 2 * (old.mask + 1));
+	for(long long int i=0; i<=old.mask; i++)
+		for(int c=0; c<old.entries[i].count; c++)
+			queue_index_add(index, old.entries[i].address, old.entries[i].owner);
+	free(old.entries);
+}
+
+static void queue_index_add(queue_index_t * index, long long int address, int owner)
+{
+	long long int i = queue_index_home(index, address, owner);
+
+	while(index->entries[i].count)
+	{
+		if(index->entries[i].address == address && index->entries[i].owner == owner)
+		{
+			index->entries[i].count++;
+			return;
+		}
+		i = (i + 1) & index->mask;
+	}
+	index->entries[i].address = address;
+	index->entries[i].owner = owner;
+	index->entries[i].count = 1;
+
+	// keep the load factor at or below one half
+	if(++index->used * 2 > index->mask + 1)
+		grow_queue_index(index);
+}
+
+static long long int queue_index_find(const queue_index_t * index, long long int address, int owner)
+{
+	long long int i = queue_index_home(index, address, owner);
+
+	while(index->entries[i].count)
+	{
+		if(index->entries[i].address == address && index->entries[i].owner == owner)
+			return i;
+		i = (i + 1) & index->mask;
+	}
+	return -1;
+}
+
+static void queue_index_remove(queue_index_t * index, long long int address, int owner)
+{
+	long long int i = queue_index_find(index, address, owner);
+
+	assert(i >= 0);
+	if(--index->entries[i].count)
+		return;
+	index->used--;
+
+	// backward-shift deletion: pull later entries of the probe run into
+	// the hole so lookups never need tombstones
+	long long int j = i;
+	while(1)
+	{
+		j = (j + 1) & index->mask;
+		if(!index->entries[j].count)
+			break;
+		long long int home = queue_index_home(index, index->entries[j].address, index->entries[j].owner);
+		if((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+			continue;
+		index->entries[i] = index->entries[j];
+		i = j;
+	}
+	index->entries[i].count = 0;
+}
+
+static int queue_index_owner(usimm_sim_t * sim, int channel, int thread_id)
+{
+	return (channel < sim->NUM_HMCS) ? thread_id : -1;
+}
+
+void init_queue_index(usimm_sim_t * sim)
+{
+	long long int size = 1;
+	while(size < 2 * sim->request_slab_nodes)
+		size <<= 1;
+	// a trace may name DIMM addresses on a system without DIMMs; those
+	// decode to channel NUM_HMCS, so every channel gets its tables
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	{
+		alloc_queue_index(&sim->read_queue_index[channel], size);
+		alloc_queue_index(&sim->write_queue_index[channel], size);
+	}
+}
+
+// Count every request already sitting in an indexed queue, into empty
+// tables; a restored checkpoint relinks the queues but not the tables
+void rebuild_queue_index(usimm_sim_t * sim)
+{
+	request_t * request;
+
+	for(int core=0; core<sim->NUMCORES; core++)
+	{
+		for(int hmc=0; hmc<sim->NUM_HMCS; hmc++)
+		{
+			LL_FOREACH(sim->read_queue_per_core_head[core][hmc], request)
+				queue_index_add(&sim->read_queue_index[hmc], request->physical_address, core);
+			LL_FOREACH(sim->write_queue_per_core_head[core][hmc], request)
+				queue_index_add(&sim->write_queue_index[hmc], request->physical_address, core);
+		}
+	}
+	for(int channel=sim->NUM_HMCS; channel<MAX_NUM_CHANNELS; channel++)
+	{
+		for(int vault=0; vault<MAX_NUM_VAULTS; vault++)
+		{
+			LL_FOREACH(sim->read_queue_head[channel][vault], request)
+				queue_index_add(&sim->read_queue_index[channel], request->physical_address, -1);
+			LL_FOREACH(sim->write_queue_head[channel][vault], request)
+				queue_index_add(&sim->write_queue_index[channel], request->physical_address, -1);
+		}
+	}
+}
+
+// Release what init_memory_controller_vars allocated
+void free_memory_controller_vars(usimm_sim_t * sim)
+{
+	for(int i=0; i<sim->request_pool_slabs; i++)
+		free(sim->request_slabs[i]);
+	free(sim->request_slabs);
+	sim->request_slabs = NULL;
+	sim->request_pool_slabs = 0;
+	sim->request_free_list = NULL;
+
+	for(int channel=0; channel<MAX_NUM_CHANNELS; channel++)
+	{
+		free(sim->read_queue_index[channel].entries);
+		free(sim->write_queue_index[channel].entries);
+		sim->read_queue_index[channel].entries = NULL;
+		sim->write_queue_index[channel].entries = NULL;
+	}
+}
+
+// Function to create a new request node to be inserted into the read
+// or write queue.
+void * init_new_node(usimm_sim_t * sim, long long int physical_address, long long int arrival_time, optype_t type, int thread_id, int instruction_id, long long int instruction_pc)
+{
+	request_t * new_node = alloc_request(sim);
+
+	new_node->physical_address = physical_address;
+
+	new_node->arrival_time = arrival_time;
+
+	new_node->insert_time = arrival_time;
+
+	new_node->response_time = -100;
+
+	new_node->dispatch_time = -100;
+
+	new_node->completion_time = -100;
+
+	new_node->latency = -100;
+
+	new_node->thread_id = thread_id;
+
+	new_node->next_command = NOP;
+
+	new_node->command_issuable = 0;
+
+	new_node->operation_type = type;
+
+	new_node->request_served = 0;
+
+	new_node->instruction_id = instruction_id;
+
+	new_node->instruction_pc = instruction_pc;
+
+	new_node->next = NULL;
+
+	new_node->bank_prev = NULL;
+
+	new_node->bank_next = NULL;
+
+	// decoded once here; everything downstream uses the cached copy
+	new_node->dram_addr = calc_dram_addr(sim, physical_address);
+
+	new_node->user_ptr = NULL;
+
+	return (new_node);
+}
+
+// Function that checks to see if an incoming read can be served by a
+// write request pending in the write queue and return
+// WQ_LOOKUP_LATENCY if there is a match. Also the function goes over
+// the read_queue to see if there is a pending read for the same
+// address and avoids duplication. The 2nd read is assumed to be
+// serviced when the original request completes.
+
+int read_matches_write_or_read_queue(usimm_sim_t * sim, long long int physical_address, int thread_id)
+{
+	//get channel info
+	dram_address_t this_addr = calc_dram_addr(sim, physical_address);
+	int channel = this_addr.channel;
+	int vault = this_addr.vault;
+	int owner = queue_index_owner(sim, channel, thread_id);
+
+	if(queue_index_find(&sim->write_queue_index[channel], physical_address, owner) >= 0)
+	{
+	  sim->num_read_merge ++;
+	  sim->stats_reads_merged_per_vault[channel][vault]++;
+	  return sim->WQ_LOOKUP_LATENCY[channel];
+	}
+	if(queue_index_find(&sim->read_queue_index[channel], physical_address, owner) >= 0)
+	{
+	  sim->num_read_merge ++;
+	  sim->stats_reads_merged_per_vault[channel][vault]++;
+	  return sim->RQ_LOOKUP_LATENCY[channel];
+	}
+	return 0;
+}
+
+// Function to merge writes to the same address
+int write_exists_in_write_queue(usimm_sim_t * sim, long long int physical_address, int thread_id)
+{
+	//get channel info
+	dram_address_t this_addr = calc_dram_addr(sim, physical_address);
+	int channel = this_addr.channel;
+	int vault = this_addr.vault;
+
+	if(queue_index_find(&sim->write_queue_index[channel], physical_address, queue_index_owner(sim, channel, thread_id)) >= 0)
+	{
+	  sim->num_write_merge ++;
+	  sim->stats_writes_merged_per_vault[channel][vault]++;
+	  return 1;
+	}
+	return 0;
+
+}
+
+
+int transfer_request_to_HMCs(usimm_sim_t * sim, int channel)
+{
+	request_t * transfer_request = NULL;
+	optype_t this_op = READ;
+	int vault = 0;
+
+	if(sim->CYCLE_VAL>=sim->next_request_schedule_time[channel] && sim->CYCLE_VAL)
+	{	
+		// gets next request to be transmistted through Link to HMC
+		transfer_request = schedule_to_hmc(sim, channel);
+		if(transfer_request != NULL)
+		{
+			vault = transfer_request->dram_addr.vault;
+			this_op = transfer_request->operation_type;
+			sim->stats_link_busy[channel][0] += sim->next_request_schedule_time[channel] - sim->CYCLE_VAL;
+			
+			// updating the arrival time for vault of the request to next_request_schedule_time 
+			transfer_request->arrival_time = sim->next_request_schedule_time[channel];
+			
+			if(this_op == READ)
+			{
+				LL_DELETE(sim->read_queue_per_core_head[transfer_request->thread_id][channel],transfer_request);
+				queue_index_remove(&sim->read_queue_index[channel], transfer_request->physical_address, transfer_request->thread_id);
+				sim->read_queue_length_for_core[transfer_request->thread_id][channel]-- ;
+
+				LL_APPEND(sim->read_queue_head[channel][vault], transfer_request);
+				add_to_bank_bucket(sim, transfer_request);
+				sim->read_queue_length[channel][vault] ++;
+
+			}
+			else if(this_op == WRITE)
+			{
+				LL_DELETE(sim->write_queue_per_core_head[transfer_request->thread_id][channel],transfer_request);
+				queue_index_remove(&sim->write_queue_index[channel], transfer_request->physical_address, transfer_request->thread_id);
+				sim->write_queue_length_for_core[transfer_request->thread_id][channel]-- ;
+
+				LL_APPEND(sim->write_queue_head[channel][vault], transfer_request);
+				add_to_bank_bucket(sim, transfer_request);
+				sim->write_queue_length[channel][vault] ++;
+			}
+			else
+			{
+				fprintf(sim->out, "PANIC: SCHED_ERROR : Request selected is not defined with operation types:%lld.\n", sim->CYCLE_VAL);
+			}
+			return 1;
+		}
+		else
+		{
+
+		}
+	}
+	else
+	{
+			// Wait unit next_request_schedule_time to make a new transfer
+	}
+	//printf(" Next SCheduled time : %lld \n", next_request_schedule_time);
+	return 0;
+}
+
+int transfer_response_to_PROCESSOR(usimm_sim_t * sim, int channel)
+{
+	request_t * transfer_request = NULL;
+
+	if(sim->CYCLE_VAL>=sim->next_respond_schedule_time[channel]  && sim->CYCLE_VAL)
+	{	
+		// gets next request to be transmistted through Link to HMC
+		transfer_request = schedule_completed_requests(sim, channel);
+		if(transfer_request != NULL)
+		{			
+			assert(transfer_request->operation_type==READ);
+			assert(transfer_request->request_served==1);
+			// updating the arrival time for vault of the request to next_request_schedule_time 
+			//transfer_request->arrival_time = next_request_schedule_time;
+			transfer_request->request_served = 2 ;
+			sim->stats_link_busy[channel][1] += sim->next_respond_schedule_time[channel] - sim->CYCLE_VAL;
+			transfer_request->response_time = sim->next_respond_schedule_time[channel];
+			post_completion(sim, transfer_request, sim->next_respond_schedule_time[channel] + sim->PIPELINEDEPTH);
+			return 1;
+		}
+		else
+		{
+			// No responses left
+		}
+	}
+	else
+	{
+			// Wait unit next_request_schedule_time to make a new transfer
+	}
+	//printf(" Next response scheduled time : %lld \n", next_respond_schedule_time);
+	return 0;
+}
+
+// Insert a new read to the read queue
+request_t * insert_read(usimm_sim_t * sim, long long int physical_address, long long int arrival_time, int thread_id, int instruction_id, long long int instruction_pc)
+{
+
+	optype_t this_op = READ;
+
+	request_t * new_node = init_new_node(sim, physical_address, arrival_time, this_op, thread_id, instruction_id, instruction_pc);
+
+	//get channel info
+	int channel = new_node->dram_addr.channel;
+	int vault = new_node->dram_addr.vault;
+
+	sim->stats_reads_seen[channel][vault]++;
+
+	if(channel < sim->NUM_HMCS) {
+		LL_APPEND(sim->read_queue_per_core_head[thread_id][channel], new_node);
+		sim->read_queue_length_for_core[thread_id][channel]++;
+	}
+	else {
+		LL_APPEND(sim->read_queue_head[channel][vault], new_node);
+		add_to_bank_bucket(sim, new_node);
+		sim->read_queue_length[channel][vault]++;
+	}
+	queue_index_add(&sim->read_queue_index[channel], physical_address, queue_index_owner(sim, channel, thread_id));
+
+	//UT_MEM_DEBUG("\nCyc: %lld New READ:%lld Core:%d Chan:%d Rank:%d Bank:%d Row:%lld RD_Q_Length:%lld\n", CYCLE_VAL, new_node->id, new_node->thread_id, new_node->dram_addr.channel,  new_node->dram_addr.rank,  new_node->dram_addr.bank,  new_node->dram_addr.row, read_queue_length[channel]);
+	
+	return new_node;
+}
+
+// Insert a new write to the write queue
+request_t * insert_write(usimm_sim_t * sim, long long int physical_address, long long int arrival_time, int thread_id, int instruction_id)
+{
+	optype_t this_op = WRITE;
+
+	request_t * new_node = init_new_node(sim, physical_address, arrival_time, this_op, thread_id, instruction_id, 0);
+
+	int channel = new_node->dram_addr.channel;
+	int vault = new_node->dram_addr.vault;
+
+	sim->stats_writes_seen[channel][vault]++;
+
+	if(channel < sim->NUM_HMCS) {
+		LL_APPEND(sim->write_queue_per_core_head[thread_id][channel], new_node);
+		sim->write_queue_length_for_core[thread_id][channel]++;
+	}
+	else {
+		LL_APPEND(sim->write_queue_head[channel][vault], new_node);
+		add_to_bank_bucket(sim, new_node);
+		sim->write_queue_length[channel][vault]++;
+	}
+	queue_index_add(&sim->write_queue_index[channel], physical_address, queue_index_owner(sim, channel, thread_id));
+
+	//UT_MEM_DEBUG("\nCyc: %lld New WRITE:%lld Core:%d Chan:%d Rank:%d Bank:%d Row:%lld WR_Q_Length:%lld\n", CYCLE_VAL, new_node->id, new_node->thread_id, new_node->dram_addr.channel,  new_node->dram_addr.rank,  new_node->dram_addr.bank,  new_node->dram_addr.row, write_queue_length[channel]);
+
+	return new_node;
+}
+
+/********************************************************/
+/*	Bank buckets					*/
+/********************************************************/
+
+static void note_event(long long int * next, long long int event, long long int since);
+
+static vault_buckets_t * vault_buckets_of(usimm_sim_t * sim, request_t * request)
+{
+	if(request->operation_type == READ)
+		return &sim->read_buckets[request->dram_addr.channel][request->dram_addr.vault];
+	else
+		return &sim->write_buckets[request->dram_addr.channel][request->dram_addr.vault];
+}
+
+static int bucket_index(usimm_sim_t * sim, request_t * request)
+{
+	return request->dram_addr.rank * sim->NUM_BANKS[request->dram_addr.channel] + request->dram_addr.bank;
+}
+
+// Called when a request enters a vault queue
+void add_to_bank_bucket(usimm_sim_t * sim, request_t * request)
+{
+	vault_buckets_t * vb = vault_buckets_of(sim, request);
+	int i = bucket_index(sim, request);
+	bank_bucket_t * bucket = &vb->bucket[i];
+
+	request->bank_prev = NULL;
+	request->bank_next = bucket->head;
+	if(bucket->head)
+		bucket->head->bank_prev = request;
+	bucket->head = request;
+	if(request->dram_addr.row == bucket->hit_row)
+		bucket->hits++;
+
+	vb->occupied[i/64] |= 1ULL << (i%64);
+	vb->dirty[i/64] |= 1ULL << (i%64);
+}
+
+// Called once the request's final command is issued; from then on the
+// queue updates ignore it
+static void remove_from_bank_bucket(usimm_sim_t * sim, request_t * request)
+{
+	vault_buckets_t * vb = vault_buckets_of(sim, request);
+	int i = bucket_index(sim, request);
+	bank_bucket_t * bucket = &vb->bucket[i];
+
+	if(request->bank_prev)
+		request->bank_prev->bank_next = request->bank_next;
+	else
+		bucket->head = request->bank_next;
+	if(request->bank_next)
+		request->bank_next->bank_prev = request->bank_prev;
+	request->bank_prev = NULL;
+	request->bank_next = NULL;
+	if(request->dram_addr.row == bucket->hit_row)
+		bucket->hits--;
+
+	if(bucket->head == NULL)
+		vb->occupied[i/64] &= ~(1ULL << (i%64));
+}
+
+// Number of queued, unserved requests of the given type that hit the
+// row currently open in the bank. The count follows enqueues and
+// dequeues; it is rebuilt from the bucket only when the open row has
+// changed since the last lookup.
+int queued_row_hits(usimm_sim_t * sim, int channel, int vault, int rank, int bank, optype_t type)
+{
+	vault_buckets_t * vb = (type == READ) ? &sim->read_buckets[channel][vault] : &sim->write_buckets[channel][vault];
+	bank_bucket_t * bucket = &vb->bucket[rank * sim->NUM_BANKS[channel] + bank];
+	long long int active_row = sim->dram_state[channel][vault][rank][bank].active_row;
+
+	if(bucket->hit_row != active_row)
+	{
+		request_t * ptr = NULL;
+
+		bucket->hit_row = active_row;
+		bucket->hits = 0;
+		for(ptr = bucket->head; ptr; ptr = ptr->bank_next)
+			if(ptr->dram_addr.row == active_row)
+				bucket->hits++;
+	}
+	return bucket->hits;
+}
+
+void mark_bank_dirty(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+	int i = rank * sim->NUM_BANKS[channel] + bank;
+
+	sim->read_buckets[channel][vault].dirty[i/64] |= 1ULL << (i%64);
+	sim->write_buckets[channel][vault].dirty[i/64] |= 1ULL << (i%64);
+}
+
+void mark_rank_dirty(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	for(int bank=0; bank<sim->NUM_BANKS[channel]; bank++)
+		mark_bank_dirty(sim, channel, vault, rank, bank);
+}
+
+void mark_vault_dirty(usimm_sim_t * sim, int channel, int vault)
+{
+	for(int w=0; w<BUCKET_MASK_WORDS; w++)
+	{
+		sim->read_buckets[channel][vault].dirty[w] = ~0ULL;
+		sim->write_buckets[channel][vault].dirty[w] = ~0ULL;
+	}
+}
+
+// List the occupied buckets of a vault queue that must be re-evaluated
+// this cycle and clear their dirty bits. Buckets whose wakeup has
+// passed are only looked for once the vault-wide wakeup is due, which
+// is then recomputed from the buckets that stay untouched.
+static int collect_stale_buckets(usimm_sim_t * sim, vault_buckets_t * vb, int * stale)
+{
+	int due = vb->wakeup >= 0 && sim->CYCLE_VAL >= vb->wakeup;
+	int n = 0;
+
+	if(due)
+		vb->wakeup = -1;
+	for(int w=0; w<BUCKET_MASK_WORDS; w++)
+	{
+		unsigned long long int bits = due ? vb->occupied[w] : (vb->occupied[w] & vb->dirty[w]);
+
+		while(bits)
+		{
+			int i = w*64 + __builtin_ctzll(bits);
+			bank_bucket_t * bucket = &vb->bucket[i];
+
+			bits &= bits - 1;
+			if(((vb->dirty[w] >> (i%64)) & 1) || (bucket->wakeup >= 0 && sim->CYCLE_VAL >= bucket->wakeup))
+				stale[n++] = i;
+			else
+				note_event(&vb->wakeup, bucket->wakeup, sim->CYCLE_VAL);
+		}
+		vb->dirty[w] = 0;
+	}
+	return n;
+}
+
+// After a bucket has been evaluated, find the first cycle at which one
+// of the comparisons in update_*_queue_commands could flip without any
+// bank state changing: a next_* constraint or the T_FAW window expiring,
+// or the refresh deadline coming within a command's reach.
+// 'cas_to_refresh' is the reach of the column command (T_RTP for reads).
+static void schedule_bucket_wakeup(usimm_sim_t * sim, vault_buckets_t * vb, int i, int channel, int vault, int rank, int bank, long long int cas_to_refresh)
+{
+	bank_t * b = &sim->dram_state[channel][vault][rank][bank];
+	long long int deadline = sim->refresh_issue_deadline[channel][vault][rank];
+	long long int wakeup = -1;
+
+	note_event(&wakeup, b->next_act, sim->CYCLE_VAL);
+	note_event(&wakeup, b->next_read, sim->CYCLE_VAL);
+	note_event(&wakeup, b->next_write, sim->CYCLE_VAL);
+	note_event(&wakeup, b->next_pre, sim->CYCLE_VAL);
+	note_event(&wakeup, b->next_powerup, sim->CYCLE_VAL);
+	note_event(&wakeup, T_FAW_met_cycle(sim, channel, vault, rank), sim->CYCLE_VAL);
+	note_event(&wakeup, deadline - sim->T_RAS[channel] + 1, sim->CYCLE_VAL);
+	note_event(&wakeup, deadline - cas_to_refresh + 1, sim->CYCLE_VAL);
+	note_event(&wakeup, deadline - sim->T_RP[channel] + 1, sim->CYCLE_VAL);
+	note_event(&wakeup, deadline - sim->T_XP_DLL[channel] + 1, sim->CYCLE_VAL);
+	note_event(&wakeup, deadline - sim->T_XP[channel] + 1, sim->CYCLE_VAL);
+
+	vb->bucket[i].wakeup = wakeup;
+	note_event(&vb->wakeup, wakeup, sim->CYCLE_VAL);
+}
+
+// Function to update the states of the read queue requests.
+// Each DRAM cycle, this function iterates over the stale (rank, bank)
+// buckets of the read queue and updates the next_command and
+// command_issuable fields to mark which commands can be issued this
+// cycle
+void update_read_queue_commands(usimm_sim_t * sim, int channel, int vault)
+{
+	vault_buckets_t * vb = &sim->read_buckets[channel][vault];
+	int stale[MAX_NUM_BUCKETS];
+	int num_stale = collect_stale_buckets(sim, vb, stale);
+
+	for(int k=0; k<num_stale; k++)
+	{
+		int rank = stale[k] / sim->NUM_BANKS[channel];
+		int bank = stale[k] % sim->NUM_BANKS[channel];
+
+		for(request_t * curr = vb->bucket[stale[k]].head; curr; curr = curr->bank_next)
+		{
+			// ignore the requests whose completion time has been determined
+			// these requests will be removed this very cycle 
+			if(curr->request_served == 1)
+				continue; 
+
+			int row = curr->dram_addr.row;
+
+			switch (sim->dram_state[channel][vault][rank][bank].state)
+			{
+			  // if the DRAM bank has no rows open and the chip is
+			  // powered up, the next command for the request
+			  // should be ACT.
+				case IDLE:
+				case PRECHARGING:
+				case REFRESHING:
+
+		  
+					curr->next_command = ACT_CMD;
+
+
+					if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_act && is_T_FAW_met(sim, channel, vault, rank, sim->CYCLE_VAL))
+						curr->command_issuable = 1;
+					else
+						curr->command_issuable = 0;
+			
+					// check if we are in OR too close to the forced refresh period
+					if(sim->forced_refresh_mode_on[channel][vault][rank] || ((sim->CYCLE_VAL + sim->T_RAS[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+						curr->command_issuable = 0;
+					break;
+
+				case ROW_ACTIVE:
+
+					// if the bank is active then check if this is a row-hit or not
+					// If the request is to the currently
+					// opened row, the next command should
+					// be a COL_RD, else it should be a
+					// PRECHARGE
+					if(row == sim->dram_state[channel][vault][rank][bank].active_row)
+					{
+						curr->next_command = COL_READ_CMD;
+				
+						if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_read)
+							curr->command_issuable = 1;
+						else
+							curr->command_issuable = 0;
+				
+						if(sim->forced_refresh_mode_on[channel][vault][rank] ||((sim->CYCLE_VAL + sim->T_RTP[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+							curr->command_issuable = 0;
+					}
+					else
+					{
+						curr->next_command = PRE_CMD;
+
+						if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_pre)
+							curr->command_issuable = 1;
+						else
+							curr->command_issuable = 0;
+				
+						if(sim->forced_refresh_mode_on[channel][vault][rank]|| ((sim->CYCLE_VAL+sim->T_RP[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+							curr->command_issuable = 0;
+
+					}
+			
+					break;
+					// if the chip was powered, down the
+					// next command required is power_up
+
+				case PRECHARGE_POWER_DOWN_SLOW :
+				case PRECHARGE_POWER_DOWN_FAST:
+				case ACTIVE_POWER_DOWN :
+
+					curr->next_command = PWR_UP_CMD;
+
+					if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_powerup)
+						curr->command_issuable = 1;
+					else
+						curr->command_issuable=0;
+			
+					if((sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW) && ((sim->CYCLE_VAL + sim->T_XP_DLL[channel]) > sim->refresh_issue_deadline[channel][vault][rank] ))
+						curr->command_issuable = 0;
+					else if(((sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST) || (sim->dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN)) && ((sim->CYCLE_VAL + sim->T_XP[channel]) > sim->refresh_issue_deadline[channel][vault][rank] ))
+						curr->command_issuable = 0;
+
+					break;
+
+
+				default : break;
+			}
+		}
+		schedule_bucket_wakeup(sim, vb, stale[k], channel, vault, rank, bank, sim->T_RTP[channel]);
+	}
+}
+
+// Similar to update_read_queue above, but for write queue
+void update_write_queue_commands(usimm_sim_t * sim, int channel, int vault)
+{
+	vault_buckets_t * vb = &sim->write_buckets[channel][vault];
+	int stale[MAX_NUM_BUCKETS];
+	int num_stale = collect_stale_buckets(sim, vb, stale);
+
+	for(int k=0; k<num_stale; k++)
+	{
+		int rank = stale[k] / sim->NUM_BANKS[channel];
+		int bank = stale[k] % sim->NUM_BANKS[channel];
+
+		for(request_t * curr = vb->bucket[stale[k]].head; curr; curr = curr->bank_next)
+		{
+			if(curr->request_served == 2 && channel < sim->NUM_HMCS)
+				continue; 
+			else if(curr->request_served == 1 && channel >= sim->NUM_HMCS)
+				continue;
+	
+			int row = curr->dram_addr.row;
+
+			switch (sim->dram_state[channel][vault][rank][bank].state)
+			{
+				case IDLE:
+				case PRECHARGING:
+				case REFRESHING:
+					curr->next_command = ACT_CMD;
+
+					if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_act && is_T_FAW_met(sim, channel, vault, rank, sim->CYCLE_VAL))
+						curr->command_issuable = 1;
+					else
+						curr->command_issuable = 0;
+			
+					// check if we are in or too close to the forced refresh period
+					if(sim->forced_refresh_mode_on[channel][vault][rank] || ((sim->CYCLE_VAL + sim->T_RAS[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+						curr->command_issuable = 0;
+
+					break;
+
+
+				case ROW_ACTIVE:
+
+					if(row == sim->dram_state[channel][vault][rank][bank].active_row)
+					{
+						curr->next_command = COL_WRITE_CMD;
+
+						if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_write)
+							curr->command_issuable = 1;
+						else
+							curr->command_issuable = 0;
+
+						if(sim->forced_refresh_mode_on[channel][vault][rank]|| ((sim->CYCLE_VAL+sim->T_CWD[channel]+sim->T_DATA_TRANS[channel]+sim->T_WR[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+							curr->command_issuable = 0;
+					}
+					else
+					{
+						curr->next_command = PRE_CMD;
+
+						if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_pre)
+							curr->command_issuable = 1;
+						else
+							curr->command_issuable = 0;
+
+						if(sim->forced_refresh_mode_on[channel][vault][rank]|| ((sim->CYCLE_VAL+sim->T_RP[channel]) > sim->refresh_issue_deadline[channel][vault][rank]))
+							curr->command_issuable = 0;
+
+					}
+			
+			
+					break;
+
+				case PRECHARGE_POWER_DOWN_SLOW:
+				case PRECHARGE_POWER_DOWN_FAST:
+				case ACTIVE_POWER_DOWN :
+
+					curr->next_command = PWR_UP_CMD;
+
+					if(sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_powerup)
+						curr->command_issuable = 1;
+					else
+						curr->command_issuable = 0;
+
+					if(sim->forced_refresh_mode_on[channel][vault][rank])
+						curr->command_issuable= 0;
+
+					if((sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW) && ((sim->CYCLE_VAL + sim->T_XP_DLL[channel]) > sim->refresh_issue_deadline[channel][vault][rank] ))
+						curr->command_issuable = 0;
+					else if(((sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST) || (sim->dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN)) && ((sim->CYCLE_VAL + sim->T_XP[channel]) > sim->refresh_issue_deadline[channel][vault][rank] ))
+						curr->command_issuable = 0;
+
+					break;
+
+				default : break;
+			}
+		}
+		schedule_bucket_wakeup(sim, vb, stale[k], channel, vault, rank, bank, sim->T_CWD[channel]+sim->T_DATA_TRANS[channel]+sim->T_WR[channel]);
+	}
+}
+
+// Remove finished requests from the queues.
+void clean_queues(usimm_sim_t * sim, int channel, int vault)
+{
+
+	request_t * rd_ptr =  NULL;
+	request_t * rd_tmp = NULL;
+	request_t * wrt_ptr = NULL;
+	request_t * wrt_tmp = NULL;
+
+	// Delete all READ requests whose completion time has been determined i.e. COL_RD has been issued
+	if(channel < sim->NUM_HMCS) {
+		LL_FOREACH_SAFE(sim->read_return_queue_head[channel][vault],rd_ptr,rd_tmp) 
+		{
+			if(rd_ptr->request_served == 2)
+			{
+				assert(rd_ptr->next_command == COL_READ_CMD);
+				assert(rd_ptr->completion_time != -100);
+				LL_DELETE(sim->read_return_queue_head[channel][vault],rd_ptr);
+				if(rd_ptr->user_ptr)
+					free(rd_ptr->user_ptr);
+
+				free_request(sim, rd_ptr);
+				sim->read_return_queue_length[channel][vault]--;
+				assert(sim->read_return_queue_length[channel][vault]>=0);
+			}
+		}
+	}
+	else {
+		LL_FOREACH_SAFE(sim->read_queue_head[channel][vault],rd_ptr,rd_tmp) 
+		{
+			if(rd_ptr->request_served == 1)
+			{
+				assert(rd_ptr->next_command == COL_READ_CMD);
+				assert(rd_ptr->completion_time != -100);
+				LL_DELETE(sim->read_queue_head[channel][vault],rd_ptr);
+				queue_index_remove(&sim->read_queue_index[channel], rd_ptr->physical_address, -1);
+				if(rd_ptr->user_ptr)
+					free(rd_ptr->user_ptr);
+
+				free_request(sim, rd_ptr);
+				sim->read_queue_length[channel][vault]--;
+				assert(sim->read_queue_length[channel][vault]>=0);
+			}
+		}
+	}
+
+	// Delete all WRITE requests whose completion time has been determined i.e COL_WRITE has been issued
+	LL_FOREACH_SAFE(sim->write_queue_head[channel][vault],wrt_ptr,wrt_tmp) 
+	{
+		if((wrt_ptr->request_served == 2 && channel < sim->NUM_HMCS) || (wrt_ptr->request_served == 1 && channel >= sim->NUM_HMCS))
+		{
+			assert(wrt_ptr->next_command == COL_WRITE_CMD);
+
+			LL_DELETE(sim->write_queue_head[channel][vault],wrt_ptr);
+			if(channel >= sim->NUM_HMCS)
+				queue_index_remove(&sim->write_queue_index[channel], wrt_ptr->physical_address, -1);
+
+			if(wrt_ptr->user_ptr)
+				free(wrt_ptr->user_ptr);
+
+			free_request(sim, wrt_ptr);
+
+			sim->write_queue_length[channel][vault]--;
+
+			assert(sim->write_queue_length[channel][vault]>=0);
+		}
+	}
+}
+
+// function to update a completed read request to read return queue of each vault 
+void update_read_return_queue(usimm_sim_t * sim, int channel, int vault)
+{
+	request_t * request = NULL;
+	
+	LL_FOREACH(sim->read_queue_head[channel][vault],request)
+	{
+		if(request->request_served == 1 && (sim->CYCLE_VAL >= request->completion_time))
+		{
+			assert(request->next_command == COL_READ_CMD);
+	
+			assert(request->completion_time != -100);
+		
+			LL_DELETE(sim->read_queue_head[channel][vault],request);
+		
+			sim->read_queue_length[channel][vault]--;
+		
+			assert(sim->read_queue_length[channel][vault]>=0);
+		
+			LL_APPEND(sim->read_return_queue_head[channel][vault],request);
+		
+			sim->read_return_queue_length[channel][vault]++;
+
+			//printf(" Updated Read Return queue with hmc id %d vault %d \n", hmc , vault );
+		}
+	}
+}
+
+
+// This affects state change
+// Issue a valid command for a request in either the read or write
+// queue.
+// Upon issuing the request, the dram_state is changed and the
+// next_"cmd" variables are updated to indicate when the next "cmd"
+// can be issued to each bank
+int issue_request_command(usimm_sim_t * sim, request_t * request) 
+{
+	long long int cycle =  sim->CYCLE_VAL;
+	if(request->command_issuable != 1 || sim->command_issued_current_cycle[request->dram_addr.channel][request->dram_addr.vault] || sim->CYCLE_VAL < request->arrival_time)
+	{
+		fprintf(sim->out, "PANIC: SCHED_ERROR : Command for request selected can not be issued in  cycle:%lld.\n", sim->CYCLE_VAL);
+		return 0;
+	}
+
+	int channel = request->dram_addr.channel;
+	int vault = request->dram_addr.vault;
+	int rank = request->dram_addr.rank;
+	int bank = request->dram_addr.bank;
+	long long int row = request->dram_addr.row;
+	command_t cmd = request->next_command;
+
+	switch(cmd)
+	{
+		case ACT_CMD :
+
+			assert(sim->dram_state[channel][vault][rank][bank].state == PRECHARGING || sim->dram_state[channel][vault][rank][bank].state == IDLE || sim->dram_state[channel][vault][rank][bank].state == REFRESHING);
+
+			//UT_MEM_DEBUG("\nCycle: %lld Cmd:ACT Req:%lld Chan:%d Rank:%d Bank:%d Row:%lld\n", CYCLE_VAL, request->id, channel, vault, rank, bank, row);
+
+			credit_rank_state(sim, channel, vault, rank);
+			charge_command_energy(sim, channel, vault, rank, ACT_CMD);
+
+			// open row
+			sim->dram_state[channel][vault][rank][bank].state = ROW_ACTIVE;
+
+			sim->dram_state[channel][vault][rank][bank].active_row = row;
+
+			sim->dram_state[channel][vault][rank][bank].next_pre = max((cycle + sim->T_RAS[channel]) , sim->dram_state[channel][vault][rank][bank].next_pre);
+			
+			sim->dram_state[channel][vault][rank][bank].next_refresh = max((cycle + sim->T_RAS[channel]) , sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+			sim->dram_state[channel][vault][rank][bank].next_read = max(cycle + sim->T_RCD[channel], sim->dram_state[channel][vault][rank][bank].next_read); 
+
+			sim->dram_state[channel][vault][rank][bank].next_write = max(cycle + sim->T_RCD[channel],  sim->dram_state[channel][vault][rank][bank].next_write);
+
+			sim->dram_state[channel][vault][rank][bank].next_act = max(cycle + sim->T_RC[channel],  sim->dram_state[channel][vault][rank][bank].next_act);
+
+			sim->dram_state[channel][vault][rank][bank].next_powerdown = max(cycle + sim->T_RCD[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+			for(int i=0;i<sim->NUM_BANKS[channel];i++)
+				if(i!=bank)
+					sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_RRD[channel], sim->dram_state[channel][vault][rank][i].next_act);
+
+			record_activate(sim, channel, vault, rank, cycle);
+
+			if(request->operation_type == READ)
+				sim->stats_num_activate_read[channel][vault][rank][bank]++;
+			else
+				sim->stats_num_activate_write[channel][vault][rank][bank]++;
+
+			sim->stats_num_activate[channel][vault][rank]++;
+
+			sim->average_gap_between_activates[channel][vault][rank] = ((sim->average_gap_between_activates[channel][vault][rank]*(sim->stats_num_activate[channel][vault][rank]-1)) + (sim->CYCLE_VAL-sim->last_activate[channel][vault][rank]))/sim->stats_num_activate[channel][vault][rank];
+
+			sim->last_activate[channel][vault][rank] = sim->CYCLE_VAL;
+
+			mark_rank_dirty(sim, channel, vault, rank);
+
+			sim->command_issued_current_cycle[channel][vault] = 1;
+			break;
+
+		case COL_READ_CMD :
+
+			assert(sim->dram_state[channel][vault][rank][bank].state == ROW_ACTIVE) ;
+
+			sim->dram_state[channel][vault][rank][bank].next_pre = max(cycle + sim->T_RTP[channel] , sim->dram_state[channel][vault][rank][bank].next_pre);
+			
+			sim->dram_state[channel][vault][rank][bank].next_refresh = max(cycle + sim->T_RTP[channel] , sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+			sim->dram_state[channel][vault][rank][bank].next_powerdown = max (cycle+sim->T_RTP[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+			for(int i=0;i<sim->NUM_RANKS[channel];i++)
+			{
+				for(int j=0;j<sim->NUM_BANKS[channel];j++)
+				{
+					if(i!=rank)
+						sim->dram_state[channel][vault][i][j].next_read = max(cycle+ sim->T_DATA_TRANS[channel] + sim->T_RTRS[channel], sim->dram_state[channel][vault][i][j].next_read);
+
+					else
+						sim->dram_state[channel][vault][i][j].next_read = max(cycle + max(sim->T_CCD[channel], sim->T_DATA_TRANS[channel]), sim->dram_state[channel][vault][i][j].next_read); 
+
+					sim->dram_state[channel][vault][i][j].next_write = max(cycle + sim->T_CAS[channel]+ sim->T_DATA_TRANS[channel] + sim->T_RTRS[channel]- sim->T_CWD[channel] ,  sim->dram_state[channel][vault][i][j].next_write);
+				}
+			}
+
+			// set the completion time of this read request
+			// in the ROB and the controller queue.
+			request->completion_time = sim->CYCLE_VAL+ sim->T_CAS[channel] + sim->T_DATA_TRANS[channel] ;
+			request->latency = request->completion_time - request->arrival_time;
+			request->dispatch_time = sim->CYCLE_VAL;
+			request->request_served = 1;
+
+			// update the ROB with the completion time
+			if(channel >= sim->NUM_HMCS)
+				post_completion(sim, request, request->completion_time+sim->PIPELINEDEPTH);
+
+			sim->stats_reads_completed[channel][vault]++;
+			sim->stats_average_read_latency[channel][vault] = ((sim->stats_reads_completed[channel][vault]-1)*sim->stats_average_read_latency[channel][vault] + request->latency)/sim->stats_reads_completed[channel][vault];
+			sim->stats_average_read_queue_latency[channel][vault] = ((sim->stats_reads_completed[channel][vault]-1)*sim->stats_average_read_queue_latency[channel][vault] + (request->dispatch_time - request->arrival_time))/sim->stats_reads_completed[channel][vault];
+			//UT_MEM_DEBUG("Req:%lld finishes at Cycle: %lld\n", request->id, request->completion_time);
+
+			//printf("Cycle: %10lld, Reads  Completed = %5lld, this_latency= %5lld, latency = %f\n", CYCLE_VAL, stats_reads_completed[channel][vault], request->latency, stats_average_read_latency[channel][vault]);	
+
+			sim->stats_num_read[channel][vault][rank][bank]++;
+			charge_command_energy(sim, channel, vault, rank, COL_READ_CMD);
+
+			for(int i=0; i<sim->NUM_RANKS[channel] ;i++)
+			{
+				if(i!=rank)
+					sim->stats_time_spent_terminating_reads_from_other_ranks[channel][vault][i] += sim->T_DATA_TRANS[channel];
+			}
+
+			// the request is done; every bank's next_read/next_write moved
+			remove_from_bank_bucket(sim, request);
+			mark_vault_dirty(sim, channel, vault);
+
+			sim->command_issued_current_cycle[channel][vault] = 1;
+			sim->cas_issued_current_cycle[channel][vault][rank][bank]=1;
+			break;
+
+		case COL_WRITE_CMD :
+
+
+			assert(sim->dram_state[channel][vault][rank][bank].state == ROW_ACTIVE);
+
+			//UT_MEM_DEBUG("\nCycle: %lld Cmd: COL_WRITE Req:%lld Chan:%d Rank:%d Bank:%d \n", CYCLE_VAL, request->id, channel, vault, rank, bank);
+
+			sim->dram_state[channel][vault][rank][bank].next_pre = max(cycle + sim->T_CWD[channel] +sim->T_DATA_TRANS[channel] + sim->T_WR[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+			
+			sim->dram_state[channel][vault][rank][bank].next_refresh = max(cycle + sim->T_CWD[channel] +sim->T_DATA_TRANS[channel] + sim->T_WR[channel], sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+			sim->dram_state[channel][vault][rank][bank].next_powerdown = max (cycle + sim->T_CWD[channel] + sim->T_DATA_TRANS[channel] + sim->T_WR[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+			for(int i=0;i<sim->NUM_RANKS[channel];i++)
+			{
+				for(int j=0;j<sim->NUM_BANKS[channel];j++)
+				{
+					if(i!=rank)
+					{
+						sim->dram_state[channel][vault][i][j].next_write = max(cycle + sim->T_DATA_TRANS[channel] + sim->T_RTRS[channel], sim->dram_state[channel][vault][i][j].next_write);
+
+						sim->dram_state[channel][vault][i][j].next_read = max(cycle + sim->T_CWD[channel] + sim->T_DATA_TRANS[channel] + sim->T_RTRS[channel] - sim->T_CAS[channel], sim->dram_state[channel][vault][i][j].next_read);
+					}
+					else
+					{
+						sim->dram_state[channel][vault][i][j].next_write = max(cycle + max(sim->T_CCD[channel], sim->T_DATA_TRANS[channel]), sim->dram_state[channel][vault][i][j].next_write); 
+
+						sim->dram_state[channel][vault][i][j].next_read = max(cycle + sim->T_CWD[channel] + sim->T_DATA_TRANS[channel] + sim->T_WTR[channel] ,  sim->dram_state[channel][vault][i][j].next_read);
+					}
+				}
+			}
+
+			// set the completion time of this write request
+			request->completion_time = sim->CYCLE_VAL+ sim->T_DATA_TRANS[channel] + sim->T_WR[channel];
+			request->latency = request->completion_time - request->arrival_time;
+			request->dispatch_time = sim->CYCLE_VAL;
+			request->request_served = (channel<sim->NUM_HMCS)?2:1;
+
+			sim->stats_writes_completed[channel][vault]++;
+
+			sim->stats_num_write[channel][vault][rank][bank]++;
+			charge_command_energy(sim, channel, vault, rank, COL_WRITE_CMD);
+			
+			sim->stats_average_write_latency[channel][vault] = ((sim->stats_writes_completed[channel][vault]-1)*sim->stats_average_write_latency[channel][vault] + request->latency)/sim->stats_writes_completed[channel][vault];
+			sim->stats_average_write_queue_latency[channel][vault] = ((sim->stats_writes_completed[channel][vault]-1)*sim->stats_average_write_queue_latency[channel][vault] + (request->dispatch_time - request->arrival_time))/sim->stats_writes_completed[channel][vault];
+			//UT_MEM_DEBUG("Req:%lld finishes at Cycle: %lld\n", request->id, request->completion_time);
+
+			//printf("Cycle: %10lld, Writes Completed = %5lld, this_latency= %5lld, latency = %f\n", CYCLE_VAL, stats_writes_completed[channel][vault], request->latency, stats_average_write_latency[channel][vault]);	
+
+
+			for(int i=0; i<sim->NUM_RANKS[channel] ;i++)
+			{
+				if(i!=rank)
+					sim->stats_time_spent_terminating_writes_to_other_ranks[channel][vault][i] += sim->T_DATA_TRANS[channel];
+			}
+
+			remove_from_bank_bucket(sim, request);
+			mark_vault_dirty(sim, channel, vault);
+
+			sim->command_issued_current_cycle[channel][vault] = 1;
+			sim->cas_issued_current_cycle[channel][vault][rank][bank] = 2;
+			break;
+
+		case PRE_CMD :
+
+			assert(sim->dram_state[channel][vault][rank][bank].state == ROW_ACTIVE || sim->dram_state[channel][vault][rank][bank].state == PRECHARGING || sim->dram_state[channel][vault][rank][bank].state == IDLE || sim->dram_state[channel][vault][rank][bank].state ==  REFRESHING) ;
+
+			//UT_MEM_DEBUG("\nCycle: %lld Cmd:PRE Req:%lld Chan:%d Rank:%d Bank:%d \n", CYCLE_VAL, request->id, channel, vault, rank, bank);
+
+			credit_rank_state(sim, channel, vault, rank);
+
+			sim->dram_state[channel][vault][rank][bank].state = PRECHARGING ;
+
+			sim->dram_state[channel][vault][rank][bank].active_row = -1;
+
+			sim->dram_state[channel][vault][rank][bank].next_act = max(cycle+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_act);
+
+			sim->dram_state[channel][vault][rank][bank].next_powerdown = max(cycle+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+			sim->dram_state[channel][vault][rank][bank].next_pre = max(cycle+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+
+			sim->dram_state[channel][vault][rank][bank].next_refresh = max(cycle+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+			sim->stats_num_precharge[channel][vault][rank][bank] ++;
+
+			mark_bank_dirty(sim, channel, vault, rank, bank);
+
+			sim->command_issued_current_cycle[channel][vault] = 1;
+
+			break;
+
+		case PWR_UP_CMD :
+
+			assert(sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_SLOW || sim->dram_state[channel][vault][rank][bank].state == PRECHARGE_POWER_DOWN_FAST || sim->dram_state[channel][vault][rank][bank].state == ACTIVE_POWER_DOWN) ;
+
+			//UT_MEM_DEBUG("\nCycle: %lld Cmd: PWR_UP_CMD Chan:%d Rank:%d \n", CYCLE_VAL, channel, vault, rank);
+
+			credit_rank_state(sim, channel, vault, rank);
+
+			for(int i=0; i<sim->NUM_BANKS[channel] ; i++)
+			{
+
+				if(sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW || sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_FAST)
+				{
+					sim->dram_state[channel][vault][rank][i].state = IDLE;
+					sim->dram_state[channel][vault][rank][i].active_row = -1;
+				}
+				else
+				{
+					sim->dram_state[channel][vault][rank][i].state = ROW_ACTIVE;
+				}
+
+				if(sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW)
+				{
+					sim->dram_state[channel][vault][rank][i].next_powerdown = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_powerdown);
+
+					sim->dram_state[channel][vault][rank][i].next_pre= max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_pre);
+
+					sim->dram_state[channel][vault][rank][i].next_read = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_read);
+
+					sim->dram_state[channel][vault][rank][i].next_write = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_write);
+
+					sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_act);
+
+					sim->dram_state[channel][vault][rank][i].next_refresh = max(cycle + sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_refresh);
+				}
+				else
+				{
+
+					sim->dram_state[channel][vault][rank][i].next_powerdown = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_powerdown);
+
+					sim->dram_state[channel][vault][rank][i].next_pre= max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_pre);
+
+					sim->dram_state[channel][vault][rank][i].next_read = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_read);
+
+					sim->dram_state[channel][vault][rank][i].next_write = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_write);
+
+					sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_act);
+					
+					sim->dram_state[channel][vault][rank][i].next_refresh = max(cycle + sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_refresh);
+				}
+			}
+
+			sim->stats_num_powerup[channel][vault][rank]++;
+			mark_rank_dirty(sim, channel, vault, rank);
+			sim->command_issued_current_cycle[channel][vault] =1;
+
+			break ;
+		case NOP :
+
+			//UT_MEM_DEBUG("\nCycle: %lld Cmd: NOP Chan:%d\n", CYCLE_VAL, channel);
+			break;
+
+		default :
+			break;
+	}
+	return 1;
+}
+
+int are_all_writes_completed(usimm_sim_t * sim)
+{
+	for(int channel=0; channel<sim->NUM_CHANNELS; channel++)
+	{
+		if(channel<sim->NUM_HMCS) {
+			for(int core=0; core<sim->NUMCORES; core++) {
+				if(sim->write_queue_length_for_core[core][channel])
+					return 0;
+			}
+		}
+		for(int vault=0; vault<sim->NUM_VAULTS[channel]; vault++)
+		{
+				if(sim->write_queue_length[channel][vault])
+					return 0;
+		}
+	}
+	
+	return 1;
+}
+
+// Function called to see if the rank can be transitioned into a fast low
+// power state - ACT_PDN or PRE_PDN_FAST. 
+int is_powerdown_fast_allowed(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	int flag =0;
+
+	// if already a command has been issued this cycle, or if
+	// forced refreshes are underway, or if issuing this command
+	// will cause us to miss the refresh deadline, do not allow it
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank] || (sim->CYCLE_VAL +sim->T_PD_MIN[channel] + sim->T_XP[channel] > sim->refresh_issue_deadline[channel][vault][rank])) 
+	  return 0;
+
+	// command can be allowed if the next_powerdown is met for all banks in the rank
+	for(int i =0; i < sim->NUM_BANKS[channel] ; i++)
+	{
+	  if((sim->dram_state[channel][vault][rank][i].state == PRECHARGING || sim->dram_state[channel][vault][rank][i].state == ROW_ACTIVE || sim->dram_state[channel][vault][rank][i].state == IDLE || sim->dram_state[channel][vault][rank][i].state == REFRESHING) && sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][i].next_powerdown)
+	    flag = 1;
+	  else
+	    return 0;
+	}
+
+	return flag;
+}
+
+// Function to see if the rank can be transitioned into a slow low
+// power state - i.e. PRE_PDN_SLOW
+int is_powerdown_slow_allowed(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	int flag =0;
+
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank] || (sim->CYCLE_VAL +sim->T_PD_MIN[channel]+sim->T_XP_DLL[channel] > sim->refresh_issue_deadline[channel][vault][rank])) 
+	  return 0;
+
+	// Sleep command can be allowed if the next_powerdown is met for all banks in the rank
+	// and if all the banks are precharged
+	for(int i =0; i < sim->NUM_BANKS[channel] ; i++)
+	{
+	  if(sim->dram_state[channel][vault][rank][i].state == ROW_ACTIVE)
+	    return 0;
+	  else
+	  {
+	    if((sim->dram_state[channel][vault][rank][i].state == PRECHARGING || sim->dram_state[channel][vault][rank][i].state == IDLE || sim->dram_state[channel][vault][rank][i].state == REFRESHING) && sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][i].next_powerdown)
+	      flag = 1;
+	    else
+	      return 0;
+	  }
+	}
+	return flag;
+}
+
+// Function to see if the rank can be powered up
+int is_powerup_allowed(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank])
+	  return 0;
+
+	if(((sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW) ||(sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST) || (sim->dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)) && (sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][0].next_powerup))
+	{
+	  // check if issuing it will cause us to miss the refresh
+	  // deadline. If it does, don't allow it. The forced
+	  // refreshes will issue an implicit power up anyway
+		if((sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW) && ((sim->CYCLE_VAL + sim->T_XP_DLL[channel]) > sim->refresh_issue_deadline[channel][vault][0]))
+			return 0;
+		if(((sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST) || (sim->dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)) && (( sim->CYCLE_VAL +sim->T_XP[channel]) > sim->refresh_issue_deadline[channel][vault][0]))
+			return 0;
+		return 1;
+	}
+	else
+		return 0;
+}
+
+// Function to see if the bank can be activated or not
+int is_activate_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank] || (sim->CYCLE_VAL + sim->T_RAS[channel] > sim->refresh_issue_deadline[channel][vault][rank])) 
+	  return 0;
+	if ((sim->dram_state[channel][vault][rank][bank].state == IDLE || sim->dram_state[channel][vault][rank][bank].state == PRECHARGING || sim->dram_state[channel][vault][rank][bank].state == REFRESHING) && (sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_act) && (is_T_FAW_met(sim, channel,vault,rank,sim->CYCLE_VAL)))
+	  return 1;
+	else 
+	  return 0;
+}
+
+// Function to see if the rank can be precharged or not
+int is_autoprecharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+  long long int start_precharge = 0;
+  if(sim->cas_issued_current_cycle[channel][vault][rank][bank] == 1)
+    start_precharge = max(sim->CYCLE_VAL + sim->T_RTP[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+  else
+    start_precharge = max(sim->CYCLE_VAL + sim->T_CWD[channel] + sim->T_DATA_TRANS[channel] + sim->T_WR[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+  
+  if(((sim->cas_issued_current_cycle[channel][vault][rank][bank] == 1) && ((start_precharge+sim->T_RP[channel]) <= sim->refresh_issue_deadline[channel][vault][rank])) ||((sim->cas_issued_current_cycle[channel][vault][rank][bank] == 2)&& ((start_precharge+sim->T_RP[channel]) <= sim->refresh_issue_deadline[channel][vault][rank])))
+    return 1;
+  else
+    return 0;
+}
+
+
+// Function to see if the rank can be precharged or not
+int is_precharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank] || (sim->CYCLE_VAL + sim->T_RP[channel] > sim->refresh_issue_deadline[channel][vault][rank])) 
+	    return 0;
+
+	if((sim->dram_state[channel][vault][rank][bank].state == ROW_ACTIVE || sim->dram_state[channel][vault][rank][bank].state == IDLE || sim->dram_state[channel][vault][rank][bank].state == PRECHARGING || sim->dram_state[channel][vault][rank][bank].state ==  REFRESHING) && ( sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][bank].next_pre))
+	  return 1;
+	else
+	  return 0;
+}
+
+
+// function to see if all banks can be precharged this cycle
+int is_all_bank_precharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+  	int flag = 0;
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank] || (sim->CYCLE_VAL + sim->T_RP[channel] > sim->refresh_issue_deadline[channel][vault][rank])) 
+	  return 0;
+
+	for(int i =0; i<sim->NUM_BANKS[channel] ;i++)
+	{
+	  if((sim->dram_state[channel][vault][rank][i].state == ROW_ACTIVE || sim->dram_state[channel][vault][rank][i].state == IDLE || sim->dram_state[channel][vault][rank][i].state == PRECHARGING || sim->dram_state[channel][vault][rank][i].state ==  REFRESHING) && ( sim->CYCLE_VAL >= sim->dram_state[channel][vault][rank][i].next_pre))
+	    flag = 1;
+	  else
+	    return 0;
+	}
+	return flag;
+}
+
+// function to see if refresh can be allowed this cycle
+
+int is_refresh_allowed(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	if (sim->command_issued_current_cycle[channel][vault] || sim->forced_refresh_mode_on[channel][vault][rank]) 
+	  return 0;
+
+	for(int b=0; b< sim->NUM_BANKS[channel]; b++)
+	{
+		if(sim->CYCLE_VAL < sim->dram_state[channel][vault][rank][b].next_refresh)
+			return 0;
+	}
+	return 1;
+}
+
+// Function to put a rank into the low power mode
+int issue_powerdown_command(usimm_sim_t * sim, int channel, int vault, int rank, command_t cmd)
+{
+	if(sim->command_issued_current_cycle[channel][vault]) {
+		fprintf(sim->out, "PANIC : SCHED_ERROR: Got beat. POWER_DOWN command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+
+	// if right CMD has been used
+	if ((cmd != PWR_DN_FAST_CMD) && (cmd != PWR_DN_SLOW_CMD)) {
+		fprintf(sim->out, "PANIC: SCHED_ERROR : Only PWR_DN_SLOW_CMD or PWR_DN_FAST_CMD can be used to put DRAM rank to sleep\n");
+		return 0;
+	}
+	// if the powerdown command can indeed be issued
+	if(((cmd == PWR_DN_FAST_CMD) && !is_powerdown_fast_allowed(sim, channel, vault, rank)) || ((cmd == PWR_DN_SLOW_CMD) && !is_powerdown_slow_allowed(sim, channel, vault, rank))) {
+		fprintf(sim->out, "PANIC : SCHED_ERROR: POWER_DOWN command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+
+	credit_rank_state(sim, channel, vault, rank);
+
+	for(int i=0; i<sim->NUM_BANKS[channel] ; i++)
+	{
+	        // next_powerup and refresh times
+		sim->dram_state[channel][vault][rank][i].next_powerup = max(sim->CYCLE_VAL+sim->T_PD_MIN[channel], sim->dram_state[channel][vault][rank][i].next_powerdown);
+		sim->dram_state[channel][vault][rank][i].next_refresh = max(sim->CYCLE_VAL+sim->T_PD_MIN[channel], sim->dram_state[channel][vault][rank][i].next_refresh);
+		
+		// state change
+		if(sim->dram_state[channel][vault][rank][i].state == IDLE || sim->dram_state[channel][vault][rank][i].state == PRECHARGING || sim->dram_state[channel][vault][rank][i].state == REFRESHING)
+		{
+			if(cmd == PWR_DN_SLOW_CMD)
+			{
+				sim->dram_state[channel][vault][rank][i].state= PRECHARGE_POWER_DOWN_SLOW;
+				sim->stats_num_powerdown_slow[channel][vault][rank]++;
+			}
+			else if(cmd == PWR_DN_FAST_CMD)
+			{
+				sim->dram_state[channel][vault][rank][i].state = PRECHARGE_POWER_DOWN_FAST;
+				sim->stats_num_powerdown_fast[channel][vault][rank]++;
+			}
+
+			sim->dram_state[channel][vault][rank][i].active_row = -1;
+		}
+		else if(sim->dram_state[channel][vault][rank][i].state == ROW_ACTIVE)
+		{
+			sim->dram_state[channel][vault][rank][i].state = ACTIVE_POWER_DOWN;
+		}
+	}
+	mark_rank_dirty(sim, channel, vault, rank);
+	sim->command_issued_current_cycle[channel][vault] = 1;
+	return 1;
+}
+
+
+// Function to power a rank up
+int issue_powerup_command(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	if(!is_powerup_allowed(sim, channel, vault, rank)) 
+	{
+		fprintf(sim->out, "PANIC : SCHED_ERROR: POWER_UP command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+	else
+	{
+		long long int cycle =  sim->CYCLE_VAL;
+		credit_rank_state(sim, channel, vault, rank);
+		for(int i=0; i<sim->NUM_BANKS[channel] ; i++)
+		{
+
+			if(sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW || sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_FAST)
+			{
+				sim->dram_state[channel][vault][rank][i].state = IDLE;
+				sim->dram_state[channel][vault][rank][i].active_row = -1;
+			}
+			else
+			{
+				sim->dram_state[channel][vault][rank][i].state = ROW_ACTIVE;
+			}
+
+			if(sim->dram_state[channel][vault][rank][i].state == PRECHARGE_POWER_DOWN_SLOW)
+			{
+				sim->dram_state[channel][vault][rank][i].next_powerdown = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_powerdown);
+
+				sim->dram_state[channel][vault][rank][i].next_pre= max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_pre);
+
+				sim->dram_state[channel][vault][rank][i].next_read = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_read);
+
+				sim->dram_state[channel][vault][rank][i].next_write = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_write);
+
+				sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_act);
+
+				sim->dram_state[channel][vault][rank][i].next_refresh = max(cycle + sim->T_XP_DLL[channel], sim->dram_state[channel][vault][rank][i].next_refresh);
+			}
+			else
+			{
+
+				sim->dram_state[channel][vault][rank][i].next_powerdown = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_powerdown);
+
+				sim->dram_state[channel][vault][rank][i].next_pre= max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_pre);
+
+				sim->dram_state[channel][vault][rank][i].next_read = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_read);
+
+				sim->dram_state[channel][vault][rank][i].next_write = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_write);
+
+				sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_act);
+
+				sim->dram_state[channel][vault][rank][i].next_refresh = max(cycle + sim->T_XP[channel], sim->dram_state[channel][vault][rank][i].next_refresh);
+			}
+		}
+
+		mark_rank_dirty(sim, channel, vault, rank);
+		sim->command_issued_current_cycle[channel][vault] = 1;
+		return 1;
+
+	}
+}
+
+// Function to issue a precharge command to a specific bank
+int issue_autoprecharge(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+  if(!is_autoprecharge_allowed(sim, channel,vault,rank,bank))
+    return 0;
+  else
+  {
+    long long int start_precharge = 0;
+
+    credit_rank_state(sim, channel, vault, rank);
+
+    sim->dram_state[channel][vault][rank][bank].active_row = -1;
+
+    sim->dram_state[channel][vault][rank][bank].state = PRECHARGING;
+
+    if(sim->cas_issued_current_cycle[channel][vault][rank][bank] == 1)
+      start_precharge = max(sim->CYCLE_VAL + sim->T_RTP[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+    else
+      start_precharge = max(sim->CYCLE_VAL + sim->T_CWD[channel] + sim->T_DATA_TRANS[channel] + sim->T_WR[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+
+    sim->dram_state[channel][vault][rank][bank].next_act = max(start_precharge + sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_act);
+
+    sim->dram_state[channel][vault][rank][bank].next_powerdown = max(start_precharge + sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+    sim->dram_state[channel][vault][rank][bank].next_pre = max(start_precharge + sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+
+    sim->dram_state[channel][vault][rank][bank].next_refresh = max(start_precharge + sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+    sim->stats_num_precharge[channel][vault][rank][bank] ++;
+
+    mark_bank_dirty(sim, channel, vault, rank, bank);
+
+    // reset the cas_issued_current_cycle 
+    for(int r = 0; r < sim->NUM_RANKS[channel] ; r++)
+      for(int b = 0; b < sim->NUM_BANKS[channel] ; b++)
+	sim->cas_issued_current_cycle[channel][vault][r][b]=0;
+	  
+
+    return 1;
+  }
+}
+
+// Function to issue an activate command to a specific row
+int issue_activate_command(usimm_sim_t * sim, int channel, int vault, int rank, int bank, long long int row)
+{
+  if(!is_activate_allowed(sim, channel, vault, rank, bank))
+  {
+		fprintf(sim->out, "PANIC : SCHED_ERROR: ACTIVATE command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+  }
+  else
+  {
+    long long int cycle = sim->CYCLE_VAL;
+
+    credit_rank_state(sim, channel, vault, rank);
+    charge_command_energy(sim, channel, vault, rank, ACT_CMD);
+
+    sim->dram_state[channel][vault][rank][bank].state = ROW_ACTIVE;
+
+    sim->dram_state[channel][vault][rank][bank].active_row = row;
+
+    sim->dram_state[channel][vault][rank][bank].next_pre = max((cycle + sim->T_RAS[channel]) , sim->dram_state[channel][vault][rank][bank].next_pre);
+
+    sim->dram_state[channel][vault][rank][bank].next_refresh = max((cycle + sim->T_RAS[channel]) , sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+    sim->dram_state[channel][vault][rank][bank].next_read = max(cycle + sim->T_RCD[channel], sim->dram_state[channel][vault][rank][bank].next_read); 
+
+    sim->dram_state[channel][vault][rank][bank].next_write = max(cycle + sim->T_RCD[channel],  sim->dram_state[channel][vault][rank][bank].next_write);
+
+    sim->dram_state[channel][vault][rank][bank].next_act = max(cycle + sim->T_RC[channel],  sim->dram_state[channel][vault][rank][bank].next_act);
+
+    sim->dram_state[channel][vault][rank][bank].next_powerdown = max(cycle + sim->T_RCD[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+    for(int i=0;i<sim->NUM_BANKS[channel];i++)
+      if(i!=bank)
+	sim->dram_state[channel][vault][rank][i].next_act = max(cycle+sim->T_RRD[channel], sim->dram_state[channel][vault][rank][i].next_act);
+
+    record_activate(sim, channel, vault, rank, cycle);
+
+    sim->stats_num_activate[channel][vault][rank]++;
+    sim->stats_num_activate_spec[channel][vault][rank][bank]++;
+
+    sim->average_gap_between_activates[channel][vault][rank] = ((sim->average_gap_between_activates[channel][vault][rank]*(sim->stats_num_activate[channel][vault][rank]-1)) + (sim->CYCLE_VAL-sim->last_activate[channel][vault][rank]))/sim->stats_num_activate[channel][vault][rank];
+
+    sim->last_activate[channel][vault][rank] = sim->CYCLE_VAL;
+
+    // next_act of every bank and the T_FAW window of the rank moved
+    mark_rank_dirty(sim, channel, vault, rank);
+
+    sim->command_issued_current_cycle[channel][vault] = 1;
+
+    return 1;
+
+  }
+}
+
+// Function to issue a precharge command to a specific bank
+int issue_precharge_command(usimm_sim_t * sim, int channel, int vault, int rank, int bank)
+{
+	if(!is_precharge_allowed(sim, channel, vault, rank, bank))
+	{
+		fprintf(sim->out, "PANIC : SCHED_ERROR: PRECHARGE command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+	else
+	{
+		credit_rank_state(sim, channel, vault, rank);
+
+		sim->dram_state[channel][vault][rank][bank].state = PRECHARGING;
+
+		sim->dram_state[channel][vault][rank][bank].active_row = -1;
+
+		sim->dram_state[channel][vault][rank][bank].next_act = max(sim->CYCLE_VAL+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_act);
+		
+		sim->dram_state[channel][vault][rank][bank].next_powerdown = max(sim->CYCLE_VAL+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_powerdown);
+
+		sim->dram_state[channel][vault][rank][bank].next_pre = max(sim->CYCLE_VAL+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_pre);
+		
+		sim->dram_state[channel][vault][rank][bank].next_refresh = max(sim->CYCLE_VAL+sim->T_RP[channel], sim->dram_state[channel][vault][rank][bank].next_refresh);
+
+		sim->stats_num_precharge[channel][vault][rank][bank]++;
+
+		mark_bank_dirty(sim, channel, vault, rank, bank);
+		
+		sim->command_issued_current_cycle[channel][vault] = 1;
+		
+		return 1;
+	}
+}
+
+// Function to precharge a rank
+int issue_all_bank_precharge_command(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	if(!is_all_bank_precharge_allowed(sim, channel, vault, rank))
+	{
+		fprintf(sim->out, "PANIC : SCHED_ERROR: ALL_BANK_PRECHARGE command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+	else
+	{
+		for(int i =0;i<sim->NUM_BANKS[channel]; i++)
+		{
+			issue_precharge_command(sim, channel, vault, rank, i);
+			sim->command_issued_current_cycle[channel][vault] = 0; /* Since issue_precharge_command would have set this, we need to reset it. */
+		}
+		sim->command_issued_current_cycle[channel][vault] = 1;
+		return 1;
+	}
+}
+
+// Function to issue a refresh
+int issue_refresh_command(usimm_sim_t * sim, int channel,int vault, int rank)
+{
+
+	if(!is_refresh_allowed(sim, channel, vault, rank))
+	{
+		fprintf(sim->out, "PANIC : SCHED_ERROR: REFRESH command not issuable in cycle:%lld\n", sim->CYCLE_VAL);
+		return 0;
+	}
+	else
+	{
+		sim->num_issued_refreshes[channel][vault][rank]++;
+		credit_rank_state(sim, channel, vault, rank);
+		charge_command_energy(sim, channel, vault, rank, REF_CMD);
+		long long int cycle = sim->CYCLE_VAL;
+
+		if(sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_SLOW)
+		{
+		  for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		  {
+		    sim->dram_state[channel][vault][rank][b].next_act = max(cycle + sim->T_XP_DLL[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_act);
+		    sim->dram_state[channel][vault][rank][b].next_pre = max(cycle + sim->T_XP_DLL[channel]  + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_pre);
+		    sim->dram_state[channel][vault][rank][b].next_refresh = max(cycle + sim->T_XP_DLL[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_refresh);
+		    sim->dram_state[channel][vault][rank][b].next_powerdown = max(cycle + sim->T_XP_DLL[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_powerdown);
+		  }
+		}
+		else if(sim->dram_state[channel][vault][rank][0].state == PRECHARGE_POWER_DOWN_FAST)
+		{
+		  for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		  {
+					sim->dram_state[channel][vault][rank][b].next_act = max(cycle + sim->T_XP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_act);
+					sim->dram_state[channel][vault][rank][b].next_pre = max(cycle + sim->T_XP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_pre);
+					sim->dram_state[channel][vault][rank][b].next_refresh = max(cycle + sim->T_XP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_refresh);
+					sim->dram_state[channel][vault][rank][b].next_powerdown = max(cycle + sim->T_XP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_powerdown);
+		  }
+		}
+		else if(sim->dram_state[channel][vault][rank][0].state == ACTIVE_POWER_DOWN)
+		{
+		  for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		  {
+		    sim->dram_state[channel][vault][rank][b].next_act = max(cycle + sim->T_XP[channel] + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_act);
+		    sim->dram_state[channel][vault][rank][b].next_pre = max(cycle + sim->T_XP[channel] + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_pre);
+		    sim->dram_state[channel][vault][rank][b].next_refresh = max(cycle + sim->T_XP[channel] + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_refresh);
+		    sim->dram_state[channel][vault][rank][b].next_powerdown = max(cycle + sim->T_XP[channel] + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_powerdown);
+		  }
+		}
+		else // rank powered up
+		{
+		  int flag = 0;
+		  for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		  {
+		    if(sim->dram_state[channel][vault][rank][b].state == ROW_ACTIVE)
+		    {
+		      flag =1;
+		      break;
+		    }
+		  }
+		  if(flag) // at least a single bank is open
+		  {
+		    for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		    {
+		      sim->dram_state[channel][vault][rank][b].next_act = max(cycle + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_act);
+		      sim->dram_state[channel][vault][rank][b].next_pre = max(cycle + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_pre);
+		      sim->dram_state[channel][vault][rank][b].next_refresh = max(cycle + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_refresh);
+		      sim->dram_state[channel][vault][rank][b].next_powerdown = max(cycle + sim->T_RP[channel] + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_powerdown);
+		    }
+		  }
+		  else // everything precharged
+		  {
+		    for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		    {
+		    sim->dram_state[channel][vault][rank][b].next_act = max(cycle + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_act);
+		    sim->dram_state[channel][vault][rank][b].next_pre = max(cycle + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_pre);
+		    sim->dram_state[channel][vault][rank][b].next_refresh = max(cycle + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_refresh);
+		    sim->dram_state[channel][vault][rank][b].next_powerdown = max(cycle + sim->T_RFC[channel], sim->dram_state[channel][vault][rank][b].next_powerdown);
+		    }
+		  }
+
+		}
+		for(int b=0; b<sim->NUM_BANKS[channel] ; b++)
+		{
+			sim->dram_state[channel][vault][rank][b].active_row = -1;
+			sim->dram_state[channel][vault][rank][b].state = REFRESHING;
+		}
+		mark_rank_dirty(sim, channel, vault, rank);
+		sim->command_issued_current_cycle[channel][vault] = 1;
+		return 1;
+	}
+}
+
+void issue_forced_refresh_commands(usimm_sim_t * sim, int channel, int vault, int rank)
+{
+	credit_rank_state(sim, channel, vault, rank);
+	// the refreshes still due in this refresh window
+	for(int i=sim->num_issued_refreshes[channel][vault][rank]; i<8; i++)
+		charge_command_energy(sim, channel, vault, rank, REF_CMD);
+
+	for(int b=0; b < sim->NUM_BANKS[channel]; b++)
+	{
+
+		sim->dram_state[channel][vault][rank][b].state = REFRESHING;
+		sim->dram_state[channel][vault][rank][b].active_row = -1;
+
+		sim->dram_state[channel][vault][rank][b].next_act = sim->next_refresh_completion_deadline[channel][vault][rank];
+		sim->dram_state[channel][vault][rank][b].next_pre = sim->next_refresh_completion_deadline[channel][vault][rank];
+		sim->dram_state[channel][vault][rank][b].next_refresh = sim->next_refresh_completion_deadline[channel][vault][rank];
+		sim->dram_state[channel][vault][rank][b].next_powerdown = sim->next_refresh_completion_deadline[channel][vault][rank];
+	}
+	mark_rank_dirty(sim, channel, vault, rank);
+}
+
+
+// Latency percentiles per channel, vault (totals only) and core
+static void print_latency_percentiles(usimm_sim_t * sim)
+{
+	fprintf(sim->out, "\n#-------------------------------------- Latency Percentiles --------------------------------------\n");
+	fprintf(sim->out, "%-16s %10s %9s %9s %9s %9s %9s\n", "Latency (cycles)", "Count", "p50", "p90", "p99", "p99.9", "Max");
+	for(int c=0; c<sim->NUM_CHANNELS; c++)
+	{
+		fprintf(sim->out, "Channel %d\n", c);
+		print_latency_stats(sim->out, &sim->channel_latency[c], "  ");
+		if(sim->NUM_VAULTS[c] > 1)
+		{
+			for(int v=0; v<sim->NUM_VAULTS[c]; v++)
+			{
+				fprintf(sim->out, "  Vault %d\n", v);
+				print_latency_line(sim->out, "    ", "read", &sim->vault_read_latency[c][v]);
+				print_latency_line(sim->out, "    ", "write", &sim->vault_write_latency[c][v]);
+			}
+		}
+	}
+	for(int numc=0; numc<sim->NUMCORES; numc++)
+	{
+		fprintf(sim->out, "Core %d\n", numc);
+		print_latency_stats(sim->out, &sim->core_latency[numc], "  ");
+	}
+	fprintf(sim->out, "#-------------------------------------------------------------------------------------------------\n");
+}
+
+void print_stats(usimm_sim_t * sim)
+{
+	long long int activates_for_reads = 0;
+	long long int activates_for_spec = 0;
+	long long int activates_for_writes = 0;
+	long long int read_cmds = 0;
+	long long int write_cmds = 0;
+	long long int hmc_read_cmds = 0;
+	long long int hmc_write_cmds = 0;
+	long long int total_read_cmds = 0;
+	long long int total_write_cmds = 0;
+
+	for(int c=0 ; c < sim->NUM_CHANNELS ; c++)
+	{
+		hmc_read_cmds = 0;
+		hmc_write_cmds = 0;
+		for(int v=0; v < sim->NUM_VAULTS[c]; v++) {
+			
+			activates_for_writes = 0;
+			activates_for_reads = 0;
+			activates_for_spec = 0;
+			read_cmds = 0;
+			write_cmds = 0;
+			for(int r=0;r<sim->NUM_RANKS[c] ;r++)
+			{
+				for(int b=0; b<sim->NUM_BANKS[c] ; b++)
+				{
+					activates_for_writes += sim->stats_num_activate_write[c][v][r][b];
+					activates_for_reads += sim->stats_num_activate_read[c][v][r][b];
+					activates_for_spec += sim->stats_num_activate_spec[c][v][r][b];
+					read_cmds += sim->stats_num_read[c][v][r][b];
+					write_cmds += sim->stats_num_write[c][v][r][b];
+				}
+			}
+			
+			if(sim->NUM_VAULTS[c] > 1) {
+				fprintf(sim->out, "-------- Vault %d Stats-----------\n",c);
+				hmc_read_cmds += read_cmds;
+				hmc_write_cmds += write_cmds;
+			}
+			else
+				fprintf(sim->out, "-------- Channel %d Stats-----------\n",c);
+			fprintf(sim->out, "Total Reads Serviced :          %-7lld\n", sim->stats_reads_completed[c][v]);
+			fprintf(sim->out, "Total Writes Serviced :         %-7lld\n", sim->stats_writes_completed[c][v]);
+			fprintf(sim->out, "Average Read Latency :          %7.5f\n", (double)sim->stats_average_read_latency[c][v]);
+			fprintf(sim->out, "Average Read Queue Latency :    %7.5f\n", (double)sim->stats_average_read_queue_latency[c][v]);
+			fprintf(sim->out, "Average Write Latency :         %7.5f\n", (double)sim->stats_average_write_latency[c][v]);
+			fprintf(sim->out, "Average Write Queue Latency :   %7.5f\n", (double)sim->stats_average_write_queue_latency[c][v]);
+			fprintf(sim->out, "Read Page Hit Rate :            %7.5f\n",((double)(read_cmds-activates_for_reads-activates_for_spec)/read_cmds));
+			fprintf(sim->out, "Write Page Hit Rate :           %7.5f\n",((double)(write_cmds-activates_for_writes)/write_cmds));
+			fprintf(sim->out, "------------------------------------\n");
+			
+			total_read_cmds += read_cmds;
+			total_write_cmds += write_cmds;
+		}
+		fprintf(sim->out, "------------------------------------\n");
+		fprintf(sim->out, "Total Reads Served for HMC %d :            %lld\n", c , hmc_read_cmds);
+		fprintf(sim->out, "Total Writes Served for HMC %d :           %lld\n", c , hmc_write_cmds);
+		fprintf(sim->out, "------------------------------------\n");	
+	}
+	fprintf(sim->out, "------------------------------------\n");
+	fprintf(sim->out, "Total Reads Served :            %lld\n", total_read_cmds );
+	fprintf(sim->out, "Total Writes Served :           %lld\n", total_write_cmds);
+	fprintf(sim->out, "------------------------------------\n");
+
+	print_latency_percentiles(sim);
+}
+
+void update_issuable_commands(usimm_sim_t * sim, int channel, int vault)
+{
+	for(int rank = 0; rank < sim->NUM_RANKS[channel]; rank++)
+	{
+		for(int bank = 0; bank < sim->NUM_BANKS[channel] ; bank++)
+			sim->cmd_precharge_issuable[channel][vault][rank][bank] = is_precharge_allowed(sim, channel, vault, rank, bank);
+
+		sim->cmd_all_bank_precharge_issuable[channel][vault][rank] = is_all_bank_precharge_allowed(sim, channel, vault, rank) ;
+		
+		sim->cmd_powerdown_fast_issuable[channel][vault][rank] =  is_powerdown_fast_allowed(sim, channel, vault, rank);
+
+		sim->cmd_powerdown_slow_issuable[channel][vault][rank] =  is_powerdown_slow_allowed(sim, channel, vault, rank);
+
+		sim->cmd_refresh_issuable[channel][vault][rank] = is_refresh_allowed(sim, channel, vault, rank);
+
+		sim->cmd_powerup_issuable[channel][vault][rank] = is_powerup_allowed(sim, channel, vault, rank);
+	}
+}
+
+// function that updates the dram state of a vault and schedules
+// auto-refresh if necessary. This is called every DRAM cycle. Vaults
+// share no state while they are updated, so the vaults of a channel
+// may be updated in any order or concurrently.
+void update_vault(usimm_sim_t * sim, int channel, int vault)
+{
+        // make every channel ready to receive a new command
+  	sim->command_issued_current_cycle[channel][vault] = 0;
+	for(int rank =0;rank<sim->NUM_RANKS[channel] ; rank++)
+	{
+		//reset variable
+	    for(int bank=0; bank<sim->NUM_BANKS[channel]; bank++)
+			sim->cas_issued_current_cycle[channel][vault][rank][bank] = 0;
+
+		// if we are at the refresh completion
+		// deadline
+		if(sim->CYCLE_VAL == sim->next_refresh_completion_deadline[channel][vault][rank])
+		{
+		  	// calculate the next
+			// refresh_issue_deadline
+			sim->num_issued_refreshes[channel][vault][rank] = 0;
+			sim->last_refresh_completion_deadline[channel][vault][rank] = sim->CYCLE_VAL;
+			sim->next_refresh_completion_deadline[channel][vault][rank] = sim->CYCLE_VAL + 8 * sim->T_REFI[channel];
+			sim->refresh_issue_deadline[channel][vault][rank] = sim->next_refresh_completion_deadline[channel][vault][rank] - sim->T_RP[channel] - 8 * sim->T_RFC[channel];
+			sim->forced_refresh_mode_on[channel][vault][rank] = 0;
+			sim->issued_forced_refresh_commands[channel][vault][rank] = 0;
+			mark_rank_dirty(sim, channel, vault, rank);
+		}
+		else if((sim->CYCLE_VAL == sim->refresh_issue_deadline[channel][vault][rank]) && (sim->num_issued_refreshes[channel][vault][rank] < 8))
+		{
+		    // refresh_issue_deadline has been
+			// reached. Do the auto-refreshes
+			sim->forced_refresh_mode_on[channel][vault][rank] = 1;
+			issue_forced_refresh_commands(sim, channel, vault, rank);
+		}
+		else if(sim->CYCLE_VAL < sim->refresh_issue_deadline[channel][vault][rank])
+		{
+			//update the refresh_issue deadline
+			long long int deadline = sim->next_refresh_completion_deadline[channel][vault][rank] - sim->T_RP[channel] - (8-sim->num_issued_refreshes[channel][vault][rank]) * sim->T_RFC[channel];
+			if(deadline != sim->refresh_issue_deadline[channel][vault][rank])
+			{
+				sim->refresh_issue_deadline[channel][vault][rank] = deadline;
+				mark_rank_dirty(sim, channel, vault, rank);
+			}
+		}
+
+	}
+
+	// update the variables corresponding to the non-queue
+	// variables
+	update_issuable_commands(sim, channel, vault);
+	
+	// update the request cmds in the queues
+	update_read_queue_commands(sim, channel, vault);
+
+	update_write_queue_commands(sim, channel, vault);
+	
+	update_read_return_queue(sim, channel, vault);
+	
+	// remove finished requests
+	clean_queues(sim, channel, vault);
+}
+
+
+
+/********************************************************/
+/*	Idle fast-forward				*/
+/********************************************************/
+
+// fold an event at the given cycle into the earliest event seen so far;
+// events at or before 'since' have already been acted upon
+static void note_event(long long int * next, long long int event, long long int since)
+{
+	if(event > since && (*next < 0 || event < *next))
+		*next = event;
+}
+
+// Earliest cycle after 'since' (the last simulated cycle) at which
+// update_vault() or schedule() could change the state of this channel,
+// assuming no new requests arrive. Returns since+1 if the channel may
+// have work on its very next cycle. A cycle is only uneventful if no
+// command was issued in it: every later change is then triggered by a
+// request arriving, a read completing, a refresh deadline, or a bank
+// or tFAW timing constraint expiring.
+long long int next_memory_event(usimm_sim_t * sim, int channel, long long int since)
+{
+	long long int next = -1;
+	request_t * ptr = NULL;
+
+	for(int vault=0; vault<sim->NUM_VAULTS[channel]; vault++)
+	{
+		if(sim->command_issued_current_cycle[channel][vault])
+			return since+1;
+
+		// responses already sent to the processor are removed next cycle
+		LL_FOREACH(sim->read_return_queue_head[channel][vault], ptr)
+		{
+			if(ptr->request_served == 2)
+				return since+1;
+		}
+
+		LL_FOREACH(sim->read_queue_head[channel][vault], ptr)
+		{
+			if(ptr->request_served)
+			{
+				if(channel >= sim->NUM_HMCS)
+					return since+1;
+				note_event(&next, max(ptr->completion_time, since+1), since);
+			}
+			else if(ptr->next_command == NOP) // not yet seen by update_vault
+				return since+1;
+			else
+				note_event(&next, ptr->arrival_time, since);
+		}
+
+		LL_FOREACH(sim->write_queue_head[channel][vault], ptr)
+		{
+			if(ptr->request_served || ptr->next_command == NOP)
+				return since+1;
+			note_event(&next, ptr->arrival_time, since);
+		}
+
+		for(int rank=0; rank<sim->NUM_RANKS[channel]; rank++)
+		{
+			note_event(&next, T_FAW_met_cycle(sim, channel, vault, rank), since);
+			note_event(&next, sim->refresh_issue_deadline[channel][vault][rank], since);
+			note_event(&next, sim->next_refresh_completion_deadline[channel][vault][rank], since);
+
+			for(int bank=0; bank<sim->NUM_BANKS[channel]; bank++)
+			{
+				bank_t * b = &sim->dram_state[channel][vault][rank][bank];
+				note_event(&next, b->next_pre, since);
+				note_event(&next, b->next_act, since);
+				note_event(&next, b->next_read, since);
+				note_event(&next, b->next_write, since);
+				note_event(&next, b->next_powerdown, since);
+				note_event(&next, b->next_powerup, since);
+				note_event(&next, b->next_refresh, since);
+			}
+		}
+	}
+	return next;
+}
+
+// Earliest cycle after 'since' at which the SerDes link of this HMC may
+// transfer a request or a response, or -1 if both directions are idle.
+long long int next_link_event(usimm_sim_t * sim, int channel, long long int since)
+{
+	long long int next = -1;
+
+	for(int core=0; core<sim->NUMCORES; core++)
+	{
+		if(sim->read_queue_length_for_core[core][channel] || sim->write_queue_length_for_core[core][channel])
+		{
+			note_event(&next, max(sim->next_request_schedule_time[channel], since+1), since);
+			break;
+		}
+	}
+	for(int vault=0; vault<sim->NUM_VAULTS[channel]; vault++)
+	{
+		if(sim->read_return_queue_length[channel][vault])
+		{
+			note_event(&next, max(sim->next_respond_schedule_time[channel], since+1), since);
+			break;
+		}
+	}
+	return next;
+}
+
+// Account for link cycles of this HMC that were skipped while all of its
+// queues were empty. Each of them would have polled the scheduler for a
+// response once next_respond_schedule_time had passed.
+void skip_link_cycles(usimm_sim_t * sim, int channel, long long int first_cycle, long long int num_cycles, int period)
+{
+	long long int first_poll = max(sim->next_respond_schedule_time[channel], 1);
+	long long int polls = num_cycles;
+
+	if(first_cycle < first_poll)
+		polls -= (first_poll - first_cycle + period - 1)/period;
+	if(polls > 0)
+		skip_completed_requests(sim, channel, polls);
+}
+
+//------------------------------------------------------------
+// Calculate Power: It calculates and returns average power used by every Rank on Every 
+// Channel during the course of the simulation 
+// print_stats_type: 0 prints the cycle break-up, 1 the power break-up, 2 nothing
+// Units : Time- ns; Current mA; Voltage V; Power mW; 
+//------------------------------------------------------------
+
+ float calculate_power(usimm_sim_t * sim, int channel, int vault, int rank, int print_stats_type, int chips_per_rank)
+{
+	/*
+	Power is calculated using the equations from Technical Note "TN-41-01: Calculating Memory System Power for DDR"
+	The current values IDD* are taken from the data sheets. 
+	These are average current values that the chip will draw when certain actions occur as frequently as possible.
+	i.e., the worst case power consumption
+	Eg: when ACTs happen every tRC
+		pds_<component> is the power calculated by directly using the current values from the data sheet. 'pds' stands for 
+	PowerDataSheet. This will the power drawn by the chip when operating under the activity that is assumed in the data 
+	sheet. This mostly represents the worst case power
+		These pds_<*> components need to be derated in accordance with the activity that is observed. Eg: If ACTs occur slower
+	than every tRC, then pds_act will be derated to give "psch_act" (SCHeduled Power consumed by Activate) 
+	*/
+
+/*------------------------------------------------------------
+// total_power is the sum of of 13 components listed below 
+// Note: CKE is the ClocK Enable to every chip.
+// Note: Even though the reads and write are to a different rank on the same channel, the Pull-Up and the Pull-Down resistors continue 
+// 		to burn some power. psch_termWoth and psch_termWoth stand for the power dissipated in the rank in question when the reads and
+// 		writes are to other ranks on the channel
+
+	psch_act 						-> Power dissipated by activating a row
+  psch_act_pdn 				-> Power dissipated when CKE is low (disabled) and all banks are precharged
+  psch_act_stby 			-> Power dissipated when CKE is high (enabled) and at least one back is active (row is open)
+  psch_pre_pdn_fast  	-> Power dissipated when CKE is low (disabled) and all banks are precharged and chip is in fast power down
+  psch_pre_pdn_slow  	-> Power dissipated when CKE is low (disabled) and all banks are precharged and chip is in fast slow  down
+  psch_pre_stby 			-> Power dissipated when CKE is high (enabled) and at least one back is active (row is open)
+  psch_termWoth 			-> Power dissipated when a Write termiantes at the other set of chips.
+  psch_termRoth 			-> Power dissipated when a Read  termiantes at the other set of chips
+  psch_termW 					-> Power dissipated when a Write termiantes at the set of chips in question
+  psch_dq 						-> Power dissipated when a Read  termiantes at the set of chips in question (Data Pins on the chip are called DQ)
+  psch_ref 						-> Power dissipated during Refresh
+  psch_rd 						-> Power dissipated during a Read  (does ot include power to open a row)
+  psch_wr 						-> Power dissipated during a Write (does ot include power to open a row)
+
+------------------------------------------------------------*/
+
+	float pds_act ;						
+	float pds_act_pdn;
+	float pds_act_stby;
+	float pds_pre_pdn_fast;
+	float pds_pre_pdn_slow;
+	float pds_pre_stby;
+	float pds_wr;
+	float pds_rd;
+	float pds_ref;
+	float pds_dq;
+	float pds_termW;
+	float pds_termRoth;
+	float pds_termWoth;
+
+	float psch_act;
+	float psch_pre_pdn_slow;
+	float psch_pre_pdn_fast;
+	float psch_act_pdn;
+	float psch_act_stby;
+	float psch_pre_stby;
+	float psch_rd;
+	float psch_wr;
+	float psch_ref;
+	float psch_dq;
+	float psch_termW;
+	float psch_termRoth;
+	float psch_termWoth;
+
+	float total_chip_power;
+	float total_rank_power;
+
+	long long int writes =0 , reads=0;
+
+	long long int time_in_act_stby = rank_residency(sim, channel, vault, rank, sim->stats_time_spent_in_active_standby);
+	long long int time_in_act_pdn = rank_residency(sim, channel, vault, rank, sim->stats_time_spent_in_active_power_down);
+	long long int time_in_pre_pdn_fast = rank_residency(sim, channel, vault, rank, sim->stats_time_spent_in_precharge_power_down_fast);
+	long long int time_in_pre_pdn_slow = rank_residency(sim, channel, vault, rank, sim->stats_time_spent_in_precharge_power_down_slow);
+
+
+	/*----------------------------------------------------
+  //Calculating DataSheet Power
+	----------------------------------------------------*/
+
+	pds_act = (sim->IDD0[channel] - (sim->IDD3N[channel] * sim->T_RAS[channel] + sim->IDD2N[channel] *(sim->T_RC[channel] - sim->T_RAS[channel]))/sim->T_RC[channel]) * sim->VDD[channel];
+	
+	pds_pre_pdn_slow = sim->IDD2P0[channel] * sim->VDD[channel];
+
+	pds_pre_pdn_fast = sim->IDD2P1[channel] * sim->VDD[channel];
+
+	pds_act_pdn = sim->IDD3P[channel] * sim->VDD[channel];
+
+	pds_pre_stby = sim->IDD2N[channel] * sim->VDD[channel];
+	pds_act_stby = sim->IDD3N[channel] * sim->VDD[channel];
+
+	pds_wr = (sim->IDD4W[channel] - sim->IDD3N[channel]) * sim->VDD[channel];
+
+	pds_rd = (sim->IDD4R[channel] - sim->IDD3N[channel]) * sim->VDD[channel];
+
+	pds_ref = (sim->IDD5[channel] - sim->IDD3N[channel]) * sim->VDD[channel];
+
+
+	/*----------------------------------------------------
+	//On Die Termination (ODT) Power:
+	//Values obtained from Micron Technical Note
+	//This is dependent on the termination configuration of the simulated configuration
+	//our simulator uses the same config as that used in the Tech Note
+	----------------------------------------------------*/
+	pds_dq = ODT_DQ_POWER;
+
+	pds_termW = ODT_TERM_W_POWER;
+
+	pds_termRoth = ODT_TERM_R_OTHER_POWER;
+
+	pds_termWoth = ODT_TERM_W_OTHER_POWER;
+
+	/*----------------------------------------------------
+	//Derating worst case power to represent system activity
+	----------------------------------------------------*/
+
+	//average_gap_between_activates was initialised to 0. So if it is still
+	//0, then no ACTs have happened to this rank.
+	//Hence activate-power is also 0
+	if (sim->average_gap_between_activates[channel][vault][rank] == 0)
+	{
+		psch_act = 0;
+	} else {
+		psch_act = pds_act * sim->T_RC[channel]/(sim->average_gap_between_activates[channel][vault][rank]);
+	}
+	
+	psch_act_pdn = pds_act_pdn * ((double)time_in_act_pdn/sim->CYCLE_VAL);
+	psch_pre_pdn_slow = pds_pre_pdn_slow * ((double)time_in_pre_pdn_slow/sim->CYCLE_VAL);
+	psch_pre_pdn_fast = pds_pre_pdn_fast * ((double)time_in_pre_pdn_fast/sim->CYCLE_VAL);
+
+	psch_act_stby = pds_act_stby * ((double)time_in_act_stby/sim->CYCLE_VAL);
+
+	/*----------------------------------------------------
+  //pds_pre_stby assumes that the system is powered up and every 
+	//row has been precharged during every cycle 
+	// In reality, the chip could have been in a power-down mode
+	//or a row could have been active. The time spent in these modes 
+	//should be deducted from total time
+	----------------------------------------------------*/
+	psch_pre_stby = pds_pre_stby * ((double)(sim->CYCLE_VAL - time_in_act_stby- time_in_pre_pdn_slow - time_in_pre_pdn_fast - time_in_act_pdn))/sim->CYCLE_VAL;
+
+	/*----------------------------------------------------
+  //Calculate Total Reads ans Writes performed in the system
+	----------------------------------------------------*/
+	
+	for(int i=0;i<sim->NUM_BANKS[channel];i++)
+	{
+		writes+= sim->stats_num_write[channel][vault][rank][i];
+		reads+=sim->stats_num_read[channel][vault][rank][i];
+	}
+
+	/*----------------------------------------------------
+  // pds<rd/wr> assumes that there is rd/wr happening every cycle
+	// T_DATA_TRANS is the number of cycles it takes for one rd/wr
+	----------------------------------------------------*/
+	psch_wr = pds_wr * (writes*sim->T_DATA_TRANS[channel])/sim->CYCLE_VAL;
+
+	psch_rd = pds_rd * (reads*sim->T_DATA_TRANS[channel])/sim->CYCLE_VAL;
+
+	/*----------------------------------------------------
+  //pds_ref assumes that there is always a refresh happening.
+	//in reality, refresh consumes only T_RFC out of every t_REFI
+	----------------------------------------------------*/
+	psch_ref = pds_ref * sim->T_RFC[channel]/sim->T_REFI[channel]; 
+
+	psch_dq = pds_dq * (reads*sim->T_DATA_TRANS[channel])/sim->CYCLE_VAL;
+
+	psch_termW = pds_termW * (writes*sim->T_DATA_TRANS[channel])/sim->CYCLE_VAL;
+
+
+	psch_termRoth = pds_termRoth *  ((double)sim->stats_time_spent_terminating_reads_from_other_ranks[channel][vault][rank]/sim->CYCLE_VAL);
+	psch_termWoth = pds_termWoth * ((double)sim->stats_time_spent_terminating_writes_to_other_ranks[channel][vault][rank]/sim->CYCLE_VAL);
+
+
+	total_chip_power = psch_act + psch_termWoth + psch_termRoth + psch_termW + psch_dq + psch_ref + psch_rd + psch_wr + psch_pre_stby + psch_act_stby + psch_pre_pdn_fast + psch_pre_pdn_slow + psch_act_pdn  ;
+	total_rank_power = total_chip_power * chips_per_rank;
+
+	double time_in_pre_stby = (((double)(sim->CYCLE_VAL - time_in_act_stby- time_in_pre_pdn_slow - time_in_pre_pdn_fast - time_in_act_pdn))/sim->CYCLE_VAL);
+
+	if (sim->power_stats_header_printed ==0 && print_stats_type != 2) {
+
+
+		fprintf (sim->out, "\n#-----------------------------Simulated Cycles Break-Up-------------------------------------------\n");
+		fprintf (sim->out, "Note:  1.(Read Cycles + Write Cycles + Read Other + Write Other) should add up to %% cycles during which\n");
+		fprintf (sim->out, "          the channel is busy. This should be the same for all Ranks on a Channel\n");
+		fprintf (sim->out, "       2.(PRE_PDN_FAST + PRE_PDN_SLOW + ACT_PDN + ACT_STBY + PRE_STBY) should add up to 100%%\n");
+		fprintf (sim->out, "       3.Power Down means Clock Enable, CKE = 0. In Standby mode, CKE = 1\n");
+		fprintf (sim->out, "#-------------------------------------------------------------------------------------------------\n");
+		fprintf (sim->out, "Total Simulation Cycles                      %11lld\n",sim->CYCLE_VAL );
+		fprintf (sim->out, "---------------------------------------------------------------\n\n");
+
+		sim->power_stats_header_printed = 1;
+	}
+
+	if (print_stats_type == 0) {
+		/*
+		printf ("%3d %6d %13.2f %13.2f %13.2f %13.2f %15.2f %15.2f %15.2f %13.2f %11.2f \n",\
+				channel,\
+				rank,\
+				(double)reads/CYCLE_VAL,\
+				(double)writes/CYCLE_VAL,\
+				psch_termRoth,\
+				psch_termWoth,\
+				((double)stats_time_spent_in_precharge_power_down_fast[channel][rank]/CYCLE_VAL),\
+				((double)stats_time_spent_in_precharge_power_down_slow[channel][rank]/CYCLE_VAL),\
+				((double)stats_time_spent_in_active_power_down[channel][rank]/CYCLE_VAL),\
+				((double)stats_time_spent_in_active_standby[channel][rank]/CYCLE_VAL),\
+				(((double)(CYCLE_VAL - stats_time_spent_in_active_standby[channel][rank]- stats_time_spent_in_precharge_power_down_slow[channel][rank] - stats_time_spent_in_precharge_power_down_fast[channel][rank] - stats_time_spent_in_active_power_down[channel][rank]))/CYCLE_VAL)
+				);
+	*/
+		fprintf (sim->out, "Channel %d Rank %d Read Cycles(%%)           %9.2f # %% cycles the Rank performed a Read\n",channel, rank, (double)reads*sim->T_DATA_TRANS[channel]/sim->CYCLE_VAL ); 
+		fprintf (sim->out, "Channel %d Rank %d Write Cycles(%%)          %9.2f # %% cycles the Rank performed a Write\n",channel, rank, (double)writes*sim->T_DATA_TRANS[channel]/sim->CYCLE_VAL ); 
+		fprintf (sim->out, "Channel %d Rank %d Read Other(%%)            %9.2f # %% cycles other Ranks on the channel performed a Read\n",channel, rank, \
+					   ((double)sim->stats_time_spent_terminating_reads_from_other_ranks[channel][vault][rank]/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d Write Other(%%)           %9.2f # %% cycles other Ranks on the channel performed a Write\n",channel, rank,\
+					  ((double)sim->stats_time_spent_terminating_writes_to_other_ranks[channel][vault][rank]/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d PRE_PDN_FAST(%%)          %9.2f # %% cycles the Rank was in Fast Power Down and all Banks were Precharged\n",channel, rank, \
+						((double)time_in_pre_pdn_fast/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d PRE_PDN_SLOW(%%)          %9.2f # %% cycles the Rank was in Slow Power Down and all Banks were Precharged\n",channel, rank, \
+						((double)time_in_pre_pdn_slow/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d ACT_PDN(%%)               %9.2f # %% cycles the Rank was in Active Power Down and atleast one Bank was Active\n",channel, rank, \
+						((double)time_in_act_pdn/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d ACT_STBY(%%)              %9.2f # %% cycles the Rank was in Standby and atleast one bank was Active\n",channel, rank,\
+						 ((double)time_in_act_stby/sim->CYCLE_VAL) ); 
+		fprintf (sim->out, "Channel %d Rank %d PRE_STBY(%%)              %9.2f # %% cycles the Rank was in Standby and all Banks were Precharged\n",channel, rank, time_in_pre_stby ); 
+		fprintf (sim->out, "---------------------------------------------------------------\n\n");
+
+
+	} else if (print_stats_type == 1) {
+		/*----------------------------------------------------
+		// Total Power is the sum total of all the components calculated above
+		----------------------------------------------------*/
+
+
+		fprintf (sim->out, "Channel %d Rank %d Background(mw)          %9.2f # depends only on Power Down time and time all banks were precharged\n",channel, rank, psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby); 
+		fprintf (sim->out, "Channel %d Rank %d Act(mW)                 %9.2f # power spend bringing data to the row buffer\n",channel, rank, psch_act); 
+		fprintf (sim->out, "Channel %d Rank %d Read(mW)                %9.2f # power spent doing a Read  after the Row Buffer is open\n",channel, rank, psch_rd); 
+		fprintf (sim->out, "Channel %d Rank %d Write(mW)               %9.2f # power spent doing a Write after the Row Buffer is open\n",channel, rank, psch_wr); 
+		fprintf (sim->out, "Channel %d Rank %d Read Terminate(mW)      %9.2f # power dissipated in ODT resistors during Read\n",channel, rank, psch_dq); 
+		fprintf (sim->out, "Channel %d Rank %d Write Terminate(mW)     %9.2f # power dissipated in ODT resistors during Write\n",channel, rank, psch_termW); 
+		fprintf (sim->out, "Channel %d Rank %d termRoth(mW)            %9.2f # power dissipated in ODT resistors during Reads  in other ranks\n",channel, rank, psch_termRoth); 
+		fprintf (sim->out, "Channel %d Rank %d termWoth(mW)            %9.2f # power dissipated in ODT resistors during Writes in other ranks\n",channel, rank, psch_termWoth); 
+		fprintf (sim->out, "Channel %d Rank %d Refresh(mW)             %9.2f # depends on frequency of Refresh (tREFI)\n",channel, rank, psch_ref); 
+		fprintf (sim->out, "---------------------------------------------------------------\n");
+		fprintf (sim->out, "Channel %d Rank %d Total Rank Power(mW)    %9.2f # (Sum of above components)*(num chips in each Rank)\n",channel, rank, total_rank_power);
+		fprintf (sim->out, "---------------------------------------------------------------\n\n");
+
+
+
+/*
+
+ printf("%3d %11d %16.2f %16.2f %17.2f %13.2f %13.2f %20.2f %21.2f %24.2f %12.2f %13.2f\n",\
+				channel,\
+				rank,\
+				total_rank_power, \
+				psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby, \
+				psch_act, \
+				psch_rd, \
+				psch_wr, \
+				psch_dq, \
+				psch_termW, \
+				psch_termRoth, \
+				psch_termWoth, \
+				psch_ref                                                                                  
+
+				);
+*/
+
+/*
+		printf("Channel:%d Rank:%d Total background power : %f mW\n", channel, rank, psch_act_pdn+psch_act_stby+psch_pre_pdn_slow+psch_pre_pdn_fast+psch_pre_stby);
+		printf("Channel:%d, Rank:%d Total activate power : %f,%f,%d,%f mW\n", channel, rank, psch_act,pds_act,T_RC,average_gap_between_activates[channel][rank]);
+		printf("Channel:%d, Rank:%d Total I/O and termination power: %f rd:%f wr:%f dq:%f termW:%f termRoth:%f termWoth:%f mW\n", channel, rank, psch_rd+psch_wr+psch_dq+psch_termW+psch_termRoth+psch_termWoth, psch_rd, psch_wr, psch_dq, psch_termW, psch_termRoth, psch_termWoth);
+
+		printf("Channel:%d, Rank:%d Total refresh power: %f mW\n", channel, rank, psch_ref);
+		printf("Channel:%d, Rank:%d Total Rank power: %f mW\n\n", channel, rank, total_rank_power);
+		printf("------------------------------------------------\n");
+		*/
+
+	} else if (print_stats_type == 2) {
+		// only the total rank power is wanted
+	} else {
+		fprintf (sim->out, "PANIC: FN_CALL_ERROR: In calculate_power(), print_stats_type can only be 0, 1 or 2\n");
+		assert (-1);
+	}
+
+	return total_rank_power;
+
+}
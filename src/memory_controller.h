@@ -8,10 +8,7 @@
 #define MAX_NUM_HMCS 2
 #define MAX_NUM_CORES 4
 
-// Moved here from main.c 
-long long int *committed; // total committed instructions in each core
-long long int *fetched;   // total fetched instructions in each core
-
+#include "params.h"
 
 //////////////////////////////////////////////////
 //	Memory Controller Data Structures	//
@@ -41,6 +38,8 @@ typedef struct req
   unsigned long long int physical_address;
   dram_address_t dram_addr;
   long long int arrival_time;     
+  long long int insert_time; // when the core queued the request (arrival_time is when it reached the vault)
+  long long int response_time; // HMC reads: when the response crossed the link back
   long long int dispatch_time; // when COL_RD or COL_WR is issued for this request
   long long int completion_time; //final completion time
   long long int latency; // dispatch_time-arrival_time
@@ -53,6 +52,8 @@ typedef struct req
   long long int instruction_pc; // phy address of instruction that generated this request (valid only for reads)
   void * user_ptr; // user_specified data
   struct req * next;
+  struct req * bank_prev; // links in the (rank, bank) bucket of the vault queue
+  struct req * bank_next;
 } request_t;
 
 // Bankstates
@@ -75,106 +76,92 @@ typedef struct bnk
   long long int next_refresh;
 }bank_t;
 
-// contains the states of all banks in the system 
-bank_t dram_state[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-
-// command issued this cycle to this channel
-int command_issued_current_cycle[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// cas command issued this cycle to this channel
-int cas_issued_current_cycle[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS]; // 1/2 for COL_READ/COL_WRITE
-
-// Per channel read queue
-request_t * read_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// Per channel write queue
-request_t * write_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// SerDes queue at host
-request_t * read_queue_per_core_head[MAX_NUM_CORES][MAX_NUM_HMCS];
-
-// SerDes queue at host
-request_t * write_queue_per_core_head[MAX_NUM_CORES][MAX_NUM_HMCS];
-
-request_t * read_return_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// issuables_for_different commands
-int cmd_precharge_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-int cmd_all_bank_precharge_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int cmd_powerdown_fast_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int cmd_powerdown_slow_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int cmd_powerup_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int cmd_refresh_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-
 
-// refresh variables
-long long int next_refresh_completion_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int last_refresh_completion_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int forced_refresh_mode_on[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int refresh_issue_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int issued_forced_refresh_commands[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-int num_issued_refreshes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+// Unserved requests of each vault read/write queue, bucketed by (rank,
+// bank). A bucket's next_command/command_issuable values are only
+// recomputed when it is dirty (a command or refresh touched its bank)
+// or a timing threshold it depends on has been reached. Bucket i of a
+// vault is rank i/NUM_BANKS, bank i%NUM_BANKS.
+#define MAX_NUM_BUCKETS (MAX_NUM_RANKS*MAX_NUM_BANKS)
+#define BUCKET_MASK_WORDS ((MAX_NUM_BUCKETS+63)/64)
 
-long long int read_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int write_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-long long int write_queue_length_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
-long long int read_queue_length_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
-long long int read_return_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// Stats
-long long int num_read_merge ;
-long long int num_write_merge ;
-long long int stats_reads_merged_per_vault[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int stats_writes_merged_per_vault[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int stats_reads_seen[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int stats_writes_seen[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int stats_reads_completed[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-long long int stats_writes_completed[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-double stats_average_read_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-double stats_average_read_queue_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-double stats_average_write_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-double stats_average_write_queue_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-long long int stats_page_hits[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-double stats_read_row_hit_rate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-
-// Time spent in various states
-long long int stats_time_spent_in_active_standby[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_in_active_power_down[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_in_precharge_power_down_fast[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_in_precharge_power_down_slow[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_in_power_up[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int last_activate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int last_refresh[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-double average_gap_between_activates[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-double average_gap_between_refreshes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_terminating_reads_from_other_ranks[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_time_spent_terminating_writes_to_other_ranks[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-
-// Command Counters
-long long int stats_num_activate_read[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_activate_write[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_activate_spec[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_activate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_num_precharge[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_read[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_write[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
-long long int stats_num_powerdown_slow[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_num_powerdown_fast[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-long long int stats_num_powerup[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
-
-
-long long int next_request_schedule_time[MAX_NUM_HMCS];
-long long int next_respond_schedule_time[MAX_NUM_HMCS];
+typedef struct bankbucket
+{
+  request_t * head;
+  long long int wakeup; // next cycle a timing threshold flips, -1 if none
+  long long int hit_row; // row the hit count below refers to
+  int hits; // requests in the bucket to hit_row
+} bank_bucket_t;
 
-int drain_writes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
-int drain_write_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
+typedef struct vaultbuckets
+{
+  bank_bucket_t bucket[MAX_NUM_BUCKETS];
+  unsigned long long int occupied[BUCKET_MASK_WORDS];
+  unsigned long long int dirty[BUCKET_MASK_WORDS];
+  long long int wakeup; // no bucket wakes up before this cycle, -1 if none
+} vault_buckets_t;
+
+// tFAW allows at most this many activates to a rank in any T_FAW window
+#define ACTIVATION_WINDOW_SIZE 4
+
+// Address decoder: where each field of a DRAM address sits in a
+// physical address
+typedef struct addrfield
+{
+  int shift;
+  long long int mask;
+} addr_field_t;
 
+typedef struct addrmap
+{
+  int channel_base;	// added to the decoded channel (DIMMs follow the HMCs)
+  addr_field_t channel;
+  addr_field_t vault;
+  addr_field_t rank;
+  addr_field_t bank;
+  addr_field_t row;
+  addr_field_t column;
+} addr_map_t;
+
+// Queue index: open-addressing table counting the queued requests to
+// each (address, owner) pair
+typedef struct qidxentry
+{
+  long long int address;
+  int owner;
+  int count;	// 0 marks an empty slot
+} queue_index_entry_t;
 
-// scheduler params
+typedef struct qidx
+{
+  queue_index_entry_t * entries;
+  long long int mask;
+  long long int used;
+} queue_index_t;
 
+// A read completion time for the ROB, found while stepping a vault
+typedef struct completion
+{
+  int thread_id;
+  int instruction_id;
+  long long int comptime;
+} completion_t;
+
+// What stepping a vault leaves for the rest of the system: ROB
+// completion times and finished requests to return to the pool. They
+// are applied by merge_vault_updates() once every channel has been
+// stepped, so that no vault writes shared state while it is stepped.
+// A vault issues at most one command and sends at most one SerDes
+// response per step.
+#define MAX_COMPLETIONS_PER_STEP 2
+
+typedef struct vaultupdates
+{
+  completion_t completion[MAX_COMPLETIONS_PER_STEP];
+  int num_completions;
+  request_t * freed_requests;
+  long long int num_freed;
+} vault_updates_t;
 
 // functions
 
@@ -182,92 +169,137 @@ int drain_write_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
 unsigned int log_base2(unsigned int new_value);
 
 // initialize memory_controller variables
-void init_memory_controller_vars();
+void init_memory_controller_vars(usimm_sim_t * sim);
 
-// called every cycle to update the read/write queues
-void update_memory(int channel);
+// release what init_memory_controller_vars allocated
+void free_memory_controller_vars(usimm_sim_t * sim);
+
+// called every cycle to update the read/write queues of a vault
+void update_vault(usimm_sim_t * sim, int channel, int vault);
 
 // activate to bank allowed or not
-int is_activate_allowed(int channel, int vault, int rank, int bank);
+int is_activate_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
 
 // precharge to bank allowed or not
-int is_precharge_allowed(int channel, int vault, int rank, int bank);
+int is_precharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
 
 // all bank precharge allowed or not
-int is_all_bank_precharge_allowed(int channel, int vault, int rank);
+int is_all_bank_precharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // autoprecharge allowed or not
-int is_autoprecharge_allowed(int channel, int vault, int rank, int bank);
+int is_autoprecharge_allowed(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
 
 // power_down fast allowed or not
-int is_powerdown_fast_allowed(int channel, int vault, int rank);
+int is_powerdown_fast_allowed(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // power_down slow allowed or not
-int is_powerdown_slow_allowed(int channel, int vault, int rank);
+int is_powerdown_slow_allowed(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // powerup allowed or not
-int is_powerup_allowed(int channel,int vault, int rank);
+int is_powerup_allowed(usimm_sim_t * sim, int channel,int vault, int rank);
 
 // refresh allowed or not
-int is_refresh_allowed(int channel, int vault, int rank);
+int is_refresh_allowed(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // issues command to make progress on a request
-int issue_request_command(request_t * req);
+int issue_request_command(usimm_sim_t * sim, request_t * req);
 
 // to check if all write instructions are committed
-int are_all_writes_completed();
+int are_all_writes_completed(usimm_sim_t * sim);
 
 // power_down command
-int issue_powerdown_command(int channel, int vault, int rank, command_t cmd);
+int issue_powerdown_command(usimm_sim_t * sim, int channel, int vault, int rank, command_t cmd);
 
 // powerup command
-int issue_powerup_command(int channel, int vault, int rank);
+int issue_powerup_command(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // precharge a bank
-int issue_activate_command(int channel, int vault, int rank, int bank, long long int row);
+int issue_activate_command(usimm_sim_t * sim, int channel, int vault, int rank, int bank, long long int row);
 
 // precharge a bank
-int issue_precharge_command(int channel, int vault, int rank, int bank);
+int issue_precharge_command(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
 
 // precharge all banks in a rank
-int issue_all_bank_precharge_command(int channel, int vault, int rank);
+int issue_all_bank_precharge_command(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // refresh all banks
-int issue_refresh_command(int channel, int vault, int rank);
+int issue_refresh_command(usimm_sim_t * sim, int channel, int vault, int rank);
 
 // autoprecharge all banks
-int issue_autoprecharge(int channel, int vault, int rank, int bank);
+int issue_autoprecharge(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
 
 // find if there is a matching write request
-int read_matches_write_or_read_queue(long long int physical_address, int thread_id);
+int read_matches_write_or_read_queue(usimm_sim_t * sim, long long int physical_address, int thread_id);
 
 // find if there is a matching request in the write queue
-int write_exists_in_write_queue(long long int physical_address, int thread_id);
+int write_exists_in_write_queue(usimm_sim_t * sim, long long int physical_address, int thread_id);
 
 // to transfer eligible request from READ/WRITE request queues from processor to HMC
-void transfer_request_to_HMCs(int channel);
+// (returns 1 if a request was transferred)
+int transfer_request_to_HMCs(usimm_sim_t * sim, int channel);
 
 // to transfer eligible resquest response from READ return queue from HMC to processor 
-void transfer_response_to_PROCESSOR(int channel);
+// (returns 1 if a response was transferred)
+int transfer_response_to_PROCESSOR(usimm_sim_t * sim, int channel);
 
 // enqueue a read into the corresponding read queue (returns ptr to new node)
-request_t* insert_read(long long int physical_address, long long int arrival_cycle, int thread_id, int instruction_id, long long int instruction_pc);
+request_t* insert_read(usimm_sim_t * sim, long long int physical_address, long long int arrival_cycle, int thread_id, int instruction_id, long long int instruction_pc);
 
 // enqueue a write into the corresponding write queue (returns ptr to new_node)
-request_t* insert_write(long long int physical_address, long long int arrival_time, int thread_id, int instruction_id);
+request_t* insert_write(usimm_sim_t * sim, long long int physical_address, long long int arrival_time, int thread_id, int instruction_id);
+
+// earliest cycle after 'since' at which a channel may have work to do
+long long int next_memory_event(usimm_sim_t * sim, int channel, long long int since);
 
-// update stats counters
-void gather_stats(int channel, int vault);
+// earliest cycle after 'since' at which an HMC link may transfer something
+long long int next_link_event(usimm_sim_t * sim, int channel, long long int since);
+
+// account for idle link cycles that were skipped
+void skip_link_cycles(usimm_sim_t * sim, int channel, long long int first_cycle, long long int num_cycles, int period);
 
 // print statistics
-void print_stats();
+void print_stats(usimm_sim_t * sim);
+
+// calculate power for each channel; print_stats_type 0/1 prints the
+// cycle/power break-up, 2 only returns the rank power
+float calculate_power(usimm_sim_t * sim, int channel, int vault, int rank, int print_stats_type, int chips_per_rank);
+
+// energy a device of the rank has drawn up to the current cycle, in mW
+// times cycles; charged as commands issue and the power state changes
+double energy_so_far(usimm_sim_t * sim, int channel, int vault, int rank);
+
+// credit every rank's power state residency up to the end of the run
+void finish_rank_residency(usimm_sim_t * sim);
+
+// Bank buckets
+void add_to_bank_bucket(usimm_sim_t * sim, request_t * request);
+void mark_bank_dirty(usimm_sim_t * sim, int channel, int vault, int rank, int bank);
+void mark_rank_dirty(usimm_sim_t * sim, int channel, int vault, int rank);
+void mark_vault_dirty(usimm_sim_t * sim, int channel, int vault);
+int queued_row_hits(usimm_sim_t * sim, int channel, int vault, int rank, int bank, optype_t type);
 
-// calculate power for each channel
-float calculate_power(int channel, int vault, int rank, int print_stats_type, int chips_per_rank);
+// Request pool
+void init_request_pool(usimm_sim_t * sim);
+request_t * alloc_request(usimm_sim_t * sim);
+void free_request(usimm_sim_t * sim, request_t * node);
+// apply the ROB completions and request frees of the channels just stepped
+void merge_vault_updates(usimm_sim_t * sim);
+
+// Address index over the queues searched by the merge checks
+void init_queue_index(usimm_sim_t * sim);
+
+// Index the requests of restored queues
+void rebuild_queue_index(usimm_sim_t * sim);
+
+// Build the address decoder tables from the configuration
+void init_address_map(usimm_sim_t * sim);
 
 // Calculate DRAM address
-dram_address_t * calc_dram_addr(long long int physical_address);
+dram_address_t calc_dram_addr(usimm_sim_t * sim, long long int physical_address);
+
+// Open the row an access would open, for functional warmup
+void warm_open_row(usimm_sim_t * sim, long long int physical_address);
 
-int is_writeq_full(int thread_id);
+int is_writeq_full(usimm_sim_t * sim, int thread_id);
 
 #endif // __MEM_CONTROLLER_HH__
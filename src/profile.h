@@ -0,0 +1,77 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+// Self-profiling of the simulation loop (usimm --self-profile). Each
+// phase of the loop counts the time stamp counter ticks spent in it,
+// its invocations and the useful work it did. The counters are only
+// built in with -DUSIMM_PROFILE (make PROFILE=1); otherwise the
+// PROFILE_* macros below expand to nothing.
+//
+// The memory system phases are counted per vault step and summed over
+// the memory threads. PROF_TRACE is the part of PROF_FETCH spent
+// reading the traces.
+
+#define PROF_RETIRE 0
+#define PROF_UPDATE 1 // update_memory, per vault
+#define PROF_RESPONSE 2 // transfer_response_to_PROCESSOR
+#define PROF_SCHEDULE 3 // per vault
+#define PROF_REQUEST 4 // transfer_request_to_HMCs
+#define PROF_FETCH 5
+#define PROF_TRACE 6
+#define PROF_MERGE 7 // merge_vault_updates
+#define PROF_ADVANCE 8 // to the next tick, skipping idle ones
+#define NUM_PROF_PHASES 9
+
+typedef struct profile
+{
+  int enabled; // set before usimm_sim_run
+  unsigned long long int ticks[NUM_PROF_PHASES];
+  long long int calls[NUM_PROF_PHASES];
+  long long int events[NUM_PROF_PHASES];
+  unsigned long long int loop_ticks; // the whole simulation loop
+  double loop_seconds;
+} profile_t;
+
+#ifdef USIMM_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline unsigned long long int profile_ticks(void)
+{
+  return __rdtsc();
+}
+#else
+#include <time.h>
+static inline unsigned long long int profile_ticks(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long int)now.tv_sec*1000000000ULL + now.tv_nsec;
+}
+#endif
+
+// Vault phases run on any memory thread, so every count is atomic.
+static inline void profile_add(profile_t * profile, int phase, unsigned long long int ticks, long long int events)
+{
+  __atomic_fetch_add(&profile->ticks[phase], ticks, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&profile->calls[phase], 1, __ATOMIC_RELAXED);
+  if (events)
+    __atomic_fetch_add(&profile->events[phase], events, __ATOMIC_RELAXED);
+}
+
+#define PROFILE_BEGIN(sim, start) unsigned long long int start = (sim)->profile.enabled ? profile_ticks() : 0
+#define PROFILE_END(sim, phase, start, count) do { if ((sim)->profile.enabled) profile_add(&(sim)->profile, phase, profile_ticks() - (start), count); } while (0)
+#define PROFILE_EVENTS(sim, phase, count) do { if ((sim)->profile.enabled) (sim)->profile.events[phase] += (count); } while (0)
+// A call whose result is the phase's events
+#define PROFILE_CALL(sim, phase, call) do { PROFILE_BEGIN(sim, call_start); long long int call_events = (call); PROFILE_END(sim, phase, call_start, call_events); } while (0)
+
+#else
+
+#define PROFILE_BEGIN(sim, start)
+#define PROFILE_END(sim, phase, start, count)
+#define PROFILE_EVENTS(sim, phase, count)
+#define PROFILE_CALL(sim, phase, call) (void)(call)
+
+#endif
+
+#endif //__PROFILE_H__
@@ -1,14 +1,25 @@
 #ifndef __SCHEDULER_H__
 #define __SCHEDULER_H__
 
-/* A data structure to see if a bank is a candidate for precharge. */
-int recent_colacc[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+#include "memory_controller.h"
 
-void init_scheduler_vars(); //called from main
-void scheduler_stats(); //called from main
-void schedule(int, int); // scheduler function called every cycle
-request_t * schedule_to_hmc(int channel); //scheduler to transfer request through link to hmc
-request_t * schedule_completed_requests(int channel); // scheduler to transfer read request response through link to processor
+/* Scheduler state, kept in the simulation context as sim->sched. */
+typedef struct schedstate
+{
+  /* A data structure to see if a bank is a candidate for precharge. */
+  int recent_colacc[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  /* Keeping track of how many preemptive precharges are performed. */
+  long long int num_aggr_precharge[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  /* Round-robin pointers of the link schedulers. */
+  int core_to_be_served_next;
+  int vault_to_be_served_next;
+} scheduler_state_t;
 
-#endif //__SCHEDULER_H__
+void init_scheduler_vars(usimm_sim_t * sim); //called from main
+void scheduler_stats(usimm_sim_t * sim); //called from main
+void schedule(usimm_sim_t * sim, int, int); // scheduler function called every cycle
+request_t * schedule_to_hmc(usimm_sim_t * sim, int channel); //scheduler to transfer request through link to hmc
+request_t * schedule_completed_requests(usimm_sim_t * sim, int channel); // scheduler to transfer read request response through link to processor
+void skip_completed_requests(usimm_sim_t * sim, int channel, long long int calls); // stands in for calls to schedule_completed_requests skipped while all read return queues are empty
 
+#endif //__SCHEDULER_H__
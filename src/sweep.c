@@ -0,0 +1,467 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "usimm.h"
+
+/* usimm-sweep: run a grid of parameter settings over a list of workload
+   mixes in one process.  Every trace is loaded once and shared by all
+   the simulations that use it; the simulations run on a fixed number
+   of threads, and the headline results of all runs are printed as one
+   CSV or JSON table, one row per run in grid order. */
+
+#define MAX_GRID_AXES 16
+#define MAX_OPTIONS 64
+
+/* A --config, --hmc-device, --dimm-device or --set applied to every run. */
+typedef struct sweepoption
+{
+  const char * section; /* NULL for --config and --set */
+  const char * config_file; /* NULL for --set */
+  const char * assignment;
+} sweep_option_t;
+
+/* One --grid NAME=V1,V2,... axis. */
+typedef struct gridaxis
+{
+  char name[64];
+  int num_values;
+  char ** values;
+} grid_axis_t;
+
+/* One --mix T1,T2,... workload. */
+typedef struct mix
+{
+  char * spec;
+  int num_traces;
+  char * trace_names[MAX_NUM_CORES];
+  trace_data_t * traces[MAX_NUM_CORES];
+} mix_t;
+
+typedef struct sweeprun
+{
+  int mix;
+  int point; /* index into the grid, last axis fastest */
+  int status;
+  usimm_summary_t summary;
+  profile_t profile;
+  char * messages; /* what a failed run printed, without --log-dir */
+  size_t messages_size;
+} sweep_run_t;
+
+typedef struct sweep
+{
+  sweep_option_t option[MAX_OPTIONS];
+  int num_options;
+  grid_axis_t axis[MAX_GRID_AXES];
+  int num_axes;
+  int num_points;
+  mix_t * mix;
+  int num_mixes;
+  char ** trace_file; /* distinct trace files and their loaded data */
+  trace_data_t * trace_data;
+  int num_trace_files;
+  sweep_run_t * run;
+  int num_runs;
+  int next_run;
+  const char * log_dir;
+  int self_profile;
+} sweep_t;
+
+/* Split a comma-separated list in place. */
+static int split_list(char * list, char *** items)
+{
+  int n = 1;
+  for (char * p = list; *p; p++)
+    if (*p == ',')
+      n++;
+  *items = (char **)malloc(n * sizeof(char *));
+  n = 0;
+  for (char * item = strtok(list, ","); item; item = strtok(NULL, ","))
+    (*items)[n++] = item;
+  return n;
+}
+
+static int add_grid_axis(sweep_t * sweep, char * spec)
+{
+  char * eq = strchr(spec, '=');
+  if (sweep->num_axes == MAX_GRID_AXES || eq == NULL || eq == spec || (size_t)(eq - spec) >= sizeof(sweep->axis[0].name)) {
+    fprintf(stderr, "Bad grid axis %s, expected NAME=V1,V2,...\n", spec);
+    return -1;
+  }
+  grid_axis_t * axis = &sweep->axis[sweep->num_axes++];
+  memcpy(axis->name, spec, eq - spec);
+  axis->name[eq - spec] = '\0';
+  axis->num_values = split_list(eq + 1, &axis->values);
+  if (axis->num_values == 0) {
+    fprintf(stderr, "Grid axis %s has no values\n", axis->name);
+    return -1;
+  }
+  return 0;
+}
+
+static int add_mix(sweep_t * sweep, char * spec)
+{
+  char ** names;
+  mix_t * mix;
+
+  sweep->mix = (mix_t *)realloc(sweep->mix, (sweep->num_mixes+1) * sizeof(mix_t));
+  mix = &sweep->mix[sweep->num_mixes++];
+  memset(mix, 0, sizeof(mix_t));
+  mix->spec = strdup(spec);
+  mix->num_traces = split_list(spec, &names);
+  if (mix->num_traces < 1 || mix->num_traces > MAX_NUM_CORES) {
+    fprintf(stderr, "Mix %s needs between 1 and %d traces\n", mix->spec, MAX_NUM_CORES);
+    free(names);
+    return -1;
+  }
+  memcpy(mix->trace_names, names, mix->num_traces * sizeof(char *));
+  free(names);
+  return 0;
+}
+
+/* Load every distinct trace of the mixes once. */
+static int load_traces(sweep_t * sweep)
+{
+  int max_files = sweep->num_mixes * MAX_NUM_CORES;
+
+  sweep->trace_file = (char **)malloc(max_files * sizeof(char *));
+  sweep->trace_data = (trace_data_t *)calloc(max_files, sizeof(trace_data_t));
+  for (int m=0; m < sweep->num_mixes; m++) {
+    mix_t * mix = &sweep->mix[m];
+    for (int t=0; t < mix->num_traces; t++) {
+      int f;
+      for (f=0; f < sweep->num_trace_files; f++)
+        if (!strcmp(sweep->trace_file[f], mix->trace_names[t]))
+          break;
+      if (f == sweep->num_trace_files) {
+        int loaded = load_trace(&sweep->trace_data[f], mix->trace_names[t]);
+        if (loaded == -1) {
+          fprintf(stderr, "Missing input trace file %s.  Quitting.\n", mix->trace_names[t]);
+          return -5;
+        }
+        if (loaded < 0) {
+          fprintf(stderr, "Panic.  Poor trace format in %s.\n", mix->trace_names[t]);
+          return -1;
+        }
+        sweep->trace_file[f] = mix->trace_names[t];
+        sweep->num_trace_files++;
+      }
+      mix->traces[t] = &sweep->trace_data[f];
+    }
+  }
+  return 0;
+}
+
+/* The value of an axis at a grid point. */
+static const char * grid_value(const sweep_t * sweep, int point, int a)
+{
+  for (int b=sweep->num_axes-1; b > a; b--)
+    point /= sweep->axis[b].num_values;
+  return sweep->axis[a].values[point % sweep->axis[a].num_values];
+}
+
+/* Apply the common options, then the grid point. */
+static int configure(const sweep_t * sweep, usimm_sim_t * sim, int point)
+{
+  for (int o=0; o < sweep->num_options; o++) {
+    const sweep_option_t * option = &sweep->option[o];
+    int status = option->config_file ? usimm_sim_read_config(sim, option->config_file, option->section) : usimm_sim_set(sim, option->assignment);
+    if (status)
+      return status;
+  }
+  for (int a=0; a < sweep->num_axes; a++) {
+    char assignment[128];
+    snprintf(assignment, sizeof(assignment), "%s=%s", sweep->axis[a].name, grid_value(sweep, point, a));
+    int status = usimm_sim_set(sim, assignment);
+    if (status)
+      return status;
+  }
+  return 0;
+}
+
+static void run_one(sweep_t * sweep, int r)
+{
+  sweep_run_t * run = &sweep->run[r];
+  const mix_t * mix = &sweep->mix[run->mix];
+  usimm_sim_t * sim = usimm_sim_create();
+  FILE * out;
+
+  if (sim == NULL) {
+    run->status = -1;
+    return;
+  }
+  if (sweep->log_dir) {
+    char filename[4096];
+    snprintf(filename, sizeof(filename), "%s/run-%d.txt", sweep->log_dir, r);
+    out = fopen(filename, "w");
+  }
+  else
+    out = open_memstream(&run->messages, &run->messages_size);
+  if (out == NULL) {
+    usimm_sim_destroy(sim);
+    run->status = -6;
+    return;
+  }
+  sim->out = out;
+  sim->profile.enabled = sweep->self_profile;
+
+  run->status = configure(sweep, sim, run->point);
+  if (!run->status)
+    run->status = usimm_sim_init_loaded(sim, mix->num_traces, mix->trace_names, (const trace_data_t * const *)mix->traces);
+  if (!run->status)
+    run->status = usimm_sim_run(sim);
+  if (!run->status) {
+    if (sweep->log_dir)
+      usimm_sim_print_stats(sim);
+    usimm_sim_summary(sim, &run->summary);
+    run->profile = sim->profile;
+  }
+  usimm_sim_destroy(sim);
+  fclose(out);
+  if (!run->status) {
+    free(run->messages);
+    run->messages = NULL;
+  }
+}
+
+/* Workers take the next run until none are left. */
+static void * sweep_worker_main(void * arg)
+{
+  sweep_t * sweep = (sweep_t *)arg;
+  int r;
+
+  while ((r = __atomic_fetch_add(&sweep->next_run, 1, __ATOMIC_RELAXED)) < sweep->num_runs)
+    run_one(sweep, r);
+  return NULL;
+}
+
+/* Quote a string for CSV or JSON; names and paths rarely need it. */
+static void print_string(FILE * f, const char * s, int json)
+{
+  fputc('"', f);
+  for (; *s; s++) {
+    if (*s == '"')
+      fputs(json ? "\\\"" : "\"\"", f);
+    else if (json && *s == '\\')
+      fputs("\\\\", f);
+    else
+      fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+static const char * result_column[] = {
+  "status", "cycles", "sum_of_execution_times", "reads_completed", "writes_completed",
+  "average_read_latency", "read_latency_p99", "memory_power_w", "system_power_w", "edp_js"
+};
+#define NUM_RESULT_COLUMNS (sizeof(result_column)/sizeof(result_column[0]))
+
+static void print_results(const sweep_t * sweep, FILE * f, int json)
+{
+  if (json)
+    fprintf(f, "[\n");
+  else {
+    fprintf(f, "run,mix");
+    for (int a=0; a < sweep->num_axes; a++)
+      fprintf(f, ",%s", sweep->axis[a].name);
+    for (unsigned int c=0; c < NUM_RESULT_COLUMNS; c++)
+      fprintf(f, ",%s", result_column[c]);
+    fprintf(f, "\n");
+  }
+
+  for (int r=0; r < sweep->num_runs; r++) {
+    const sweep_run_t * run = &sweep->run[r];
+    const usimm_summary_t * s = &run->summary;
+    char value[NUM_RESULT_COLUMNS][64];
+
+    snprintf(value[0], 64, "%d", run->status);
+    snprintf(value[1], 64, "%lld", s->cycles);
+    snprintf(value[2], 64, "%lld", s->sum_of_execution_times);
+    snprintf(value[3], 64, "%lld", s->reads_completed);
+    snprintf(value[4], 64, "%lld", s->writes_completed);
+    snprintf(value[5], 64, "%.6f", s->average_read_latency);
+    snprintf(value[6], 64, "%lld", s->read_latency_p99);
+    snprintf(value[7], 64, "%.6f", s->memory_power);
+    snprintf(value[8], 64, "%.6f", s->system_power);
+    snprintf(value[9], 64, "%.9f", s->edp);
+
+    if (json) {
+      fprintf(f, "  {\"run\": %d, \"mix\": ", r);
+      print_string(f, sweep->mix[run->mix].spec, 1);
+      for (int a=0; a < sweep->num_axes; a++) {
+        fprintf(f, ", ");
+        print_string(f, sweep->axis[a].name, 1);
+        fprintf(f, ": ");
+        print_string(f, grid_value(sweep, run->point, a), 1);
+      }
+      for (unsigned int c=0; c < NUM_RESULT_COLUMNS; c++)
+        fprintf(f, ", \"%s\": %s", result_column[c], value[c]);
+      if (sweep->self_profile) {
+        fprintf(f, ", \"self_profile\": ");
+        usimm_sim_print_profile(&run->profile, f, 1);
+      }
+      fprintf(f, "}%s\n", (r < sweep->num_runs-1) ? "," : "");
+    }
+    else {
+      fprintf(f, "%d,", r);
+      print_string(f, sweep->mix[run->mix].spec, 0);
+      for (int a=0; a < sweep->num_axes; a++)
+        fprintf(f, ",%s", grid_value(sweep, run->point, a));
+      for (unsigned int c=0; c < NUM_RESULT_COLUMNS; c++)
+        fprintf(f, ",%s", value[c]);
+      fprintf(f, "\n");
+    }
+  }
+  if (json)
+    fprintf(f, "]\n");
+}
+
+static void usage(const char * program)
+{
+  fprintf(stderr,
+    "Usage: %s [options] --mix TRACE[,TRACE...] [--mix ...]\n"
+    "  --grid NAME=V1,V2,...  sweep a parameter over the values; several\n"
+    "                         axes are combined into a full grid\n"
+    "  --config FILE          system config file, applied to every run\n"
+    "  --hmc-device FILE      HMC device file, applied to every run\n"
+    "  --dimm-device FILE     DIMM device file, applied to every run\n"
+    "  --set NAME=VALUE       parameter override, applied to every run\n"
+    "  --jobs N               simulations run at once (default: CPUs)\n"
+    "  --json                 print JSON instead of CSV\n"
+    "  --self-profile         time the phases of every run's simulation\n"
+    "                         loop, reported in the JSON (make PROFILE=1)\n"
+    "  --output FILE          write the table to FILE (default: stdout)\n"
+    "  --log-dir DIR          keep each run's full report in DIR/run-N.txt\n",
+    program);
+}
+
+int main(int argc, char * argv[])
+{
+  sweep_t sweep;
+  int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  int json = 0;
+  const char * output = NULL;
+
+  memset(&sweep, 0, sizeof(sweep));
+  for (int i=1; i < argc; i++) {
+    const char * arg = argv[i];
+    if (!strcmp(arg, "--json")) {
+      json = 1;
+      continue;
+    }
+    if (!strcmp(arg, "--self-profile")) {
+      sweep.self_profile = 1;
+      continue;
+    }
+    if (i+1 == argc) {
+      usage(argv[0]);
+      return -3;
+    }
+    char * value = argv[++i];
+    if (!strcmp(arg, "--grid")) {
+      if (add_grid_axis(&sweep, value)) return -3;
+    }
+    else if (!strcmp(arg, "--mix")) {
+      if (add_mix(&sweep, value)) return -3;
+    }
+    else if (!strcmp(arg, "--jobs"))
+      jobs = atoi(value);
+    else if (!strcmp(arg, "--output"))
+      output = value;
+    else if (!strcmp(arg, "--log-dir"))
+      sweep.log_dir = value;
+    else if (sweep.num_options < MAX_OPTIONS && (!strcmp(arg, "--config") || !strcmp(arg, "--hmc-device") || !strcmp(arg, "--dimm-device") || !strcmp(arg, "--set"))) {
+      sweep_option_t * option = &sweep.option[sweep.num_options++];
+      option->section = !strcmp(arg, "--hmc-device") ? "HMC" : !strcmp(arg, "--dimm-device") ? "DIMM" : NULL;
+      option->config_file = strcmp(arg, "--set") ? value : NULL;
+      option->assignment = value;
+    }
+    else {
+      usage(argv[0]);
+      return -3;
+    }
+  }
+  if (sweep.num_mixes == 0) {
+    usage(argv[0]);
+    return -3;
+  }
+  if (jobs < 1)
+    jobs = 1;
+
+  /* Check every option and grid value once before starting. */
+  usimm_sim_t * probe = usimm_sim_create();
+  probe->out = stderr;
+  int status = configure(&sweep, probe, 0);
+  sweep.num_points = 1;
+  for (int a=0; a < sweep.num_axes; a++) {
+    for (int v=0; v < sweep.axis[a].num_values && !status; v++) {
+      char assignment[128];
+      snprintf(assignment, sizeof(assignment), "%s=%s", sweep.axis[a].name, sweep.axis[a].values[v]);
+      status = usimm_sim_set(probe, assignment);
+    }
+    sweep.num_points *= sweep.axis[a].num_values;
+  }
+  usimm_sim_destroy(probe);
+  if (status)
+    return status;
+
+  status = load_traces(&sweep);
+  if (status)
+    return status;
+
+  sweep.num_runs = sweep.num_mixes * sweep.num_points;
+  sweep.run = (sweep_run_t *)calloc(sweep.num_runs, sizeof(sweep_run_t));
+  for (int r=0; r < sweep.num_runs; r++) {
+    sweep.run[r].mix = r / sweep.num_points;
+    sweep.run[r].point = r % sweep.num_points;
+  }
+
+  if (jobs > sweep.num_runs)
+    jobs = sweep.num_runs;
+  pthread_t * thread = (pthread_t *)calloc(jobs, sizeof(pthread_t));
+  int started = 0;
+  for (; started < jobs-1; started++)
+    if (pthread_create(&thread[started], NULL, sweep_worker_main, &sweep))
+      break;
+  sweep_worker_main(&sweep);
+  for (int t=0; t < started; t++)
+    pthread_join(thread[t], NULL);
+  free(thread);
+
+  FILE * f = output ? fopen(output, "w") : stdout;
+  if (f == NULL) {
+    fprintf(stderr, "Could not create %s.  Quitting.\n", output);
+    return -6;
+  }
+  print_results(&sweep, f, json);
+  if (output)
+    fclose(f);
+
+  status = 0;
+  for (int r=0; r < sweep.num_runs; r++)
+    if (sweep.run[r].status) {
+      fprintf(stderr, "Run %d failed with status %d\n", r, sweep.run[r].status);
+      if (sweep.run[r].messages)
+        fputs(sweep.run[r].messages, stderr);
+      status = sweep.run[r].status;
+    }
+  for (int r=0; r < sweep.num_runs; r++)
+    free(sweep.run[r].messages);
+
+  for (int t=0; t < sweep.num_trace_files; t++)
+    unload_trace(&sweep.trace_data[t]);
+  free(sweep.trace_data);
+  free(sweep.trace_file);
+  free(sweep.run);
+  for (int m=0; m < sweep.num_mixes; m++)
+    free(sweep.mix[m].spec);
+  free(sweep.mix);
+  for (int a=0; a < sweep.num_axes; a++)
+    free(sweep.axis[a].values);
+  return status;
+}
@@ -0,0 +1,207 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "synth.h"
+
+#define SYNTH_LINE 64LL
+#define SYNTH_DIMM_BIT (1LL << 36)
+
+static const char * pattern_names[] = {"stream", "strided", "random", "hotset", "rowconflict", "writeheavy"};
+#define NUM_PATTERNS ((int)(sizeof(pattern_names)/sizeof(pattern_names[0])))
+
+// A size with an optional K, M or G suffix; -1 if malformed
+static long long int parse_size(const char * text)
+{
+	char * end;
+	long long int value = strtoll(text, &end, 0);
+
+	if(end == text || value < 0)
+		return -1;
+	switch(*end)
+	{
+		case 'K': case 'k': value <<= 10; end++; break;
+		case 'M': case 'm': value <<= 20; end++; break;
+		case 'G': case 'g': value <<= 30; end++; break;
+	}
+	return *end ? -1 : value;
+}
+
+static int parse_percent(const char * text, int * percent)
+{
+	long long int value = parse_size(text);
+	if(value < 0 || value > 100)
+		return -1;
+	*percent = (int)value;
+	return 0;
+}
+
+int parse_synth_spec(synth_spec_t * spec, const char * text)
+{
+	char buffer[256];
+	int read_percent_given = 0;
+
+	memset(spec, 0, sizeof(synth_spec_t));
+	spec->records = 100000;
+	spec->read_percent = 70;
+	spec->footprint = 64LL << 20;
+	spec->gap = 10;
+	spec->stride = 4096;
+	spec->hot_set = 1LL << 20;
+	spec->hot_percent = 90;
+	spec->row_distance = 16LL << 20;
+	spec->seed = 1;
+
+	if(strlen(text) >= sizeof(buffer))
+		return -3;
+	strcpy(buffer, text);
+
+	char * save;
+	char * item = strtok_r(buffer, ",:", &save);
+	if(item == NULL)
+		return -3;
+	int p;
+	for(p=0; p<NUM_PATTERNS && strcmp(item, pattern_names[p]); p++)
+		;
+	if(p == NUM_PATTERNS)
+		return -3;
+	spec->pattern = (synth_pattern_t)p;
+
+	while((item = strtok_r(NULL, ",:", &save)))
+	{
+		char * value = strchr(item, '=');
+		long long int size;
+		int bad = 0;
+
+		if(value == NULL)
+			return -3;
+		*value++ = '\0';
+		size = parse_size(value);
+		if(!strcmp(item, "records"))
+			bad = (spec->records = size) <= 0;
+		else if(!strcmp(item, "reads"))
+		{
+			bad = parse_percent(value, &spec->read_percent);
+			read_percent_given = 1;
+		}
+		else if(!strcmp(item, "footprint"))
+			bad = (spec->footprint = size) < SYNTH_LINE || size > SYNTH_DIMM_BIT;
+		else if(!strcmp(item, "dimm"))
+			bad = parse_percent(value, &spec->dimm_percent);
+		else if(!strcmp(item, "gap"))
+		{
+			bad = size < 0 || size > 1000000;
+			spec->gap = (int)size;
+		}
+		else if(!strcmp(item, "stride"))
+			bad = (spec->stride = size) <= 0;
+		else if(!strcmp(item, "hot"))
+			bad = (spec->hot_set = size) < SYNTH_LINE;
+		else if(!strcmp(item, "hotshare"))
+			bad = parse_percent(value, &spec->hot_percent);
+		else if(!strcmp(item, "rowdist"))
+			bad = (spec->row_distance = size) < SYNTH_LINE;
+		else if(!strcmp(item, "seed"))
+		{
+			bad = size < 0;
+			spec->seed = (unsigned long long int)size;
+		}
+		else
+			bad = 1;
+		if(bad)
+			return -3;
+	}
+	if(spec->pattern == SYNTH_WRITEHEAVY && !read_percent_given)
+		spec->read_percent = 20;
+	if(spec->hot_set > spec->footprint)
+		spec->hot_set = spec->footprint;
+	return 0;
+}
+
+// xorshift64*: the same spec must give the same trace on every host
+static unsigned long long int next_random(unsigned long long int * state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+static long long int random_line(unsigned long long int * state, long long int bytes)
+{
+	long long int lines = bytes / SYNTH_LINE;
+	return (long long int)(next_random(state) % (lines ? lines : 1)) * SYNTH_LINE;
+}
+
+static long long int next_address(const synth_spec_t * spec, unsigned long long int * state, long long int i)
+{
+	switch(spec->pattern)
+	{
+		case SYNTH_STREAM:
+			return (i * SYNTH_LINE) % (spec->footprint - spec->footprint % SYNTH_LINE);
+		case SYNTH_STRIDED:
+			return ((i * spec->stride) % spec->footprint) & ~(SYNTH_LINE-1);
+		case SYNTH_HOTSET:
+			if((int)(next_random(state) % 100) < spec->hot_percent)
+				return random_line(state, spec->hot_set);
+			return random_line(state, spec->footprint);
+		case SYNTH_ROWCONFLICT:
+		{
+			// Addresses a multiple of a large power of two apart differ
+			// only in their row bits under every address mapping.
+			long long int rows = spec->footprint / spec->row_distance;
+			return (long long int)(next_random(state) % (rows > 2 ? rows : 2)) * spec->row_distance;
+		}
+		default:
+			return random_line(state, spec->footprint);
+	}
+}
+
+int generate_trace(trace_data_t * data, const synth_spec_t * spec)
+{
+	unsigned long long int state = spec->seed * 0x9E3779B97F4A7C15ULL + 1;
+
+	memset(data, 0, sizeof(trace_data_t));
+	data->decoded = (trace_record_t*)calloc(spec->records, sizeof(trace_record_t));
+	if(data->decoded == NULL)
+		return -1;
+
+	for(long long int i=0; i<spec->records; i++)
+	{
+		trace_record_t * r = &data->decoded[i];
+
+		r->addr = next_address(spec, &state, i);
+		if((int)(next_random(&state) % 100) < spec->dimm_percent)
+			r->addr |= SYNTH_DIMM_BIT;
+		r->nonmemops = spec->gap ? (int)(next_random(&state) % (2 * spec->gap + 1)) : 0;
+		if((int)(next_random(&state) % 100) < spec->read_percent)
+		{
+			r->optype = 'R';
+			r->instrpc = 0x400000 + (long long int)(next_random(&state) % 1024) * 4;
+		}
+		else
+			r->optype = 'W';
+	}
+	data->records = data->decoded;
+	data->num_records = spec->records;
+	return 0;
+}
+
+int write_text_trace(FILE * f, const trace_data_t * data)
+{
+	for(long long int i=0; i<data->num_records; i++)
+	{
+		const trace_record_t * r = &data->records[i];
+		int written;
+
+		if(r->optype == 'R')
+			written = fprintf(f, "%d R 0x%llx 0x%llx\n", r->nonmemops, (unsigned long long int)r->addr, (unsigned long long int)r->instrpc);
+		else
+			written = fprintf(f, "%d W 0x%llx\n", r->nonmemops, (unsigned long long int)r->addr);
+		if(written < 0)
+			return -1;
+	}
+	return 0;
+}
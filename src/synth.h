@@ -0,0 +1,67 @@
+#ifndef __SYNTH_H__
+#define __SYNTH_H__
+
+#include "trace.h"
+
+// Synthetic traces, generated in memory from a spec such as
+//
+//   random,records=1000000,reads=70,footprint=256M,dimm=25
+//
+// which names a pattern followed by optional settings:
+//
+//   stream       consecutive cache lines through the footprint
+//   strided      every 'stride' bytes through the footprint
+//   random       uniformly random lines of the footprint
+//   hotset       'hotshare'% of the accesses to the first 'hot' bytes,
+//                the rest random over the footprint
+//   rowconflict  random rows 'rowdist' bytes apart, all in one bank
+//   writeheavy   random, with 20% reads by default
+//
+//   records    memory operations (default 100000)
+//   reads      percent of reads, the rest are writes (default 70)
+//   footprint  bytes of memory touched (default 64M)
+//   dimm       percent of the accesses with address bit 36 set, which
+//              places them in the DIMM region (default 0)
+//   gap        mean non-memory instructions between memory operations
+//              (default 10)
+//   stride, hot, hotshare, rowdist   see the patterns (defaults 4K,
+//              1M, 90, 16M)
+//   seed       random seed (default 1)
+//
+// Settings are separated by ',' or ':' (the latter inside a usimm-sweep
+// mix) and sizes take a K, M or G suffix. The same spec always gives
+// the same trace. Anywhere a trace file is accepted, "gen:" followed by
+// a spec stands for the generated trace.
+
+#define SYNTH_PREFIX "gen:"
+
+typedef enum {SYNTH_STREAM, SYNTH_STRIDED, SYNTH_RANDOM, SYNTH_HOTSET, SYNTH_ROWCONFLICT, SYNTH_WRITEHEAVY} synth_pattern_t;
+
+typedef struct synthspec
+{
+  synth_pattern_t pattern;
+  long long int records;
+  int read_percent;
+  long long int footprint;
+  int dimm_percent;
+  int gap;
+  long long int stride;
+  long long int hot_set;
+  int hot_percent;
+  long long int row_distance;
+  unsigned long long int seed;
+} synth_spec_t;
+
+// Parse a spec (without the "gen:" prefix). Returns 0 on success and
+// -3 if the spec is invalid.
+int parse_synth_spec(synth_spec_t * spec, const char * text);
+
+// Generate the trace into data, to be released with unload_trace().
+// Returns 0 on success and -1 if out of memory.
+int generate_trace(trace_data_t * data, const synth_spec_t * spec);
+
+// Write a trace in the text format: "<nonmemops> R <addr> <pc>" and
+// "<nonmemops> W <addr>" lines. Returns 0 on success.
+int write_text_trace(FILE * f, const trace_data_t * data);
+
+#endif //__SYNTH_H__
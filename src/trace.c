@@ -0,0 +1,389 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "trace.h"
+#include "synth.h"
+#include "synth.h"
+
+#define MAXTRACELINESIZE 64
+
+// records buffered ahead per trace by the prefetch thread
+#define TRACE_RING_SIZE 4096
+
+typedef struct traceslot
+{
+  trace_record_t record;
+  int status; // read_trace() result for this slot
+} trace_slot_t;
+
+// head is only written by the simulator, tail only by the prefetch
+// thread; each publishes with a release store that the other side
+// reads with an acquire load. They sit on separate cache lines.
+typedef struct tracering
+{
+  long long int head;
+  char pad0[64 - sizeof(long long int)];
+  long long int tail;
+  char pad1[64 - sizeof(long long int)];
+  int done; // final status pushed (prefetch thread only)
+  trace_slot_t slot[TRACE_RING_SIZE];
+} trace_ring_t;
+
+static int open_binary_trace(trace_t * trace, const char * filename)
+{
+	struct stat st;
+	int fd = open(filename, O_RDONLY);
+
+	if(fd < 0)
+		return -1;
+	if(fstat(fd, &st) < 0 || st.st_size < TRACE_MAGIC_SIZE || (st.st_size - TRACE_MAGIC_SIZE) % sizeof(trace_record_t))
+	{
+		close(fd);
+		return -2;
+	}
+
+	trace->map_size = st.st_size;
+	trace->map = (char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(trace->map == MAP_FAILED)
+	{
+		trace->map = NULL;
+		return -1;
+	}
+	posix_madvise(trace->map, st.st_size, POSIX_MADV_SEQUENTIAL);
+
+	trace->records = (const trace_record_t*)(trace->map + TRACE_MAGIC_SIZE);
+	trace->num_records = (st.st_size - TRACE_MAGIC_SIZE) / sizeof(trace_record_t);
+	return 0;
+}
+
+static int open_synthetic_trace(trace_t * trace, const char * spec_text)
+{
+	synth_spec_t spec;
+	trace_data_t data;
+
+	if(parse_synth_spec(&spec, spec_text) < 0)
+		return -3;
+	if(generate_trace(&data, &spec) < 0)
+		return -1;
+
+	trace->generated = data.decoded;
+	trace->records = data.records;
+	trace->num_records = data.num_records;
+	return 0;
+}
+
+int open_trace(trace_t * trace, const char * filename)
+{
+	char magic[TRACE_MAGIC_SIZE];
+
+	memset(trace, 0, sizeof(trace_t));
+	if(!strncmp(filename, SYNTH_PREFIX, strlen(SYNTH_PREFIX)))
+		return open_synthetic_trace(trace, filename + strlen(SYNTH_PREFIX));
+
+	FILE * f = fopen(filename, "r");
+	if(!f)
+		return -1;
+
+	if(fread(magic, 1, TRACE_MAGIC_SIZE, f) == TRACE_MAGIC_SIZE && !memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_SIZE))
+	{
+		fclose(f);
+		return open_binary_trace(trace, filename);
+	}
+
+	rewind(f);
+	trace->text = f;
+	return 0;
+}
+
+static int decode_trace(trace_t * trace, int * nonmemops, char * optype, long long int * addr, long long int * instrpc)
+{
+	char newstr[MAXTRACELINESIZE];
+
+	if(!trace->text)
+	{
+		if(trace->next_record == trace->num_records)
+			return trace->end_status;
+
+		const trace_record_t * r = &trace->records[trace->next_record++];
+		*nonmemops = r->nonmemops;
+		*optype = r->optype;
+		*addr = r->addr;
+		if(r->optype == 'R')
+			*instrpc = r->instrpc;
+		return 1;
+	}
+
+	if(!fgets(newstr, MAXTRACELINESIZE, trace->text))
+		return 0;
+
+	if (sscanf(newstr,"%d %c",nonmemops,optype) > 0) {
+		if (*optype == 'R') {
+			if (sscanf(newstr,"%d %c %Lx %Lx",nonmemops,optype,addr,instrpc) < 1)
+				return -4;
+		}
+		else {
+			if (*optype == 'W') {
+				if (sscanf(newstr,"%d %c %Lx",nonmemops,optype,addr) < 1)
+					return -3;
+			}
+			else
+				return -2;
+		}
+	}
+	else
+		return -1;
+
+	return 1;
+}
+
+// Pop the next record decoded by the prefetch thread, waiting for it if
+// the thread has fallen behind. End of trace and errors stay at the
+// head of the ring so that they are returned again on later calls.
+static int pop_prefetched(trace_ring_t * ring, int * nonmemops, char * optype, long long int * addr, long long int * instrpc)
+{
+	long long int head = ring->head;
+
+	while(__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == head)
+		sched_yield();
+
+	const trace_slot_t * slot = &ring->slot[head % TRACE_RING_SIZE];
+	if(slot->status <= 0)
+		return slot->status;
+
+	*nonmemops = slot->record.nonmemops;
+	*optype = slot->record.optype;
+	*addr = slot->record.addr;
+	if(slot->record.optype == 'R')
+		*instrpc = slot->record.instrpc;
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+int read_trace(trace_t * trace, int * nonmemops, char * optype, long long int * addr, long long int * instrpc)
+{
+	int status;
+
+	if(trace->ring)
+		status = pop_prefetched(trace->ring, nonmemops, optype, addr, instrpc);
+	else
+		status = decode_trace(trace, nonmemops, optype, addr, instrpc);
+	if(status > 0)
+		trace->records_read++;
+	return status;
+}
+
+int skip_trace(trace_t * trace, long long int num_records)
+{
+	trace_record_t r;
+
+	if(!trace->text)
+	{
+		if(num_records > trace->num_records - trace->next_record)
+			return 0;
+		trace->next_record += num_records;
+		trace->records_read += num_records;
+		return 1;
+	}
+
+	memset(&r, 0, sizeof(r));
+	for(long long int i=0; i<num_records; i++)
+	{
+		int status = read_trace(trace, &r.nonmemops, &r.optype, &r.addr, &r.instrpc);
+		if(status <= 0)
+			return status;
+	}
+	return 1;
+}
+
+void close_trace(trace_t * trace)
+{
+	if(trace->text)
+		fclose(trace->text);
+	if(trace->map)
+		munmap(trace->map, trace->map_size);
+	free(trace->generated);
+	memset(trace, 0, sizeof(trace_t));
+}
+
+/********************************************************/
+/*	Shared traces					*/
+/********************************************************/
+
+int load_trace(trace_data_t * data, const char * filename)
+{
+	trace_t trace;
+	trace_record_t last;
+	long long int capacity = 0;
+	int opened = open_trace(&trace, filename);
+
+	memset(data, 0, sizeof(trace_data_t));
+	if(opened < 0)
+		return opened;
+
+	if(!trace.text)
+	{
+		// the mapping or generated records move over to the shared data
+		data->map = trace.map;
+		data->map_size = trace.map_size;
+		data->decoded = trace.generated;
+		data->records = trace.records;
+		data->num_records = trace.num_records;
+		return 0;
+	}
+
+	memset(&last, 0, sizeof(last));
+	while((data->status = decode_trace(&trace, &last.nonmemops, &last.optype, &last.addr, &last.instrpc)) > 0)
+	{
+		if(data->num_records == capacity)
+		{
+			capacity = capacity ? 2 * capacity : 4096;
+			trace_record_t * grown = (trace_record_t*)realloc(data->decoded, capacity * sizeof(trace_record_t));
+			if(grown == NULL)
+			{
+				close_trace(&trace);
+				unload_trace(data);
+				return -1;
+			}
+			data->decoded = grown;
+		}
+		data->decoded[data->num_records++] = last;
+	}
+	data->records = data->decoded;
+	close_trace(&trace);
+	return 0;
+}
+
+void attach_trace(trace_t * trace, const trace_data_t * data)
+{
+	memset(trace, 0, sizeof(trace_t));
+	trace->records = data->records;
+	trace->num_records = data->num_records;
+	trace->end_status = data->status;
+}
+
+void unload_trace(trace_data_t * data)
+{
+	if(data->map)
+		munmap(data->map, data->map_size);
+	free(data->decoded);
+	memset(data, 0, sizeof(trace_data_t));
+}
+
+/********************************************************/
+/*	Prefetch thread					*/
+/********************************************************/
+
+struct traceprefetch
+{
+  pthread_t thread;
+  trace_t * traces;
+  int num_traces;
+  int stop;
+};
+
+static void * prefetch_main(void * arg)
+{
+	trace_prefetch_t * prefetch = (trace_prefetch_t*)arg;
+	// decoded values carry over between text lines, as in read_trace
+	trace_record_t * last = (trace_record_t*)calloc(prefetch->num_traces, sizeof(trace_record_t));
+
+	while(!__atomic_load_n(&prefetch->stop, __ATOMIC_ACQUIRE))
+	{
+		int live = 0;
+		int progress = 0;
+
+		for(int i=0; i<prefetch->num_traces; i++)
+		{
+			trace_ring_t * ring = prefetch->traces[i].ring;
+
+			if(ring->done)
+				continue;
+			live++;
+
+			long long int tail = ring->tail;
+			while(tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) < TRACE_RING_SIZE)
+			{
+				trace_slot_t * slot = &ring->slot[tail % TRACE_RING_SIZE];
+
+				slot->status = decode_trace(&prefetch->traces[i], &last[i].nonmemops, &last[i].optype, &last[i].addr, &last[i].instrpc);
+				slot->record = last[i];
+				__atomic_store_n(&ring->tail, ++tail, __ATOMIC_RELEASE);
+				progress = 1;
+				if(slot->status <= 0)
+				{
+					ring->done = 1;
+					break;
+				}
+			}
+		}
+		if(!live)
+			break;
+		if(!progress)
+		{
+			// every ring is full: let the simulator catch up
+			struct timespec wait = {0, 20000};
+			nanosleep(&wait, NULL);
+		}
+	}
+	free(last);
+	return NULL;
+}
+
+static void free_prefetch_rings(trace_t * traces, int num_traces)
+{
+	for(int i=0; i<num_traces; i++)
+	{
+		free(traces[i].ring);
+		traces[i].ring = NULL;
+	}
+}
+
+trace_prefetch_t * start_trace_prefetch(trace_t * traces, int num_traces)
+{
+	trace_prefetch_t * prefetch = (trace_prefetch_t*)calloc(1, sizeof(trace_prefetch_t));
+
+	if(prefetch == NULL)
+		return NULL;
+	for(int i=0; i<num_traces; i++)
+	{
+		traces[i].ring = (trace_ring_t*)calloc(1, sizeof(trace_ring_t));
+		if(traces[i].ring == NULL)
+		{
+			free_prefetch_rings(traces, num_traces);
+			free(prefetch);
+			return NULL;
+		}
+	}
+	prefetch->traces = traces;
+	prefetch->num_traces = num_traces;
+
+	if(pthread_create(&prefetch->thread, NULL, prefetch_main, prefetch))
+	{
+		free_prefetch_rings(traces, num_traces);
+		free(prefetch);
+		return NULL;
+	}
+	return prefetch;
+}
+
+void stop_trace_prefetch(trace_prefetch_t * prefetch)
+{
+	if(prefetch == NULL)
+		return;
+
+	__atomic_store_n(&prefetch->stop, 1, __ATOMIC_RELEASE);
+	pthread_join(prefetch->thread, NULL);
+	free_prefetch_rings(prefetch->traces, prefetch->num_traces);
+	free(prefetch);
+}
@@ -0,0 +1,90 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdio.h>
+
+// Trace input. A trace is either the original text format, one
+// "<nonmemops> R <addr> <pc>" or "<nonmemops> W <addr>" per line, or
+// the binary format written by usimm-trace-convert: the 8-byte magic
+// below followed by fixed-size records in host byte order. Binary
+// traces are mmapped and decoded without any per-record syscall or
+// parsing. A name starting with "gen:" is a synthetic trace generated
+// in memory instead (see synth.h).
+
+#define TRACE_MAGIC "USIMMBT1"
+#define TRACE_MAGIC_SIZE 8
+
+typedef struct tracerecord
+{
+  long long int addr;
+  long long int instrpc; // pc of the instruction (reads only)
+  int nonmemops; // non-memory instructions preceding this op
+  char optype; // 'R' or 'W'
+  char pad[3];
+} trace_record_t;
+
+struct tracering;
+
+typedef struct tracefile
+{
+  struct tracering * ring; // filled by the prefetch thread when it runs
+  FILE * text; // text trace, NULL for binary
+  char * map; // mmapped binary trace
+  long long int map_size;
+  const trace_record_t * records;
+  long long int num_records;
+  long long int next_record;
+  int end_status; // read_trace() result once the records run out
+  long long int records_read; // memory operations returned so far
+  trace_record_t * generated; // records of a synthetic trace
+} trace_t;
+
+// Open a trace of either format. Returns 0 on success, -1 if the file
+// can not be opened, -2 if a binary trace is malformed and -3 if a
+// synthetic trace spec is invalid.
+int open_trace(trace_t * trace, const char * filename);
+
+// Read the next memory operation. Returns 1 if one was read, 0 at the
+// end of the trace and a negative code on a malformed text line. As
+// with the original reader, fields missing from a text line keep their
+// previous values.
+int read_trace(trace_t * trace, int * nonmemops, char * optype, long long int * addr, long long int * instrpc);
+
+void close_trace(trace_t * trace);
+
+// Pass over the next num_records memory operations, as when resuming
+// from a checkpoint; must be called before any prefetch is started.
+// Returns 1 on success and otherwise what read_trace() returned.
+int skip_trace(trace_t * trace, long long int num_records);
+
+// A trace loaded once and shared read-only by any number of traces
+// (and simulations, on any thread): binary traces are mapped, text
+// traces decoded into memory up to the end or the first malformed
+// line, whose read_trace() result is kept in 'status'.
+typedef struct tracedata
+{
+  char * map;
+  long long int map_size;
+  trace_record_t * decoded; // text traces only
+  const trace_record_t * records;
+  long long int num_records;
+  int status;
+} trace_data_t;
+
+// Load a trace of either format. Returns as open_trace().
+int load_trace(trace_data_t * data, const char * filename);
+
+// Read a loaded trace from the start. The data must outlive the trace.
+void attach_trace(trace_t * trace, const trace_data_t * data);
+
+void unload_trace(trace_data_t * data);
+
+// Optional background reader: one thread decodes all the given traces
+// ahead of the simulation into a single-producer/single-consumer ring
+// per trace, and read_trace() then only pops pre-decoded records.
+// Returns the reader, or NULL if it could not be started.
+typedef struct traceprefetch trace_prefetch_t;
+trace_prefetch_t * start_trace_prefetch(trace_t * traces, int num_traces);
+void stop_trace_prefetch(trace_prefetch_t * prefetch);
+
+#endif //__TRACE_H__
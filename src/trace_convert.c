@@ -0,0 +1,54 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+
+/* usimm-trace-convert: rewrite a text trace in the binary trace format
+   that usimm reads through mmap.  Both formats are accepted by usimm;
+   the binary one only saves the parsing time on long traces. */
+
+int main(int argc, char * argv[])
+{
+  trace_t in;
+  trace_record_t r;
+  long long int num_records = 0;
+  int status;
+
+  if (argc != 3) {
+    printf("Usage: %s <input trace> <output binary trace>\n", argv[0]);
+    return -1;
+  }
+
+  if (open_trace(&in, argv[1]) < 0) {
+    printf("Could not read input trace %s.  Quitting.\n", argv[1]);
+    return -5;
+  }
+
+  FILE * out = fopen(argv[2], "wb");
+  if (!out) {
+    printf("Could not create output trace %s.  Quitting.\n", argv[2]);
+    return -5;
+  }
+  fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_SIZE, out);
+
+  memset(&r, 0, sizeof(r));
+  while ((status = read_trace(&in, &r.nonmemops, &r.optype, &r.addr, &r.instrpc)) > 0) {
+    if (fwrite(&r, sizeof(r), 1, out) != 1) {
+      printf("Write error on %s.  Quitting.\n", argv[2]);
+      return -6;
+    }
+    num_records++;
+  }
+  if (status < 0) {
+    printf("Panic.  Poor trace format at record %lld.\n", num_records);
+    return status;
+  }
+
+  close_trace(&in);
+  if (fclose(out)) {
+    printf("Write error on %s.  Quitting.\n", argv[2]);
+    return -6;
+  }
+  printf("Converted %lld records from %s to %s\n", num_records, argv[1], argv[2]);
+  return 0;
+}
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+#include "synth.h"
+
+/* usimm-trace-gen: write a synthetic trace (see synth.h for the spec)
+   in the text trace format, to a file or to standard output.  usimm
+   can also take the spec directly as "gen:<spec>" without a file. */
+
+int main(int argc, char * argv[])
+{
+  synth_spec_t spec;
+  trace_data_t data;
+  const char * spec_text;
+  FILE * out = stdout;
+
+  if (argc != 2 && argc != 3) {
+    printf("Usage: %s <pattern>[,<setting>=<value>...] [output trace]\n", argv[0]);
+    printf("Patterns: stream strided random hotset rowconflict writeheavy\n");
+    printf("Settings: records reads footprint dimm gap stride hot hotshare rowdist seed\n");
+    return -1;
+  }
+
+  spec_text = argv[1];
+  if (!strncmp(spec_text, SYNTH_PREFIX, strlen(SYNTH_PREFIX)))
+    spec_text += strlen(SYNTH_PREFIX);
+  if (parse_synth_spec(&spec, spec_text) < 0) {
+    fprintf(stderr, "Panic.  Bad trace spec %s.\n", argv[1]);
+    return -3;
+  }
+  if (generate_trace(&data, &spec) < 0) {
+    fprintf(stderr, "Out of memory for %lld records.  Quitting.\n", spec.records);
+    return -6;
+  }
+
+  if (argc == 3 && !(out = fopen(argv[2], "w"))) {
+    fprintf(stderr, "Could not create output trace %s.  Quitting.\n", argv[2]);
+    return -5;
+  }
+  if (write_text_trace(out, &data) < 0 || fclose(out)) {
+    fprintf(stderr, "Write error on %s.  Quitting.\n", argc == 3 ? argv[2] : "standard output");
+    return -6;
+  }
+  unload_trace(&data);
+  return 0;
+}
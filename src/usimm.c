@@ -0,0 +1,1175 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "configfile.h"
+#include "usimm.h"
+#include "checkpoint.h"
+
+/* A read's completion time until the memory system returns it. */
+#define BIGNUM 1000000
+
+/* Clock calendar.  The processor, each memory channel and the SerDes
+   links fire on multiples of their clock multiplier of the base tick.
+   Instead of stepping CYCLE_VAL one base tick at a time and testing
+   every domain with a modulo, keep the next tick on which each domain
+   fires and jump straight to the earliest one. */
+static void init_clock_calendar(usimm_sim_t * sim)
+{
+  for (int d=0; d < NUM_CLOCK_DOMAINS; d++) {
+    sim->clock_period[d] = 0;
+    sim->clock_next_tick[d] = 0;
+  }
+  sim->clock_period[CLK_PROCESSOR] = sim->PROCESSOR_CLK_MULTIPLIER;
+  if (sim->NUM_HMCS)
+    sim->clock_period[CLK_SERDES] = sim->SERDES_CLK_MULTIPLIER;
+  for (int channel=0; channel < sim->NUM_CHANNELS; channel++)
+    sim->clock_period[CLK_MEMORY+channel] = sim->MEMORY_CLK_MULTIPLIER[channel];
+}
+
+/* Does the given clock domain fire on the current tick? */
+static int clock_fires(usimm_sim_t * sim, int domain)
+{
+  return sim->clock_period[domain] && (sim->clock_next_tick[domain] == sim->CYCLE_VAL);
+}
+
+/* Reschedule the domains that fired this tick and advance CYCLE_VAL to
+   the earliest tick on which some domain fires next. */
+static void advance_clock_calendar(usimm_sim_t * sim)
+{
+  long long int next = -1;
+  for (int d=0; d < NUM_CLOCK_DOMAINS; d++) {
+    if (!sim->clock_period[d])
+      continue;
+    if (sim->clock_next_tick[d] == sim->CYCLE_VAL)
+      sim->clock_next_tick[d] += sim->clock_period[d];
+    if ((next < 0) || (sim->clock_next_tick[d] < next))
+      next = sim->clock_next_tick[d];
+  }
+  sim->CYCLE_VAL = next;
+}
+
+/* Earliest cycle after 'since' at which some core may retire or fetch an
+   instruction, or -1 if no core will do either until the memory system
+   makes progress. */
+static long long int next_processor_event(usimm_sim_t * sim, long long int since)
+{
+  long long int next = -1;
+  int all_done = 1;
+  for (int numc=0; numc < sim->NUMCORES; numc++) {
+    if (!sim->ROB[numc].tracedone && (sim->ROB[numc].inflight != sim->ROBSIZE) && !is_writeq_full(sim, numc))
+      return since+1;  /* This core is still fetching. */
+    if (sim->ROB[numc].inflight) {
+      all_done = 0;
+      /* The head retires on the first cycle after its completion time. */
+      long long int retire = sim->ROB[numc].comptime[sim->ROB[numc].head] + 1;
+      if (retire <= since)
+        return since+1;
+      if ((next < 0) || (retire < next))
+        next = retire;
+    }
+    else if (!sim->ROB[numc].tracedone)
+      all_done = 0;
+  }
+  /* Let the next processor cycle notice that the experiment is over. */
+  if (all_done && are_all_writes_completed(sim))
+    return since+1;
+  return next;
+}
+
+/* Last tick on which a clock domain fired, once the calendar has moved
+   past it. */
+static long long int clock_last_tick(usimm_sim_t * sim, int domain)
+{
+  return sim->clock_next_tick[domain] - sim->clock_period[domain];
+}
+
+/* Idle fast-forward.  When every ROB is stalled and neither the links
+   nor the memory controllers can make progress before some later cycle,
+   jump the calendar straight there instead of walking the idle ticks in
+   between.  Each domain's next event is measured from the last tick on
+   which that domain ran, since only then has it acted on everything
+   that happened before.  The skipped ticks are only credited to the
+   statistics and round-robin state they would have touched, so results
+   are unchanged.  Called right after advance_clock_calendar(). */
+static void skip_idle_cycles(usimm_sim_t * sim)
+{
+  long long int target = next_processor_event(sim, clock_last_tick(sim, CLK_PROCESSOR));
+  long long int event;
+
+  if ((target >= 0) && (target <= sim->CYCLE_VAL))
+    return;
+  for (int channel=0; channel < sim->NUM_HMCS; channel++) {
+    event = next_link_event(sim, channel, clock_last_tick(sim, CLK_SERDES));
+    if ((event >= 0) && (event <= sim->CYCLE_VAL))
+      return;
+    if ((event >= 0) && ((target < 0) || (event < target)))
+      target = event;
+  }
+  for (int channel=0; channel < sim->NUM_CHANNELS; channel++) {
+    event = next_memory_event(sim, channel, clock_last_tick(sim, CLK_MEMORY+channel));
+    if ((event >= 0) && (event <= sim->CYCLE_VAL))
+      return;
+    if ((event >= 0) && ((target < 0) || (event < target)))
+      target = event;
+  }
+  /* An epoch ends on a processor tick; stop there so that every epoch
+     row covers exactly one epoch. */
+  if (sim->epoch.length > 0) {
+    if (sim->epoch.end <= sim->CYCLE_VAL)
+      return;
+    if ((target < 0) || (sim->epoch.end < target))
+      target = sim->epoch.end;
+  }
+  if (target < 0)
+    return;
+
+  /* Nothing can happen before target: drop every tick ahead of it. */
+  long long int next = -1;
+  for (int d=0; d < NUM_CLOCK_DOMAINS; d++) {
+    if (!sim->clock_period[d])
+      continue;
+    if (sim->clock_next_tick[d] < target) {
+      long long int skipped = (target - sim->clock_next_tick[d] + sim->clock_period[d] - 1)/sim->clock_period[d];
+      if (d == CLK_SERDES) {
+        for (int channel=0; channel < sim->NUM_HMCS; channel++)
+          skip_link_cycles(sim, channel, sim->clock_next_tick[d], skipped, sim->clock_period[d]);
+      }
+      sim->clock_next_tick[d] += skipped*sim->clock_period[d];
+    }
+    if ((next < 0) || (sim->clock_next_tick[d] < next))
+      next = sim->clock_next_tick[d];
+  }
+  sim->CYCLE_VAL = next;
+}
+
+/* Parallel memory stepping.  Vaults share no state while they are
+   stepped: everything a vault leaves for the processor side is held in
+   sim->vault_updates until merge_vault_updates().  A memory tick is
+   split at the SerDes response transfer into two phases, updating the
+   vaults of every firing channel and scheduling them, and within a
+   phase the vaults are independent work items.  With
+   sim->memory_threads > 1, the simulation thread and its workers claim
+   the items of a phase from a shared counter until none are left, so
+   a thread that finishes early takes over the remaining vaults.  The
+   simulation thread starts a phase by bumping 'generation' and waits
+   for every worker to count itself 'finished'.  The order in which
+   vaults are stepped does not affect the results. */
+
+#define STEP_UPDATE 1
+#define STEP_SCHEDULE 2
+
+typedef struct vaultitem
+{
+  int channel;
+  int vault;
+} vault_item_t;
+
+struct memoryworkers
+{
+  long long int generation;
+  char pad0[64 - sizeof(long long int)];
+  int finished;
+  char pad1[64 - sizeof(int)];
+  int next_item;
+  char pad2[64 - sizeof(int)];
+  int phase; /* STEP_UPDATE and/or STEP_SCHEDULE */
+  int stop;
+  int num_items;
+  vault_item_t item[MAX_NUM_CHANNELS*MAX_NUM_VAULTS];
+  int num_threads;
+  pthread_t * thread;
+  struct memoryworker * worker;
+};
+
+struct memoryworker
+{
+  usimm_sim_t * sim;
+};
+
+/* Spin this many times on a shared flag before yielding the processor. */
+#define WORKER_SPINS 1000
+
+static void step_vault(usimm_sim_t * sim, int channel, int vault, int phase)
+{
+  if (phase & STEP_UPDATE) {
+    PROFILE_BEGIN(sim, update_start);
+    update_vault(sim, channel, vault);
+    PROFILE_END(sim, PROF_UPDATE, update_start, 0);
+  }
+  if (phase & STEP_SCHEDULE) {
+    PROFILE_BEGIN(sim, schedule_start);
+    schedule(sim, channel, vault);
+    PROFILE_END(sim, PROF_SCHEDULE, schedule_start, sim->command_issued_current_cycle[channel][vault]);
+  }
+}
+
+static void claim_vaults(usimm_sim_t * sim)
+{
+  struct memoryworkers * workers = sim->workers;
+  int i;
+
+  while ((i = __atomic_fetch_add(&workers->next_item, 1, __ATOMIC_RELAXED)) < workers->num_items)
+    step_vault(sim, workers->item[i].channel, workers->item[i].vault, workers->phase);
+}
+
+static void * memory_worker_main(void * arg)
+{
+  struct memoryworker * worker = (struct memoryworker *)arg;
+  struct memoryworkers * workers = worker->sim->workers;
+  long long int seen = 0;
+
+  while (1) {
+    long long int generation;
+    int spins = 0;
+    while ((generation = __atomic_load_n(&workers->generation, __ATOMIC_ACQUIRE)) == seen) {
+      if (++spins > WORKER_SPINS)
+        sched_yield();
+    }
+    seen = generation;
+    if (workers->stop)
+      break;
+    claim_vaults(worker->sim);
+    __atomic_add_fetch(&workers->finished, 1, __ATOMIC_RELEASE);
+  }
+  return NULL;
+}
+
+static void stop_memory_workers(usimm_sim_t * sim)
+{
+  struct memoryworkers * workers = sim->workers;
+
+  if (workers == NULL)
+    return;
+  workers->stop = 1;
+  __atomic_add_fetch(&workers->generation, 1, __ATOMIC_RELEASE);
+  for (int i=1; i < workers->num_threads; i++)
+    pthread_join(workers->thread[i], NULL);
+  free(workers->thread);
+  free(workers->worker);
+  free(workers);
+  sim->workers = NULL;
+}
+
+/* Start memory_threads-1 workers, no more than there are vaults.
+   Returns nonzero if a thread could not be started. */
+static int start_memory_workers(usimm_sim_t * sim)
+{
+  int num_threads = sim->memory_threads;
+  int num_vaults = 0;
+
+  for (int channel=0; channel < sim->NUM_CHANNELS; channel++)
+    num_vaults += sim->NUM_VAULTS[channel];
+  if (num_threads > num_vaults)
+    num_threads = num_vaults;
+  if (num_threads <= 1)
+    return 0;
+
+  struct memoryworkers * workers = (struct memoryworkers *)calloc(1, sizeof(struct memoryworkers));
+  if (workers == NULL)
+    return -1;
+  workers->thread = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+  workers->worker = (struct memoryworker *)calloc(num_threads, sizeof(struct memoryworker));
+  if (workers->thread == NULL || workers->worker == NULL) {
+    free(workers->thread);
+    free(workers->worker);
+    free(workers);
+    return -1;
+  }
+  workers->num_threads = 1;
+  sim->workers = workers;
+  for (int i=1; i < num_threads; i++) {
+    workers->worker[i].sim = sim;
+    if (pthread_create(&workers->thread[i], NULL, memory_worker_main, &workers->worker[i])) {
+      stop_memory_workers(sim);
+      return -1;
+    }
+    workers->num_threads++;
+  }
+  return 0;
+}
+
+/* Run one phase over the vaults of the channels whose clock fires. */
+static void step_vaults(usimm_sim_t * sim, int phase)
+{
+  struct memoryworkers * workers = sim->workers;
+
+  if (workers == NULL) {
+    for (int channel=0; channel < sim->NUM_CHANNELS; channel++)
+      if (clock_fires(sim, CLK_MEMORY+channel))
+        for (int vault=0; vault < sim->NUM_VAULTS[channel]; vault++)
+          step_vault(sim, channel, vault, phase);
+    return;
+  }
+
+  workers->num_items = 0;
+  for (int channel=0; channel < sim->NUM_CHANNELS; channel++) {
+    if (clock_fires(sim, CLK_MEMORY+channel)) {
+      for (int vault=0; vault < sim->NUM_VAULTS[channel]; vault++) {
+        workers->item[workers->num_items].channel = channel;
+        workers->item[workers->num_items].vault = vault;
+        workers->num_items++;
+      }
+    }
+  }
+  if (workers->num_items < 2) {
+    if (workers->num_items)
+      step_vault(sim, workers->item[0].channel, workers->item[0].vault, phase);
+    return;
+  }
+
+  workers->phase = phase;
+  workers->next_item = 0;
+  workers->finished = 0;
+  __atomic_add_fetch(&workers->generation, 1, __ATOMIC_RELEASE);
+  claim_vaults(sim);
+  int spins = 0;
+  while (__atomic_load_n(&workers->finished, __ATOMIC_ACQUIRE) != workers->num_threads-1) {
+    if (++spins > WORKER_SPINS)
+      sched_yield();
+  }
+}
+
+/* Step the memory controllers and the SerDes responses on the current
+   tick and merge the results. */
+static void step_memory_system(usimm_sim_t * sim)
+{
+  if (sim->NUM_HMCS && clock_fires(sim, CLK_SERDES)) {
+    /* Execute function to find ready instructions. */
+    step_vaults(sim, STEP_UPDATE);
+    for (int channel=0; channel < sim->NUM_HMCS; channel++)
+      PROFILE_CALL(sim, PROF_RESPONSE, transfer_response_to_PROCESSOR(sim, channel));
+    /* Execute user-provided function to select ready instructions for issue. */
+    /* Based on this selection, update DRAM data structures and set 
+       instruction completion times. */
+    step_vaults(sim, STEP_SCHEDULE);
+  }
+  else
+    step_vaults(sim, STEP_UPDATE|STEP_SCHEDULE);
+  PROFILE_BEGIN(sim, merge_start);
+  merge_vault_updates(sim);
+  PROFILE_END(sim, PROF_MERGE, merge_start, 0);
+}
+
+usimm_sim_t * usimm_sim_create()
+{
+  usimm_sim_t * sim = (usimm_sim_t *)calloc(1, sizeof(usimm_sim_t));
+  if (sim == NULL)
+    return NULL;
+  sim->out = stdout;
+  sim->config = default_config();
+  if (sim->config == NULL) {
+    free(sim);
+    return NULL;
+  }
+  sim->checkpoint_at = -1;
+  sim->sampling.warmup = 2000;
+  sim->sampling.skip = 100000;
+  sim->sampling.target_error = 0.03;
+  return sim;
+}
+
+int usimm_sim_read_config(usimm_sim_t * sim, const char * filename, const char * section)
+{
+  return read_config_file(sim, filename, section) ? -3 : 0;
+}
+
+int usimm_sim_set(usimm_sim_t * sim, const char * assignment)
+{
+  return set_config_override(sim, assignment) ? -3 : 0;
+}
+
+int usimm_sim_restore(usimm_sim_t * sim, const char * checkpoint)
+{
+  int status = read_checkpoint_config(sim, checkpoint);
+  if (status == 0)
+    sim->restore_file = checkpoint;
+  return status;
+}
+
+/* Fast-forward: consume the next 'instructions' instructions of a
+   trace functionally.  Memory operations only leave their row open in
+   its bank; no time passes and no statistic is touched.  Returns the
+   number of instructions consumed, fewer if the trace ended, or a
+   negative code on a malformed trace. */
+static long long int fast_forward(usimm_sim_t * sim, int numc, long long int instructions)
+{
+  long long int left = instructions;
+  while (left > 0 && !sim->ROB[numc].tracedone) {
+    if (sim->nonmemops[numc]) {
+      int skip = (sim->nonmemops[numc] < left) ? sim->nonmemops[numc] : (int)left;
+      sim->nonmemops[numc] -= skip;
+      left -= skip;
+      continue;
+    }
+    if (sim->opertype[numc] != 'R' && sim->opertype[numc] != 'W') {
+      fprintf(sim->out, "Panic.  Poor trace format. \n");
+      return -1;
+    }
+    warm_open_row(sim, sim->addr[numc] + (long long int)((long long int)sim->prefixtable[numc] << (sim->ADDRESS_BITS - log_base2(sim->NUMCORES))));
+    left--;
+
+    int status = read_trace(&sim->tif[numc],&sim->nonmemops[numc],&sim->opertype[numc],&sim->addr[numc],&sim->instrpc[numc]);
+    if (status < 0) {
+      fprintf(sim->out, "Panic.  Poor trace format.\n");
+      return status;
+    }
+    else if (status == 0) {
+      if (sim->ROB[numc].inflight == 0) {
+        if (!sim->time_done[numc]) sim->time_done[numc] = sim->CYCLE_VAL ? sim->CYCLE_VAL : 1;
+      }
+      sim->ROB[numc].tracedone=1;
+    }
+  }
+  return instructions - left;
+}
+
+/* Sampled simulation (see sampling_t in usimm.h). */
+
+static long long int total_committed(usimm_sim_t * sim)
+{
+  long long int committed = 0;
+  for (int numc = 0; numc < sim->NUMCORES; numc++)
+    committed += sim->committed[numc];
+  return committed;
+}
+
+static void take_sample_point(usimm_sim_t * sim, sample_point_t * point)
+{
+  memset(point, 0, sizeof(sample_point_t));
+  point->cycle = sim->CYCLE_VAL;
+  point->committed = total_committed(sim);
+  for (int c=0; c < sim->NUM_CHANNELS; c++) {
+    for (int v=0; v < sim->NUM_VAULTS[c]; v++) {
+      point->reads_completed += sim->stats_reads_completed[c][v];
+      point->read_latency += sim->stats_average_read_latency[c][v] * sim->stats_reads_completed[c][v];
+      /* calculate_power gives the average power since cycle 0. */
+      for (int r=0; sim->CYCLE_VAL && r < sim->NUM_RANKS[c]; r++)
+        point->memory_energy += (double)calculate_power(sim, c, v, r, 2, -1) * sim->CYCLE_VAL;
+    }
+  }
+}
+
+static void add_sample(sampling_t * sampling, int metric, double value)
+{
+  sampling->num_samples[metric]++;
+  sampling->sum[metric] += value;
+  sampling->sum_sq[metric] += value * value;
+}
+
+static double sample_mean(const sampling_t * sampling, int metric)
+{
+  return sampling->num_samples[metric] ? sampling->sum[metric] / sampling->num_samples[metric] : 0;
+}
+
+/* Half-width of the 95% confidence interval of a metric's mean. */
+static double sample_half_width(const sampling_t * sampling, int metric)
+{
+  long long int n = sampling->num_samples[metric];
+  if (n < 2)
+    return 0;
+  double mean = sampling->sum[metric] / n;
+  double variance = (sampling->sum_sq[metric] - n * mean * mean) / (n - 1);
+  return (variance > 0) ? 1.96 * sqrt(variance / n) : 0;
+}
+
+static int sampling_converged(const sampling_t * sampling)
+{
+  if (sampling->target_error <= 0 || sampling->num_windows < SAMPLE_MIN_WINDOWS)
+    return 0;
+  for (int m = 0; m < NUM_SAMPLE_METRICS; m++) {
+    if (sampling->num_samples[m] && sample_half_width(sampling, m) > sampling->target_error * fabs(sample_mean(sampling, m)))
+      return 0;
+  }
+  return 1;
+}
+
+/* Called at the top of every tick of a sampled run: once the current
+   phase has committed its instructions, start the next one.  Returns
+   1 when the target error has been reached, 0 to go on and a negative
+   code on a malformed trace. */
+static int step_sampling(usimm_sim_t * sim)
+{
+  sampling_t * sampling = &sim->sampling;
+  long long int committed = total_committed(sim);
+
+  if (committed < sampling->phase_end)
+    return 0;
+  if (!sampling->measuring) {
+    take_sample_point(sim, &sampling->start);
+    sampling->measuring = 1;
+    sampling->phase_end = committed + sampling->window;
+    return 0;
+  }
+
+  sample_point_t end;
+  take_sample_point(sim, &end);
+  long long int cycles = end.cycle - sampling->start.cycle;
+  long long int reads = end.reads_completed - sampling->start.reads_completed;
+  if (cycles > 0) {
+    add_sample(sampling, SAMPLE_IPC, (double)(end.committed - sampling->start.committed) * sim->PROCESSOR_CLK_MULTIPLIER / cycles);
+    add_sample(sampling, SAMPLE_MEMORY_POWER, (end.memory_energy - sampling->start.memory_energy) / cycles / 1000);
+  }
+  if (reads > 0)
+    add_sample(sampling, SAMPLE_READ_LATENCY, (end.read_latency - sampling->start.read_latency) / reads);
+  sampling->num_windows++;
+  if (sampling_converged(sampling)) {
+    sampling->converged = 1;
+    return 1;
+  }
+
+  /* Skip ahead functionally; requests in flight complete as usual. */
+  for (int numc = 0; numc < sim->NUMCORES; numc++) {
+    long long int forwarded = fast_forward(sim, numc, sampling->skip);
+    if (forwarded < 0)
+      return (int)forwarded;
+  }
+  sampling->measuring = 0;
+  sampling->phase_end = committed + sampling->warmup;
+  return 0;
+}
+
+static void print_sampling_stats(usimm_sim_t * sim)
+{
+  const sampling_t * sampling = &sim->sampling;
+  const char * names[NUM_SAMPLE_METRICS] = {"IPC", "Read latency", "Memory power (W)"};
+
+  fprintf(sim->out, "Sampled simulation: %lld windows of %lld instructions, %s\n", sampling->num_windows, sampling->window,
+          sampling->converged ? "target error reached" : "traces ended before the target error was reached");
+  for (int m = 0; m < NUM_SAMPLE_METRICS; m++) {
+    double mean = sample_mean(sampling, m);
+    double half_width = sample_half_width(sampling, m);
+    fprintf(sim->out, "Sampled %-16s : %12.6f +- %f (95%% confidence, +-%.2f%%)\n", names[m], mean, half_width,
+            mean ? 100 * half_width / fabs(mean) : 0.0);
+  }
+}
+
+/* Set up the simulation on the given trace files, or on already loaded
+   traces when 'loaded' is not NULL. */
+static int init_sim(usimm_sim_t * sim, int num_traces, char * const * trace_files, const trace_data_t * const * loaded, int trace_prefetch)
+{
+  int numc;
+  int fnstart;
+  int currMTapp;
+  int pow_of_2_cores;
+
+  if (num_traces < 1 || num_traces > MAX_NUM_CORES) {
+    fprintf(sim->out, "Panic.  Need between 1 and %d trace files.\n", MAX_NUM_CORES);
+    return -3;
+  }
+  sim->NUMCORES = num_traces;
+
+  sim->ROB = (struct robstructure *)calloc(sim->NUMCORES, sizeof(struct robstructure));
+  sim->tif = (trace_t *)calloc(sim->NUMCORES, sizeof(trace_t));
+  sim->committed = (long long int *)malloc(sizeof(long long int)*sim->NUMCORES);
+  sim->fetched = (long long int *)malloc(sizeof(long long int)*sim->NUMCORES);
+  sim->time_done = (long long int *)malloc(sizeof(long long int)*sim->NUMCORES);
+  sim->nonmemops = (int *)malloc(sizeof(int)*sim->NUMCORES);
+  sim->opertype = (char *)malloc(sizeof(char)*sim->NUMCORES);
+  sim->addr = (long long int *)malloc(sizeof(long long int)*sim->NUMCORES);
+  sim->instrpc = (long long int *)malloc(sizeof(long long int)*sim->NUMCORES);
+  sim->prefixtable = (int *)malloc(sizeof(int)*sim->NUMCORES);
+  currMTapp = -1;
+  for (numc=0; numc < sim->NUMCORES; numc++) {
+     int opened = 0;
+     if (loaded)
+       attach_trace(&sim->tif[numc], loaded[numc]);
+     else
+       opened = open_trace(&sim->tif[numc], trace_files[numc]);
+     if (opened == -1) {
+       fprintf(sim->out, "Missing input trace file %d.  Quitting. \n",numc);
+       return -5;
+     }
+     if (opened < 0) {
+       fprintf(sim->out, "Panic.  Poor trace format.\n");
+       return -1;
+     }
+
+     /* The addresses in each trace are given a prefix that equals
+		their core ID.  If the input trace starts with "MT", it is
+		assumed to be part of a multi-threaded app.  The addresses
+		from this trace file are given a prefix that equals that of
+		the last seen input trace file that starts with "MT0".  For
+		example, the following is an acceptable set of inputs for
+		multi-threaded apps CG (4 threads) and LU (2 threads):
+		usimm 1channel.cfg MT0CG MT1CG MT2CG MT3CG MT0LU MT1LU */
+     sim->prefixtable[numc] = numc;
+
+     /* Find the start of the filename.  It's after the last "/". */
+     for (fnstart = strlen(trace_files[numc]) ; fnstart >= 0; fnstart--) {
+		if (trace_files[numc][fnstart] == '/') {
+			break;
+		}
+     }
+     fnstart++;  /* fnstart is either the letter after the last / or the 0th letter. */
+
+     if ((strlen(trace_files[numc])-fnstart) > 2) {
+		if ((trace_files[numc][fnstart+0] == 'M') && (trace_files[numc][fnstart+1] == 'T')) {
+			if (trace_files[numc][fnstart+2] == '0') {
+				currMTapp = numc;
+			}
+			else {
+				if (currMTapp < 0) {
+					fprintf(sim->out, "Poor set of input parameters.  Input file %s starts with \"MT\", but there is no preceding input file starting with \"MT0\".  Quitting.\n", trace_files[numc]);
+					return -6;
+				}
+				else 
+					sim->prefixtable[numc] = currMTapp;
+			}
+		}
+     }
+     fprintf(sim->out, "Core %d: Input trace file %s : Addresses will have prefix %d\n", numc, trace_files[numc], sim->prefixtable[numc]);
+
+     sim->committed[numc]=0;
+     sim->fetched[numc]=0;
+     sim->time_done[numc]=0;
+     sim->ROB[numc].head=0;
+     sim->ROB[numc].tail=0;
+     sim->ROB[numc].inflight=0;
+     sim->ROB[numc].tracedone=0;
+  }
+
+  if (read_config_vars(sim)) {
+    return -3;
+  }
+
+  //assert((log_base2(NUM_CHANNELS) + log_base2(NUM_RANKS) + log_base2(NUM_BANKS) + log_base2(NUM_ROWS) + log_base2(NUM_COLUMNS) + log_base2(CACHE_LINE_SIZE)) == ADDRESS_BITS );
+  /* Increase the address space and rows per bank depending on the number of input traces. */
+  
+  if (sim->NUMCORES == 1) {
+    pow_of_2_cores = 1;
+  }
+  else {
+	pow_of_2_cores = 1 << ((int)log_base2(sim->NUMCORES-1) + 1);
+  }
+  
+  sim->ADDRESS_BITS = sim->ADDRESS_BITS + log_base2(sim->NUMCORES);
+  
+  for(int i=0; i<sim->NUM_CHANNELS; i++) {
+	sim->NUM_ROWS[i] = sim->NUM_ROWS[i] * pow_of_2_cores;
+  }
+
+  print_params(sim);
+
+  for(int i=0; i<sim->NUMCORES; i++)
+  {
+	  sim->ROB[i].comptime = (long long int*)malloc(sizeof(long long int)*sim->ROBSIZE);
+	  sim->ROB[i].mem_address = (long long int*)malloc(sizeof(long long int)*sim->ROBSIZE);
+	  sim->ROB[i].instrpc = (long long int*)malloc(sizeof(long long int)*sim->ROBSIZE);
+	  sim->ROB[i].optype = (int*)malloc(sizeof(int)*sim->ROBSIZE);
+  }
+  init_memory_controller_vars(sim);
+  init_scheduler_vars(sim);
+  init_clock_calendar(sim);
+  /* Done initializing. */
+
+  /* A restored run takes over the saved state, trace positions and
+     the next record of each trace included. */
+  if (sim->restore_file) {
+    int status = read_checkpoint_state(sim, sim->restore_file);
+    if (status)
+      return status;
+    if (trace_prefetch && !(sim->prefetch = start_trace_prefetch(sim->tif, sim->NUMCORES))) {
+      fprintf(sim->out, "Could not start the trace prefetch thread.  Quitting.\n");
+      return -6;
+    }
+    return 0;
+  }
+
+  if (trace_prefetch && !(sim->prefetch = start_trace_prefetch(sim->tif, sim->NUMCORES))) {
+    fprintf(sim->out, "Could not start the trace prefetch thread.  Quitting.\n");
+    return -6;
+  }
+
+  /* Must start by reading one line of each trace file. */
+  for(numc=0; numc<sim->NUMCORES; numc++)
+  {
+	int status = read_trace(&sim->tif[numc],&sim->nonmemops[numc],&sim->opertype[numc],&sim->addr[numc],&sim->instrpc[numc]);
+	if (status < 0) {
+		fprintf(sim->out, "Panic.  Poor trace format.\n");
+		return status;
+	}
+	else if (status == 0) {
+		if (sim->ROB[numc].inflight == 0) {
+	        if (!sim->time_done[numc]) sim->time_done[numc] = 1;
+	    }
+	    sim->ROB[numc].tracedone=1;
+	}
+  }
+
+  /* Warm up over the first sim->fast_forward instructions of every
+     trace; the detailed simulation then starts from cycle 0 with clean
+     statistics. */
+  for (numc = 0; sim->fast_forward > 0 && numc < sim->NUMCORES; numc++) {
+    long long int forwarded = fast_forward(sim, numc, sim->fast_forward);
+    if (forwarded < 0)
+      return (int)forwarded;
+    fprintf(sim->out, "Fast-forwarded core %d by %lld instructions.\n", numc, forwarded);
+  }
+  return 0;
+}
+
+int usimm_sim_init(usimm_sim_t * sim, int num_traces, char * const * trace_files, int trace_prefetch)
+{
+  return init_sim(sim, num_traces, trace_files, NULL, trace_prefetch);
+}
+
+int usimm_sim_init_loaded(usimm_sim_t * sim, int num_traces, char * const * trace_names, const trace_data_t * const * traces)
+{
+  return init_sim(sim, num_traces, trace_names, traces, 0);
+}
+
+/* Simulate until every trace has been consumed and every write has
+   drained. */
+static int simulate(usimm_sim_t * sim)
+{
+  int numc=0;
+  int num_ret=0;
+  int num_fetch=0;
+  int num_done=0;
+  int writeqfull;
+
+  if (sim->sampling.window > 0) {
+    sim->sampling.measuring = 0;
+    sim->sampling.phase_end = total_committed(sim) + sim->sampling.warmup;
+  }
+
+  fprintf(sim->out, "Starting simulation.\n");
+  while (!sim->expt_done) {
+
+	if (sim->sampling.window > 0) {
+		int status = step_sampling(sim);
+		if (status < 0)
+			return status;
+		if (status)
+			break;
+	}
+
+	if (sim->epoch.length > 0 && sim->CYCLE_VAL >= sim->epoch.end)
+		end_epoch(sim);
+
+	if (sim->checkpoint_at >= 0) {
+		long long int committed = total_committed(sim);
+		if (committed >= sim->checkpoint_at) {
+			int status = write_checkpoint(sim, sim->checkpoint_file);
+			if (status)
+				return status;
+			fprintf(sim->out, "Wrote checkpoint %s at cycle %lld, %lld instructions committed.\n", sim->checkpoint_file, sim->CYCLE_VAL, committed);
+			sim->checkpoint_at = -1;
+		}
+	}
+
+	if(clock_fires(sim, CLK_PROCESSOR)) {
+		PROFILE_BEGIN(sim, retire_start);
+		/* For each core, retire instructions if they have finished. */
+		for (numc = 0; numc < sim->NUMCORES; numc++) {
+			num_ret = 0;
+			while ((num_ret < sim->MAX_RETIRE) && sim->ROB[numc].inflight) {
+				/* Keep retiring until retire width is consumed or ROB is empty. */
+				if (sim->ROB[numc].comptime[sim->ROB[numc].head] < sim->CYCLE_VAL) {  
+					/* Keep retiring instructions if they are done. */
+					sim->ROB[numc].head = (sim->ROB[numc].head + 1) % sim->ROBSIZE;
+					sim->ROB[numc].inflight--;
+					sim->committed[numc]++;
+					num_ret++;
+				}
+				else  /* Instruction not complete.  Stop retirement for this core. */
+					break;
+			}  /* End of while loop that is retiring instruction for one core. */
+			PROFILE_EVENTS(sim, PROF_RETIRE, num_ret);
+		}  /* End of for loop that is retiring instructions for all cores. */
+		PROFILE_END(sim, PROF_RETIRE, retire_start, 0);
+	}
+
+	/* Step the memory controllers and the SerDes responses. */
+	step_memory_system(sim);
+	
+	if(clock_fires(sim, CLK_SERDES)) {
+		for(int channel=0; channel < sim->NUM_HMCS; channel++) {
+			PROFILE_CALL(sim, PROF_REQUEST, transfer_request_to_HMCs(sim, channel));
+		}
+	}
+
+	if(clock_fires(sim, CLK_PROCESSOR)) {
+		/* For each core, bring in new instructions from the trace file to
+		   fill up the ROB. */
+		PROFILE_BEGIN(sim, fetch_start);
+		num_done = 0;
+		
+
+		for (numc = 0; numc < sim->NUMCORES; numc++) {
+			if (!sim->ROB[numc].tracedone) { /* Try to fetch if EOF has not been encountered. */
+				num_fetch = 0;
+				writeqfull = is_writeq_full(sim, numc);
+				while ((num_fetch < sim->MAX_FETCH) && (sim->ROB[numc].inflight != sim->ROBSIZE) && (!writeqfull)) {
+					/* Keep fetching until fetch width or ROB capacity or WriteQ are fully consumed. 
+					   Read the corresponding trace file and populate the tail of the ROB data structure. 
+					   If Memop, then populate read/write queue.  Set up completion time. */
+
+					if (sim->nonmemops[numc]) {  /* Have some non-memory-ops to consume. */
+						sim->ROB[numc].optype[sim->ROB[numc].tail] = 'N';
+						sim->ROB[numc].comptime[sim->ROB[numc].tail] = sim->CYCLE_VAL+sim->PIPELINEDEPTH;
+						sim->nonmemops[numc]--;
+						sim->ROB[numc].tail = (sim->ROB[numc].tail +1) % sim->ROBSIZE;
+						sim->ROB[numc].inflight++;
+						sim->fetched[numc]++;
+						num_fetch++;
+					}
+					else { /* Done consuming non-memory-ops.  Must now consume the memory rd or wr. */
+						if (sim->opertype[numc] == 'R') {
+							sim->addr[numc] = sim->addr[numc] + (long long int)((long long int)sim->prefixtable[numc] << (sim->ADDRESS_BITS - log_base2(sim->NUMCORES)));    // Add MSB bits so each trace accesses a different address space.
+							sim->ROB[numc].mem_address[sim->ROB[numc].tail] = sim->addr[numc];
+							sim->ROB[numc].optype[sim->ROB[numc].tail] = sim->opertype[numc];
+							sim->ROB[numc].comptime[sim->ROB[numc].tail] = sim->CYCLE_VAL + BIGNUM;
+							sim->ROB[numc].instrpc[sim->ROB[numc].tail] = sim->instrpc[numc];
+			
+							// Check to see if the read is for buffered data in write queue - 
+							// return constant latency if match in WQ
+							// add in read queue otherwise
+							int lat = read_matches_write_or_read_queue(sim, sim->addr[numc], numc);
+							if(lat) {
+								sim->ROB[numc].comptime[sim->ROB[numc].tail] = sim->CYCLE_VAL+lat+sim->PIPELINEDEPTH;
+							}
+							else {
+								insert_read(sim, sim->addr[numc], sim->CYCLE_VAL, numc, sim->ROB[numc].tail, sim->instrpc[numc]);
+							}
+						}
+						else {  /* This must be a 'W'.  We are confirming that while reading the trace. */
+							if (sim->opertype[numc] == 'W') {
+								sim->addr[numc] = sim->addr[numc] + (long long int)((long long int)sim->prefixtable[numc] << (sim->ADDRESS_BITS - log_base2(sim->NUMCORES)));    // Add MSB bits so each trace accesses a different address space.
+								sim->ROB[numc].mem_address[sim->ROB[numc].tail] = sim->addr[numc];
+								sim->ROB[numc].optype[sim->ROB[numc].tail] = sim->opertype[numc];
+								sim->ROB[numc].comptime[sim->ROB[numc].tail] = sim->CYCLE_VAL+sim->PIPELINEDEPTH;
+								/* Also, add this to the write queue. */
+
+								if(!write_exists_in_write_queue(sim, sim->addr[numc], numc))
+									insert_write(sim, sim->addr[numc], sim->CYCLE_VAL, numc, sim->ROB[numc].tail);
+							}
+							else {
+								fprintf(sim->out, "Panic.  Poor trace format. \n");
+								return -1;
+							}
+						}
+						sim->ROB[numc].tail = (sim->ROB[numc].tail +1) % sim->ROBSIZE;
+						sim->ROB[numc].inflight++;
+						sim->fetched[numc]++;
+						num_fetch++;
+
+						/* Done consuming one line of the trace file.  Read in the next. */
+						PROFILE_BEGIN(sim, trace_start);
+						int status = read_trace(&sim->tif[numc],&sim->nonmemops[numc],&sim->opertype[numc],&sim->addr[numc],&sim->instrpc[numc]);
+						PROFILE_END(sim, PROF_TRACE, trace_start, status > 0);
+						if (status < 0) {
+							fprintf(sim->out, "Panic.  Poor trace format.\n");
+							return status;
+						}
+						else if (status == 0) {
+							if (sim->ROB[numc].inflight == 0) {
+								num_done++;
+								if (!sim->time_done[numc]) sim->time_done[numc] = sim->CYCLE_VAL;
+							}
+							sim->ROB[numc].tracedone=1;
+							break;  /* Break out of the while loop fetching instructions. */
+						}
+			  
+					}  /* Done consuming the next rd or wr. */
+
+				} /* One iteration of the fetch while loop done. */
+				PROFILE_EVENTS(sim, PROF_FETCH, num_fetch);
+			} /* Closing brace for if(trace not done). */
+			else { /* Input trace is done.  Check to see if all inflight instrs have finished. */
+				if (sim->ROB[numc].inflight == 0) {
+					num_done++;
+					if (!sim->time_done[numc]) sim->time_done[numc] = sim->CYCLE_VAL;
+				}
+			}
+		} /* End of for loop that goes through all cores. */
+		PROFILE_END(sim, PROF_FETCH, fetch_start, 0);
+
+
+		if (num_done == sim->NUMCORES && are_all_writes_completed(sim)) {
+			/* Traces have been consumed and in-flight windows are empty.  Must confirm that write queues have been drained. */
+			sim->expt_done=1;  /* All traces have been consumed and the write queues are drained. */
+		}
+    
+	}
+
+    /* Printing details for testing. Remove later. 
+		printf("Cycle: %lld\n", CYCLE_VAL);
+		for (numc=0; numc < NUMCORES; numc++) {
+			printf("C%d: Inf %d : Hd %d : Tl %d : Comp %lld : type %c : addr %x : TD %d\n", numc, ROB[numc].inflight, ROB[numc].head, ROB[numc].tail, ROB[numc].comptime[ROB[numc].head], ROB[numc].optype[ROB[numc].head], ROB[numc].mem_address[ROB[numc].head], ROB[numc].tracedone);
+		}*/
+
+	/* Advance the simulation cycle.  Ticks on which no clock domain fires
+	   do no work, so jump straight to the next one that does.  The final
+	   cycle count still includes the tick the experiment finished on.
+	   If the whole system is stalled, skip ahead to the next tick on
+	   which anything can happen. */
+	if (sim->expt_done)
+		sim->CYCLE_VAL++;
+	else {
+		PROFILE_BEGIN(sim, advance_start);
+		advance_clock_calendar(sim);
+		skip_idle_cycles(sim);
+		PROFILE_END(sim, PROF_ADVANCE, advance_start, 0);
+	}
+  }
+
+
+
+  if (sim->checkpoint_at >= 0)
+    fprintf(sim->out, "No checkpoint written: the run ended before %lld instructions committed.\n", sim->checkpoint_at);
+
+  /* Code to make sure that the write queue drain time is included in
+     the execution time of the thread that finishes last. */
+  long long int maxtd = sim->time_done[0];
+  int maxcr = 0;
+  for (numc=1; numc < sim->NUMCORES; numc++) {
+    if (sim->time_done[numc] > maxtd) {
+      maxtd = sim->time_done[numc];
+      maxcr = numc;
+    }
+  }
+  sim->time_done[maxcr] = sim->CYCLE_VAL;
+
+  return 0;
+}
+
+int usimm_sim_run(usimm_sim_t * sim)
+{
+#ifndef USIMM_PROFILE
+  if (sim->profile.enabled) {
+    fprintf(sim->out, "Panic.  Self-profiling is not built in; rebuild with make PROFILE=1.\n");
+    return -3;
+  }
+#endif
+  if (start_memory_workers(sim)) {
+    fprintf(sim->out, "Could not start the memory threads.  Quitting.\n");
+    return -6;
+  }
+#ifdef USIMM_PROFILE
+  /* The wall time of the loop converts the counter ticks to seconds. */
+  struct timespec start, end;
+  unsigned long long int start_ticks = profile_ticks();
+  clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+  int status = 0;
+  if (sim->epoch.length > 0)
+    status = start_epochs(sim);
+  if (!status)
+    status = simulate(sim);
+#ifdef USIMM_PROFILE
+  sim->profile.loop_ticks += profile_ticks() - start_ticks;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  sim->profile.loop_seconds += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1e-9;
+#endif
+  stop_memory_workers(sim);
+  int epoch_status = finish_epochs(sim);
+  finish_rank_residency(sim);
+  return status ? status : epoch_status;
+}
+
+static const char * profile_phase[NUM_PROF_PHASES] = {
+  "retire", "update_memory", "transfer_response", "schedule",
+  "transfer_request", "fetch", "trace", "merge_updates", "advance_clock"
+};
+
+/* The useful work each phase counts, if any besides its calls. */
+static const char * profile_events[NUM_PROF_PHASES] = {
+  "instructions retired", NULL, "responses moved", "commands issued",
+  "requests moved", "instructions fetched", "records read", NULL, NULL
+};
+
+void usimm_sim_print_profile(const profile_t * profile, FILE * f, int json)
+{
+  double seconds_per_tick = profile->loop_ticks ? profile->loop_seconds / profile->loop_ticks : 0;
+  unsigned long long int phases = 0, other = 0;
+
+  /* The loop time outside every phase; trace is counted within fetch. */
+  for (int p=0; p < NUM_PROF_PHASES; p++)
+    if (p != PROF_TRACE)
+      phases += profile->ticks[p];
+  if (profile->loop_ticks > phases)
+    other = profile->loop_ticks - phases;
+
+  if (json) {
+    fprintf(f, "{\"loop_seconds\": %.6f", profile->loop_seconds);
+    for (int p=0; p < NUM_PROF_PHASES; p++) {
+      fprintf(f, ", \"%s\": {\"seconds\": %.6f, \"ticks\": %llu, \"calls\": %lld", profile_phase[p], profile->ticks[p]*seconds_per_tick, profile->ticks[p], profile->calls[p]);
+      if (profile_events[p])
+        fprintf(f, ", \"events\": %lld", profile->events[p]);
+      fprintf(f, "}");
+    }
+    fprintf(f, ", \"other_seconds\": %.6f}", other*seconds_per_tick);
+    return;
+  }
+
+  fprintf(f, "\n#-------------------------------------- Self-profile ---------------------------------------------\n");
+  fprintf(f, "%-18s %10s %7s %14s %11s %14s\n", "Phase", "Seconds", "Share", "Calls", "Ticks/call", "Events");
+  for (int p=0; p < NUM_PROF_PHASES; p++) {
+    fprintf(f, "%-18s %10.3f %6.1f%% %14lld %11.1f", profile_phase[p], profile->ticks[p]*seconds_per_tick,
+            profile->loop_ticks ? 100.0*profile->ticks[p]/profile->loop_ticks : 0.0, profile->calls[p],
+            profile->calls[p] ? (double)profile->ticks[p]/profile->calls[p] : 0.0);
+    if (profile_events[p])
+      fprintf(f, " %14lld %s", profile->events[p], profile_events[p]);
+    fprintf(f, "\n");
+  }
+  fprintf(f, "%-18s %10.3f %6.1f%%\n", "other", other*seconds_per_tick, profile->loop_ticks ? 100.0*other/profile->loop_ticks : 0.0);
+  fprintf(f, "%-18s %10.3f\n", "loop", profile->loop_seconds);
+  fprintf(f, "Note:  trace is part of fetch.  The vault phases are summed over the memory threads.\n");
+}
+
+static float processor_core_power(usimm_sim_t * sim)
+{
+  float core_power = 0;
+  for (int numc=0; numc < sim->NUMCORES; numc++) {
+    /* A core has peak power of 10 W in a 4-channel config.  Peak power is consumed while the thread is running, else the core is perfectly power gated. */
+    core_power = core_power + (10*((float)sim->time_done[numc]/(float)sim->CYCLE_VAL));
+  }
+  if (sim->NUM_CHANNELS == 1) {
+    /* The core is more energy-efficient in our single-channel configuration. */
+    core_power = core_power/2.0 ;
+  }
+  return core_power;
+}
+
+static float energy_delay_product(usimm_sim_t * sim, float system_power)
+{
+  return system_power*(float)((double)sim->CYCLE_VAL/(double)3200000000) * (float)((double)sim->CYCLE_VAL/(double)3200000000);
+}
+
+void usimm_sim_print_stats(usimm_sim_t * sim)
+{
+  fprintf(sim->out, "Done with loop. Printing stats.\n");
+  float core_power = processor_core_power(sim);
+  long long int total_time_done;
+  int chips_per_rank=-1;
+
+
+
+  fprintf(sim->out, "Cycles %lld\n", sim->CYCLE_VAL);
+  total_time_done = 0;
+  for (int numc=0; numc < sim->NUMCORES; numc++) {
+    fprintf(sim->out, "Done: Core %d: Fetched %lld : Committed %lld : At time : %lld\n", numc, sim->fetched[numc], sim->committed[numc], sim->time_done[numc]);
+    total_time_done += sim->time_done[numc];
+  }
+  fprintf(sim->out, "Sum of execution times for all programs: %lld\n", total_time_done);
+  fprintf(sim->out, "Num reads merged: %lld\n",sim->num_read_merge);
+  fprintf(sim->out, "Num writes merged: %lld\n",sim->num_write_merge);
+  fprintf(sim->out, "Request pool: peak live %lld : live at exit %lld : slabs %d\n", sim->request_pool_peak, sim->request_pool_live, sim->request_pool_slabs);
+  if (sim->sampling.window > 0)
+    print_sampling_stats(sim);
+  /* Print all other memory system stats. */
+  scheduler_stats(sim);
+  print_stats(sim);  
+
+  /*Print Cycle Stats*/
+  for(int c=0; c<sim->NUM_CHANNELS; c++)
+	 for(int v=0; v<sim->NUM_VAULTS[c]; v++)
+		for(int r=0; r<sim->NUM_RANKS[c] ;r++)
+		  calculate_power(sim, c,v,r,0,chips_per_rank);
+
+	fprintf (sim->out, "\n#-------------------------------------- Power Stats ----------------------------------------------\n");
+	fprintf (sim->out, "Note:  1. termRoth/termWoth is the power dissipated in the ODT resistors when Read/Writes terminate \n");
+	fprintf (sim->out, "          in other ranks on the same channel\n");
+	fprintf (sim->out, "#-------------------------------------------------------------------------------------------------\n\n");
+
+
+  /*Print Power Stats*/
+  float total_system_power =0;
+  for(int c=0; c<sim->NUM_CHANNELS; c++)
+	for(int v=0; v<sim->NUM_VAULTS[c]; v++)
+	  for(int r=0; r<sim->NUM_RANKS[c] ;r++)
+		  total_system_power += calculate_power(sim, c,v,r,1,chips_per_rank);
+
+		fprintf (sim->out, "\n#-------------------------------------------------------------------------------------------------\n");
+	if (sim->NUM_CHANNELS == 4) {  /* Assuming that this is 4channel.cfg  */
+	  fprintf (sim->out, "Total memory system power = %f W\n",total_system_power/1000);
+	  fprintf(sim->out, "Miscellaneous system power = 40 W  # Processor uncore power, disk, I/O, cooling, etc.\n");
+	  fprintf(sim->out, "Processor core power = %f W  # Assuming that each core consumes 10 W when running\n",core_power);
+	  fprintf(sim->out, "Total system power = %f W # Sum of the previous three lines\n", 40 + core_power + total_system_power/1000);
+	  fprintf(sim->out, "Energy Delay product (EDP) = %2.9f J.s\n", energy_delay_product(sim, 40 + core_power + total_system_power/1000));
+	}
+	else {  /* Assuming that this is 1channel.cfg  */
+	  fprintf (sim->out, "Total memory system power = %f W\n",total_system_power/1000);
+	  fprintf(sim->out, "Miscellaneous system power = 10 W  # Processor uncore power, disk, I/O, cooling, etc.\n");  /* The total 40 W misc power will be split across 4 channels, only 1 of which is being considered in the 1-channel experiment. */
+	  fprintf(sim->out, "Processor core power = %f W  # Assuming that each core consumes 5 W\n",core_power);  /* Assuming that the cores are more lightweight. */
+	  fprintf(sim->out, "Total system power = %f W # Sum of the previous three lines\n", 10 + core_power + total_system_power/1000);
+	  fprintf(sim->out, "Energy Delay product (EDP) = %2.9f J.s\n", energy_delay_product(sim, 10 + core_power + total_system_power/1000));
+	}
+
+  if (sim->profile.enabled)
+    usimm_sim_print_profile(&sim->profile, sim->out, 0);
+}
+
+void usimm_sim_summary(usimm_sim_t * sim, usimm_summary_t * summary)
+{
+  double read_latency = 0;
+  float memory_power = 0;
+
+  latency_histogram_t reads;
+
+  memset(summary, 0, sizeof(usimm_summary_t));
+  memset(&reads, 0, sizeof(reads));
+  summary->cycles = sim->CYCLE_VAL;
+  for (int numc=0; numc < sim->NUMCORES; numc++)
+    summary->sum_of_execution_times += sim->time_done[numc];
+  for (int c=0; c < sim->NUM_CHANNELS; c++) {
+    merge_latency(&reads, &sim->channel_latency[c].kind[LAT_READ]);
+    for (int v=0; v < sim->NUM_VAULTS[c]; v++) {
+      summary->reads_completed += sim->stats_reads_completed[c][v];
+      summary->writes_completed += sim->stats_writes_completed[c][v];
+      read_latency += sim->stats_average_read_latency[c][v] * sim->stats_reads_completed[c][v];
+      for (int r=0; r < sim->NUM_RANKS[c]; r++)
+        memory_power += calculate_power(sim, c, v, r, 2, -1);
+    }
+  }
+  if (summary->reads_completed)
+    summary->average_read_latency = read_latency / summary->reads_completed;
+  summary->read_latency_p99 = latency_percentile(&reads, 99);
+
+  /* The same system as in usimm_sim_print_stats. */
+  float system_power = ((sim->NUM_CHANNELS == 4) ? 40 : 10) + processor_core_power(sim) + memory_power/1000;
+  summary->memory_power = memory_power/1000;
+  summary->system_power = system_power;
+  summary->edp = energy_delay_product(sim, system_power);
+}
+
+long long int usimm_sim_cycles(const usimm_sim_t * sim)
+{
+  return sim->CYCLE_VAL;
+}
+
+void usimm_sim_destroy(usimm_sim_t * sim)
+{
+  if (sim == NULL)
+    return;
+  stop_trace_prefetch(sim->prefetch);
+  for (int numc=0; sim->tif && numc < sim->NUMCORES; numc++)
+    close_trace(&sim->tif[numc]);
+  for (int numc=0; sim->ROB && numc < sim->NUMCORES; numc++) {
+    free(sim->ROB[numc].comptime);
+    free(sim->ROB[numc].mem_address);
+    free(sim->ROB[numc].instrpc);
+    free(sim->ROB[numc].optype);
+  }
+  free_memory_controller_vars(sim);
+  free(sim->ROB);
+  free(sim->tif);
+  free(sim->prefixtable);
+  free(sim->nonmemops);
+  free(sim->opertype);
+  free(sim->addr);
+  free(sim->instrpc);
+  free(sim->committed);
+  free(sim->fetched);
+  free(sim->time_done);
+  free(sim->config);
+  free(sim);
+}
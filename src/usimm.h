@@ -0,0 +1,502 @@
+#ifndef __USIMM_H__
+#define __USIMM_H__
+
+#include <stdio.h>
+
+#include "params.h"
+#include "memory_controller.h"
+#include "scheduler.h"
+#include "processor.h"
+#include "trace.h"
+#include "profile.h"
+#include "latency.h"
+#include "epoch.h"
+
+// Clock domains of the clock calendar. The processor, each memory
+// channel and the SerDes links fire on multiples of their clock
+// multiplier of the base tick.
+#define CLK_PROCESSOR 0
+#define CLK_SERDES 1
+#define CLK_MEMORY 2  // CLK_MEMORY+channel
+#define NUM_CLOCK_DOMAINS (CLK_MEMORY+MAX_NUM_CHANNELS)
+
+// A named configuration parameter (see configfile.h)
+typedef struct configparam
+{
+  const char * name;
+  double value;
+} config_param_t;
+
+// Sampled simulation, SMARTS style: the run alternates a detailed
+// warmup of 'warmup' instructions, a measured window of 'window'
+// instructions (both counted over all cores) and a functional
+// fast-forward of 'skip' instructions of every trace. Each window gives
+// one sample of every metric; the run stops once the 95% confidence
+// interval of every metric is within target_error of its mean, after
+// at least SAMPLE_MIN_WINDOWS windows.
+#define SAMPLE_IPC 0
+#define SAMPLE_READ_LATENCY 1
+#define SAMPLE_MEMORY_POWER 2
+#define NUM_SAMPLE_METRICS 3
+#define SAMPLE_MIN_WINDOWS 30
+
+// Cumulative counts a window's metrics are taken as differences of
+typedef struct samplepoint
+{
+  long long int cycle;
+  long long int committed;
+  long long int reads_completed;
+  double read_latency; // summed over the completed reads
+  double memory_energy; // mW times base ticks
+} sample_point_t;
+
+typedef struct sampling
+{
+  long long int window; // 0: sampling off
+  long long int warmup;
+  long long int skip;
+  double target_error; // 0: sample until the traces end
+
+  int measuring; // in a window, not a warmup
+  int converged; // stopped at the target error
+  long long int phase_end; // committed instructions ending the phase
+  sample_point_t start; // where the current window started
+  long long int num_windows;
+  long long int num_samples[NUM_SAMPLE_METRICS];
+  double sum[NUM_SAMPLE_METRICS];
+  double sum_sq[NUM_SAMPLE_METRICS];
+} sampling_t;
+
+// The state of one simulation: its configuration, the processor and
+// memory system state and the statistics. Nothing the simulator
+// touches lives outside this structure, so any number of simulations
+// can exist in a process and run on separate threads; every function
+// of the simulator takes the simulation it works on as its first
+// argument.
+struct usimm_sim
+{
+  FILE * out; // where messages and statistics go (stdout by default)
+
+  // configuration table the parameters below are derived from
+  config_param_t * config;
+
+  /********************/
+  /* Processor params */
+  /********************/
+  // number of cores in mulicore
+  int NUMCORES;
+
+  // number of HMCs
+  int NUM_HMCS;
+
+  // number of DIMMs
+  int NUM_DIMMS;
+
+  // processor clock frequency multiplier : multiplying the
+  // DRAM_CLK_FREQUENCY by the following parameter gives the processor
+  // clock frequency
+  int PROCESSOR_CLK_MULTIPLIER;
+
+  int DIMM_CLK_MULTIPLIER;
+
+  int HMC_CLK_MULTIPLIER;
+
+  int SERDES_CLK_MULTIPLIER;
+
+  int MEMORY_CLK_MULTIPLIER[4];
+
+  //size of ROB
+  int ROBSIZE ;// 128;
+
+  // maximum commit width
+  int MAX_RETIRE ;// 2;
+
+  // maximum instruction fetch width
+  int MAX_FETCH ;// 4;
+
+  // depth of pipeline
+  int PIPELINEDEPTH ;// 5;
+
+  /*****************************/
+  /* DRAM System Configuration */
+  /*****************************/
+  // total number of channels in the system
+  int NUM_CHANNELS ;// 1;
+
+  // total number of vaults per channel
+  int NUM_VAULTS[4] ;// 1;
+
+  // number of ranks per channel
+  int NUM_RANKS[4] ;// 2;
+
+  // number of banks per rank
+  int NUM_BANKS[4] ;// 8;
+
+  // number of rows per bank
+  int NUM_ROWS[4] ;// 32768;
+
+  // number of columns per rank
+  int NUM_COLUMNS[4] ;// 128;
+
+  // cache-line size (bytes)
+  int CACHE_LINE_SIZE[4] ;// 64;
+
+  // total number of address bits (i.e. indicates size of memory)
+  int ADDRESS_BITS ;// 32;
+
+  /****************************/
+  /* DRAM Chip Specifications */
+  /****************************/
+
+  // All the following timing parameters should be
+  // entered in the config file in terms of memory
+  // clock cycles.
+
+  // RAS to CAS delay
+  int T_RCD[4] ;// 44;
+
+  // PRE to RAS
+  int T_RP[4] ;// 44;
+
+  // ColumnRD to Data burst
+  int T_CAS[4] ;// 44;
+
+  // RAS to PRE delay
+  int T_RAS[4] ;// 112;
+
+  // Row Cycle time
+  int T_RC[4] ;// 156;
+
+  // ColumnWR to Data burst
+  int T_CWD[4] ;// 20;
+
+  // write recovery time (COL_WR to PRE)
+  int T_WR[4] ;// 48;
+
+  // write to read turnaround
+  int T_WTR[4] ;// 24;
+
+  // rank to rank switching time
+  int T_RTRS[4] ;// 8;
+
+  // Data transfer
+  int T_DATA_TRANS[4] ;// 16;
+
+  // Read to PRE
+  int T_RTP[4] ;// 24;
+
+  // CAS to CAS
+  int T_CCD[4] ;// 16;
+
+  // Power UP time fast
+  int T_XP[4] ;// 20;
+
+  // Power UP time slow
+  int T_XP_DLL[4] ;// 40;
+
+  // Power down entry
+  int T_CKE[4] ;// 16;
+
+  // Minimum power down duration
+  int T_PD_MIN[4] ;// 16;
+
+  // rank to rank delay (ACTs to same rank)
+  int T_RRD[4] ;// 20;
+
+  // four bank activation window
+  int T_FAW[4] ;// 128;
+
+  // refresh interval
+  int T_REFI[4];
+
+  // refresh cycle time
+  int T_RFC[4];
+
+  /****************************/
+  /* VOLTAGE & CURRENT VALUES */
+  /****************************/
+
+  float VDD[4];
+
+  float IDD0[4];
+
+  float IDD1[4];
+
+  float IDD2P0[4];
+
+  float IDD2P1[4];
+
+  float IDD2N[4];
+
+  float IDD3P[4];
+
+  float IDD3N[4];
+
+  float IDD4R[4];
+
+  float IDD4W[4];
+
+  float IDD5[4];
+
+  /******************************/
+  /* MEMORY CONTROLLER Settings */
+  /******************************/
+
+  // maximum capacity of write queue (per channel)
+  int WQ_CAPACITY[4] ;// 64;
+
+  //  int ADDRESS_MAPPING mode
+  // 1 is consecutive cache-lines to same row
+  // 2 is consecutive cache-lines striped across different banks
+  int ADDRESS_MAPPING ;// 1;
+
+  //RQ associative lookup
+  int RQ_LOOKUP_LATENCY[4];
+
+  // WQ associative lookup
+  int WQ_LOOKUP_LATENCY[4];
+
+  // RQ link latency
+  int RQ_LINK_LATENCY;
+
+  // WQ link latency
+  int WQ_LINK_LATENCY;
+
+  /*******************/
+  /* Processor state */
+  /*******************/
+
+  long long int CYCLE_VAL; // current base tick
+  int expt_done;
+
+  int clock_period[NUM_CLOCK_DOMAINS]; // 0 if the domain is not simulated
+  long long int clock_next_tick[NUM_CLOCK_DOMAINS];
+
+  struct robstructure * ROB;
+  trace_t * tif; // the handles to the trace input files
+  trace_prefetch_t * prefetch; // background trace reader, NULL if not used
+  int * prefixtable;
+
+  // next record of each trace, not yet fetched
+  int * nonmemops;
+  char * opertype;
+  long long int * addr;
+  long long int * instrpc;
+
+  long long int * committed; // total committed instructions in each core
+  long long int * fetched;   // total fetched instructions in each core
+  long long int * time_done;
+
+  /***************************/
+  /* Memory controller state */
+  /***************************/
+
+  // contains the states of all banks in the system
+  bank_t dram_state[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+
+  // command issued this cycle to this channel
+  int command_issued_current_cycle[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // cas command issued this cycle to this channel
+  int cas_issued_current_cycle[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS]; // 1/2 for COL_READ/COL_WRITE
+
+  // Per channel read queue
+  request_t * read_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // Per channel write queue
+  request_t * write_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // SerDes queue at host
+  request_t * read_queue_per_core_head[MAX_NUM_CORES][MAX_NUM_HMCS];
+
+  // SerDes queue at host
+  request_t * write_queue_per_core_head[MAX_NUM_CORES][MAX_NUM_HMCS];
+
+  request_t * read_return_queue_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  vault_buckets_t read_buckets[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  vault_buckets_t write_buckets[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // issuables_for_different commands
+  int cmd_precharge_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  int cmd_all_bank_precharge_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int cmd_powerdown_fast_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int cmd_powerdown_slow_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int cmd_powerup_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int cmd_refresh_issuable[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  // refresh variables
+  long long int next_refresh_completion_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int last_refresh_completion_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int forced_refresh_mode_on[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int refresh_issue_deadline[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int issued_forced_refresh_commands[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  int num_issued_refreshes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  long long int read_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int write_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  long long int write_queue_length_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
+  long long int read_queue_length_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
+  long long int read_return_queue_length[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // Stats
+  long long int num_read_merge ;
+  long long int num_write_merge ;
+
+  // request pool occupancy: nodes handed out now, the most ever handed
+  // out at once, and slabs allocated to back them
+  long long int request_pool_live;
+  long long int request_pool_peak;
+  int request_pool_slabs;
+  long long int stats_reads_merged_per_vault[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int stats_writes_merged_per_vault[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int stats_reads_seen[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int stats_writes_seen[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int stats_reads_completed[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  long long int stats_writes_completed[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  double stats_average_read_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  double stats_average_read_queue_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  double stats_average_write_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  double stats_average_write_queue_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // latency histograms of the finished requests (see latency.h); a vault
+  // keeps only the total read and write latencies
+  latency_histogram_t vault_read_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  latency_histogram_t vault_write_latency[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  latency_stats_t channel_latency[MAX_NUM_CHANNELS];
+  latency_stats_t core_latency[MAX_NUM_CORES];
+
+  long long int stats_page_hits[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  double stats_read_row_hit_rate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // Time spent in various states, credited since state_since when a rank
+  // changes state and once at the end of the run
+  long long int stats_time_spent_in_active_standby[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_in_active_power_down[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_in_precharge_power_down_fast[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_in_precharge_power_down_slow[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_in_power_up[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int last_activate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int last_refresh[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  double average_gap_between_activates[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  double average_gap_between_refreshes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_terminating_reads_from_other_ranks[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_time_spent_terminating_writes_to_other_ranks[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  // Command Counters
+  long long int stats_num_activate_read[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_activate_write[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_activate_spec[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_activate[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_num_precharge[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_read[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_write[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][MAX_NUM_BANKS];
+  long long int stats_num_powerdown_slow[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_num_powerdown_fast[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  long long int stats_num_powerup[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  // energy per device charged so far (mW times cycles, see energy_so_far)
+  double stats_energy[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+  // cycle the power state of each rank is accounted up to
+  long long int state_since[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  long long int next_request_schedule_time[MAX_NUM_HMCS];
+  long long int next_respond_schedule_time[MAX_NUM_HMCS];
+  // cycles each HMC link was busy with requests [0] and responses [1]
+  long long int stats_link_busy[MAX_NUM_HMCS][2];
+
+  int drain_writes[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+  int drain_write_for_core[MAX_NUM_CORES][MAX_NUM_HMCS];
+
+  // cycles of the last ACTIVATION_WINDOW_SIZE activates issued to each
+  // rank, kept as a ring; activation_head points at the oldest one
+  long long int activation_record[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS][ACTIVATION_WINDOW_SIZE];
+  int activation_head[MAX_NUM_CHANNELS][MAX_NUM_VAULTS][MAX_NUM_RANKS];
+
+  // address_map[0] decodes HMC addresses, address_map[1] DIMM addresses
+  addr_map_t address_map[2];
+
+  request_t * request_free_list;
+  long long int request_slab_nodes;
+  void ** request_slabs; // request_pool_slabs allocations backing the pool
+
+  queue_index_t read_queue_index[MAX_NUM_CHANNELS];
+  queue_index_t write_queue_index[MAX_NUM_CHANNELS];
+
+  vault_updates_t vault_updates[MAX_NUM_CHANNELS][MAX_NUM_VAULTS];
+
+  // threads stepping the vaults (1 or less: only the simulation
+  // thread); set before usimm_sim_run
+  int memory_threads;
+  struct memoryworkers * workers;
+
+  // instructions of each trace run functionally, warming the open rows
+  // only, before the detailed simulation starts; set before usimm_sim_init
+  long long int fast_forward;
+
+  // sampled simulation; the settings are set before usimm_sim_run
+  sampling_t sampling;
+
+  // write a checkpoint to checkpoint_file once this many instructions
+  // have committed over all cores (-1: never); set before usimm_sim_run
+  long long int checkpoint_at;
+  const char * checkpoint_file;
+  const char * restore_file; // checkpoint being resumed, set by usimm_sim_restore
+
+  // self-profiling counters (see profile.h)
+  profile_t profile;
+
+  // epoch time series (see epoch.h)
+  epoch_stats_t epoch;
+
+  int power_stats_header_printed;
+
+  scheduler_state_t sched;
+};
+
+// Library interface. A simulation is created with the default
+// configuration, which config files and overrides may then change
+// (read_config_file and set_config_override in configfile.h, wrapped
+// below). usimm_sim_init opens the traces and builds the system the
+// configuration describes; usimm_sim_run simulates it to completion.
+// The functions that can fail return 0 on success and otherwise the
+// nonzero code usimm exits with, after printing the problem to sim->out.
+// usimm_sim_init_loaded runs on traces loaded with load_trace instead,
+// which many simulations may share; the names only serve the "MT"
+// address prefixes and the messages. usimm_sim_summary gives the
+// headline results of a finished simulation without printing them.
+// usimm_sim_restore, called instead of reading a configuration, makes
+// usimm_sim_init resume the run saved in a checkpoint (see checkpoint.h)
+// on the same traces. usimm_sim_print_profile prints the self-profile
+// of a run with sim->profile.enabled, as a table or as a JSON object.
+
+// Headline results, as in the usimm_sim_print_stats report
+typedef struct usimm_summary
+{
+  long long int cycles;
+  long long int sum_of_execution_times;
+  long long int reads_completed;
+  long long int writes_completed;
+  double average_read_latency; // memory cycles, over all vaults
+  long long int read_latency_p99; // cycles from queueing to data return
+  double memory_power; // W
+  double system_power; // W
+  double edp; // J.s
+} usimm_summary_t;
+
+usimm_sim_t * usimm_sim_create();
+int usimm_sim_read_config(usimm_sim_t * sim, const char * filename, const char * section);
+int usimm_sim_set(usimm_sim_t * sim, const char * assignment);
+int usimm_sim_restore(usimm_sim_t * sim, const char * checkpoint);
+int usimm_sim_init(usimm_sim_t * sim, int num_traces, char * const * trace_files, int trace_prefetch);
+int usimm_sim_init_loaded(usimm_sim_t * sim, int num_traces, char * const * trace_names, const trace_data_t * const * traces);
+int usimm_sim_run(usimm_sim_t * sim);
+void usimm_sim_print_stats(usimm_sim_t * sim);
+void usimm_sim_summary(usimm_sim_t * sim, usimm_summary_t * summary);
+void usimm_sim_print_profile(const profile_t * profile, FILE * f, int json);
+long long int usimm_sim_cycles(const usimm_sim_t * sim);
+void usimm_sim_destroy(usimm_sim_t * sim);
+
+#endif //__USIMM_H__